@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BatchSimulation.h"
+#include "LevelLoader.h"
+
+/**
+*   Measures how many world-steps per second BatchSimulation manages for 1, 2, 4 ... up to
+*   every core. Worlds get random input and start over when their game ends, like they would
+*   when used as reinforcement learning environments.
+*
+*   @name pacman_bench_batch
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+int main(int argc, char** argv)
+{
+	int worlds = 4096;
+	int numberOfGhosts = 4;
+	int steps = 2000;
+	int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+	std::string levelPath = "assets/levels/level0";
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string arg = argv[i];
+		if (arg == "--worlds") { worlds = std::atoi(argv[i + 1]); }
+		else if (arg == "--ghosts") { numberOfGhosts = std::atoi(argv[i + 1]); }
+		else if (arg == "--steps") { steps = std::atoi(argv[i + 1]); }
+		else if (arg == "--threads") { maxThreads = std::atoi(argv[i + 1]); }
+		else if (arg == "--level") { levelPath = argv[i + 1]; }
+	}
+	if (maxThreads < 1)
+	{
+		maxThreads = 1;
+	}
+
+	LevelLoader levelLoader;
+	levelLoader.loadLevel(levelPath);
+	std::shared_ptr<const LevelGrid> grid = levelLoader.getGrid();
+
+	std::cout << "worlds " << worlds << ", ghosts " << numberOfGhosts << ", steps " << steps << "\n\n";
+	std::cout << "threads\tsteps/sec\tspeedup\n";
+
+	double singleThreaded = 0.0;
+
+	for (int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		BatchSimulation batch(grid, worlds, numberOfGhosts, 1234u, threads);
+		batch.setAutoReset(true);
+
+		unsigned int inputSeed = 42;
+		auto start = std::chrono::steady_clock::now();
+
+		for (int s = 0; s < steps; s++)
+		{
+			if (s % 30 == 0) // new input every 30 ticks, the step itself is what is measured.
+			{
+				for (int w = 0; w < worlds; w++)
+				{
+					inputSeed = inputSeed * 1664525u + 1013904223u;
+					batch.setInput(w, INPUT_W | ((inputSeed >> 28) & INPUT_D), ((inputSeed >> 16) & 0xff) - 128.0f);
+				}
+			}
+			batch.step(1.0f / 120.0f);
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		double stepsPerSecond = static_cast<double>(worlds) * steps / seconds;
+		if (threads == 1)
+		{
+			singleThreaded = stepsPerSecond;
+		}
+
+		std::cout << threads << '\t' << static_cast<long long>(stepsPerSecond) << '\t' << stepsPerSecond / singleThreaded << "x\n";
+
+		if (threads < maxThreads && threads * 2 > maxThreads)
+		{
+			threads = maxThreads / 2; // always finish with every core.
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,351 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CounterRandom.h"
+#include "FixedPoint.h"
+#include "FlowField.h"
+#include "GhostKernel.h"
+
+/**
+*   Measures the ghost movement kernel: moving every ghost one step, finding its tile, the tunnel
+*   teleport and spotting the ghosts that entered a new tile. Every version GhostKernel has on this
+*   CPU runs on the same flat arrays, and is compared against ghosts stored one object each, the
+*   way Ghost::move() did it before GhostStore. Directions don't change, there is no AI in here.
+*
+*   Every version has to end in exactly the same positions and tiles as the scalar one, the exit
+*   code is non zero when one doesn't. The fixed point versions (fx-) run the same ghosts from
+*   16.16 positions and are checked against the fixed point scalar one the same way.
+*
+*   @name pacman_bench_ghost_kernel
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const int TILES = 512; // a square arena, ghosts teleport at its left and right edge.
+
+/**
+*   Ghost as an object, the fields and the movement of the old Ghost class. The copy of the level
+*   every Ghost had is left empty here, it only adds to the size of the object.
+*/
+class ObjectGhost
+{
+private:
+
+	glm::vec3 velocity;
+	glm::vec3 position;
+	glm::vec3 previousPosition;
+	glm::vec3 renderPosition;
+	int calculatedDirectionPosX;
+	int calculatedDirectionPosZ;
+	int aiValue;
+	CounterRandom random;
+	std::vector<std::vector<int>> levelArray;
+	std::vector<glm::vec3> validGhostPositions;
+
+public:
+
+	ObjectGhost(glm::vec3 position, glm::vec3 velocity)
+		: velocity(velocity), position(position), previousPosition(position), renderPosition(position),
+		calculatedDirectionPosX(-1), calculatedDirectionPosZ(-1), aiValue(1)
+	{
+
+	}
+
+	int getUnitLevelArrayIndexX() const
+	{
+		float offset = 0;
+		if (velocity == glm::vec3(-1.0f, 0.0f, 0.0f)) { offset = 0.9f; }
+		else if (velocity == glm::vec3(1.0f, 0.0f, 0.0f)) { offset = -0.9f; }
+		return static_cast<int>(std::floor((position.x + offset) / 2));
+	}
+
+	int getUnitLevelArrayIndexZ() const
+	{
+		float offset = 0;
+		if (velocity == glm::vec3(0.0f, 0.0f, -1.0f)) { offset = 0.9f; }
+		else if (velocity == glm::vec3(0.0f, 0.0f, 1.0f)) { offset = -0.9f; }
+		return static_cast<int>(std::floor((position.z + offset) / 2));
+	}
+
+	bool move(float delta)
+	{
+		previousPosition = position;
+		position += velocity * delta * 2.0f;
+
+		bool enteredTile = false;
+		if (calculatedDirectionPosX != getUnitLevelArrayIndexX() || calculatedDirectionPosZ != getUnitLevelArrayIndexZ())
+		{
+			calculatedDirectionPosX = getUnitLevelArrayIndexX();
+			calculatedDirectionPosZ = getUnitLevelArrayIndexZ();
+			enteredTile = true;
+		}
+
+		if (position.x < 1)
+		{
+			position.x = TILES * 2 - 1.0f;
+			previousPosition = position;
+		}
+		else if (position.x > TILES * 2 - 0.8)
+		{
+			position.x = 1;
+			previousPosition = position;
+		}
+		return enteredTile;
+	}
+
+	inline glm::vec3 getPosition() const { return position; }
+	inline int getTileX() const { return calculatedDirectionPosX; }
+	inline int getTileZ() const { return calculatedDirectionPosZ; }
+};
+
+/* The flat arrays GhostKernel runs on. */
+struct GhostArrays
+{
+	std::vector<float> x;
+	std::vector<float> z;
+	std::vector<float> previousX;
+	std::vector<float> previousZ;
+	std::vector<uint8_t> directions;
+	std::vector<int> tileX;
+	std::vector<int> tileZ;
+
+	GhostLanes lanes()
+	{
+		return { x.data(), z.data(), previousX.data(), previousZ.data(), directions.data(), tileX.data(), tileZ.data() };
+	}
+
+	bool operator==(const GhostArrays& other) const
+	{
+		return x == other.x && z == other.z && previousX == other.previousX && previousZ == other.previousZ
+			&& tileX == other.tileX && tileZ == other.tileZ;
+	}
+};
+
+/* The arrays GhostKernel::advanceFixed() runs on, the positions in 16.16. */
+struct FixedArrays
+{
+	std::vector<int32_t> x;
+	std::vector<int32_t> z;
+	std::vector<int32_t> previousX;
+	std::vector<int32_t> previousZ;
+	std::vector<uint8_t> directions;
+	std::vector<int> tileX;
+	std::vector<int> tileZ;
+
+	FixedArrays(const GhostArrays& ghosts) : directions(ghosts.directions), tileX(ghosts.tileX), tileZ(ghosts.tileZ)
+	{
+		for (size_t i = 0; i < ghosts.x.size(); i++)
+		{
+			x.push_back(FixedPoint::fromFloat(ghosts.x[i]));
+			z.push_back(FixedPoint::fromFloat(ghosts.z[i]));
+		}
+		previousX = x;
+		previousZ = z;
+	}
+
+	FixedLanes lanes()
+	{
+		return { x.data(), z.data(), previousX.data(), previousZ.data(), directions.data(), tileX.data(), tileZ.data() };
+	}
+
+	bool operator==(const FixedArrays& other) const
+	{
+		return x == other.x && z == other.z && previousX == other.previousX && previousZ == other.previousZ
+			&& tileX == other.tileX && tileZ == other.tileZ;
+	}
+};
+
+/**
+*   Spawns ghosts anywhere in the arena, going in a random direction.
+*
+*   @param count - How many ghosts.
+*
+*   @return GhostArrays - the ghosts.
+*/
+static GhostArrays spawn(int count)
+{
+	CounterRandom random(1234u);
+	GhostArrays ghosts;
+	for (int i = 0; i < count; i++)
+	{
+		ghosts.x.push_back(1.0f + random.nextInt(TILES * 2000 - 2000) / 1000.0f);
+		ghosts.z.push_back(1.0f + random.nextInt(TILES * 2000 - 2000) / 1000.0f);
+		ghosts.directions.push_back(static_cast<uint8_t>(GHOST_UP + random.nextInt(3)));
+	}
+	ghosts.previousX = ghosts.x;
+	ghosts.previousZ = ghosts.z;
+	ghosts.tileX.assign(count, -1);
+	ghosts.tileZ.assign(count, -1);
+	return ghosts;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<int> ghostCounts = { 1000, 100000, 1000000 };
+	int ticks = 200;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--ghosts" && hasValue)
+		{
+			ghostCounts.clear();
+			std::stringstream list(argv[++i]);
+			std::string item;
+			while (std::getline(list, item, ','))
+			{
+				ghostCounts.push_back(std::atoi(item.c_str()));
+			}
+		}
+		else if (arg == "--ticks" && hasValue) { ticks = std::atoi(argv[++i]); }
+		else
+		{
+			std::cerr << "usage: pacman_bench_ghost_kernel [--ghosts 1000,100000,...] [--ticks N]\n";
+			return EXIT_FAILURE;
+		}
+	}
+	if (ticks < 1)
+	{
+		ticks = 1;
+	}
+
+	const float delta = 1.0f / 60.0f;
+	double edge = TILES * 2 - 0.8; // the same float edge as GhostStore.
+	float wrapAbove = static_cast<float>(edge);
+	if (wrapAbove > edge)
+	{
+		wrapAbove = std::nextafter(wrapAbove, 0.0f);
+	}
+	GhostStep step = { delta * 2.0f, 1.0f, wrapAbove, TILES * 2 - 1.0f, 1.0f };
+	int32_t width = TILES * 2 * FixedPoint::ONE;
+	FixedStep fixedStep = { FixedPoint::fromFloat(delta * 2.0f), FixedPoint::ONE, width - FixedPoint::fromFloat(0.8f),
+		width - FixedPoint::ONE, FixedPoint::ONE };
+
+	GhostKernel::Level best = GhostKernel::detect();
+	GhostKernel::Level active = GhostKernel::getLevel();
+	bool failed = false;
+
+	std::cout << TILES << "x" << TILES << " arena, " << ticks << " ticks, best kernel on this CPU: " << GhostKernel::getName(best) << "\n\n";
+	std::cout << "ghosts    version   ns/ghost   speedup  result\n";
+
+	for (int count : ghostCounts)
+	{
+		GhostArrays start = spawn(count);
+		std::vector<int> entered(count);
+		char row[128];
+
+		std::vector<std::unique_ptr<ObjectGhost>> objects;
+		for (int i = 0; i < count; i++)
+		{
+			glm::vec3 velocity(0.0f);
+			switch (start.directions[i])
+			{
+			case GHOST_UP:		velocity.z = -1.0f; break;
+			case GHOST_DOWN:	velocity.z = 1.0f; break;
+			case GHOST_LEFT:	velocity.x = -1.0f; break;
+			default:			velocity.x = 1.0f; break;
+			}
+			objects.push_back(std::make_unique<ObjectGhost>(glm::vec3(start.x[i], 0.5f, start.z[i]), velocity));
+		}
+
+		long long objectEntered = 0;
+		auto objectStart = std::chrono::steady_clock::now();
+		for (int tick = 0; tick < ticks; tick++)
+		{
+			for (std::unique_ptr<ObjectGhost>& ghost : objects)
+			{
+				objectEntered += ghost->move(delta) ? 1 : 0;
+			}
+		}
+		double objectNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - objectStart).count() / (static_cast<double>(ticks) * count);
+		std::snprintf(row, sizeof(row), "%-9d %-8s %9.3f %9.2fx\n", count, "object", objectNs, 1.0);
+		std::cout << row;
+
+		GhostArrays reference;
+		long long referenceEntered = 0;
+		for (int level = GhostKernel::SCALAR; level <= best; level++)
+		{
+			GhostKernel::setLevel(static_cast<GhostKernel::Level>(level));
+			GhostArrays ghosts = start;
+			GhostLanes lanes = ghosts.lanes();
+
+			long long enteredTotal = 0;
+			auto kernelStart = std::chrono::steady_clock::now();
+			for (int tick = 0; tick < ticks; tick++)
+			{
+				enteredTotal += GhostKernel::advance(lanes, 0, count, step, entered.data());
+			}
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - kernelStart).count() / (static_cast<double>(ticks) * count);
+
+			bool same = true;
+			if (level == GhostKernel::SCALAR)
+			{
+				// the object ghosts are the reference for the scalar kernel, it for the vector ones.
+				for (int i = 0; i < count && same; i++)
+				{
+					same = objects[i]->getPosition().x == ghosts.x[i] && objects[i]->getPosition().z == ghosts.z[i]
+						&& objects[i]->getTileX() == ghosts.tileX[i] && objects[i]->getTileZ() == ghosts.tileZ[i];
+				}
+				same = same && objectEntered == enteredTotal;
+				reference = ghosts;
+				referenceEntered = enteredTotal;
+			}
+			else
+			{
+				same = ghosts == reference && enteredTotal == referenceEntered;
+			}
+
+			std::snprintf(row, sizeof(row), "%-9d %-8s %9.3f %9.2fx  %s\n", count, GhostKernel::getName(static_cast<GhostKernel::Level>(level)),
+				ns, objectNs / ns, same ? "same" : "DIFFERS");
+			std::cout << row;
+			failed = failed || !same;
+		}
+
+		FixedArrays fixedReference(start);
+		for (int level = GhostKernel::SCALAR; level <= best; level++)
+		{
+			GhostKernel::setLevel(static_cast<GhostKernel::Level>(level));
+			FixedArrays ghosts(start);
+			FixedLanes lanes = ghosts.lanes();
+
+			long long enteredTotal = 0;
+			auto kernelStart = std::chrono::steady_clock::now();
+			for (int tick = 0; tick < ticks; tick++)
+			{
+				enteredTotal += GhostKernel::advanceFixed(lanes, 0, count, fixedStep, entered.data());
+			}
+			double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - kernelStart).count() / (static_cast<double>(ticks) * count);
+
+			bool same = true;
+			if (level == GhostKernel::SCALAR)
+			{
+				fixedReference = ghosts;
+				referenceEntered = enteredTotal;
+			}
+			else
+			{
+				same = ghosts == fixedReference && enteredTotal == referenceEntered;
+			}
+
+			std::string name = std::string("fx-") + GhostKernel::getName(static_cast<GhostKernel::Level>(level));
+			std::snprintf(row, sizeof(row), "%-9d %-9s%9.3f %9.2fx  %s\n", count, name.c_str(), ns, objectNs / ns,
+				level == GhostKernel::SCALAR ? "-" : same ? "same" : "DIFFERS");
+			std::cout << row;
+			failed = failed || !same;
+		}
+		std::cout << "\n";
+	}
+
+	GhostKernel::setLevel(active);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
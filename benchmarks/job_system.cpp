@@ -0,0 +1,168 @@
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "DrawList.h"
+#include "JobSystem.h"
+#include "LevelLoader.h"
+#include "GhostStore.h"
+
+/**
+*   Compares the JobSystem against running the same work serially:
+*   building model matrices (render preparation), moving ghosts (simulation), building the ghost
+*   draw list, and the cost of a chain of dependent jobs (job graph overhead).
+*
+*   @name pacman_bench_jobs
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Runs a function a number of times and measures it.
+*
+*   @param repeats  - How many times to run it.
+*   @param function - The work.
+*
+*   @return double - milliseconds per run.
+*/
+static double measure(int repeats, const std::function<void()>& function)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < repeats; i++)
+	{
+		function();
+	}
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+/**
+*   Builds the model matrix of one object, the same way the ghosts are placed.
+*
+*   @param i - Index of the object.
+*
+*   @return glm::mat4 - the matrix.
+*/
+static glm::mat4 buildMatrix(int i)
+{
+	glm::mat4 model(1.0f);
+	model = glm::translate(model, glm::vec3(i % 28 * 2.0f + 1.0f, 0.5f, i / 28 % 36 * 2.0f + 1.0f));
+	model = glm::rotate(model, glm::radians(i * 7.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	model = glm::scale(model, glm::vec3(0.3f));
+	return model;
+}
+
+/**
+*   Prints one line of the comparison.
+*
+*   @param name     - What was measured.
+*   @param serialMs - Milliseconds per run without jobs.
+*   @param jobsMs   - Milliseconds per run with jobs.
+*/
+static void printResult(const char* name, double serialMs, double jobsMs)
+{
+	std::cout << name << "\tserial " << serialMs << " ms\tjobs " << jobsMs << " ms\tspeedup " << serialMs / jobsMs << "x\n";
+}
+
+int main(int argc, char** argv)
+{
+	int threads = static_cast<int>(std::thread::hardware_concurrency());
+	int objects = 200000;
+	int ghosts = 4096;
+	std::string levelPath = "assets/levels/level0";
+
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		std::string arg = argv[i];
+		if (arg == "--threads") { threads = std::atoi(argv[i + 1]); }
+		else if (arg == "--objects") { objects = std::atoi(argv[i + 1]); }
+		else if (arg == "--ghosts") { ghosts = std::atoi(argv[i + 1]); }
+		else if (arg == "--level") { levelPath = argv[i + 1]; }
+	}
+
+	JobSystem jobSystem(threads);
+	std::cout << "threads " << jobSystem.getNumberOfThreads() << "\n\n";
+
+	// Render preparation: one model matrix per object.
+	std::vector<glm::mat4> matrices(objects);
+	double serialMatrices = measure(20, [&]
+	{
+		for (int i = 0; i < objects; i++)
+		{
+			matrices[i] = buildMatrix(i);
+		}
+	});
+	double jobMatrices = measure(20, [&]
+	{
+		jobSystem.parallelFor(objects, [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				matrices[i] = buildMatrix(i);
+			}
+		});
+	});
+	printResult("matrices", serialMatrices, jobMatrices);
+
+	// Simulation: the ghost moves Simulation::update() splits into jobs. The ghosts are moved
+	// directly, a whole Simulation with this many ghosts is lost after a few ticks.
+	LevelLoader levelLoader;
+	levelLoader.loadLevel(levelPath);
+	GhostStore ghostList(levelLoader.getGrid(), ghosts, 1);
+	glm::vec3 playerPosition(27.0f, 1.0f, 47.0f);
+	ghostList.track(playerPosition);
+
+	double serialTicks = measure(200, [&]
+	{
+		ghostList.move(0, ghosts, 1.0f / 120.0f);
+	});
+	double jobTicks = measure(200, [&]
+	{
+		jobSystem.parallelFor(ghosts, [&](int begin, int end)
+		{
+			ghostList.move(begin, end, 1.0f / 120.0f);
+		});
+	});
+	printResult("ghosts  ", serialTicks, jobTicks);
+
+	// Render preparation of the ghosts: culling, model matrices and sorting for both views.
+	ghostList.interpolate(1.0f);
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1200.0f);
+	glm::vec3 eye(27.0f, 1.0f, 47.0f);
+	glm::mat4 sceneViewProjection = projection * glm::lookAt(eye, eye + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 minimapViewProjection = projection * glm::lookAt(glm::vec3(27.0f, 90.0f, 36.0f), glm::vec3(27.0f, 0.0f, 35.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	DrawList drawList;
+	double serialDrawList = measure(200, [&]
+	{
+		drawList.buildGhosts(ghostList, sceneViewProjection, minimapViewProjection, eye, nullptr);
+	});
+	double jobDrawList = measure(200, [&]
+	{
+		drawList.buildGhosts(ghostList, sceneViewProjection, minimapViewProjection, eye, &jobSystem);
+	});
+	printResult("draw list", serialDrawList, jobDrawList);
+	std::cout << "draw list items " << drawList.size() << ", culled " << drawList.getCulled() << "\n";
+
+	// Job graph: a chain where every job depends on the one before it.
+	const int chainLength = 10000;
+	volatile int sink = 0;
+	double chain = measure(5, [&]
+	{
+		JobHandle previous;
+		for (int i = 0; i < chainLength; i++)
+		{
+			previous = jobSystem.submit([&sink] { sink = sink + 1; }, { previous });
+		}
+		jobSystem.wait(previous);
+	});
+	std::cout << "dependent job overhead " << chain * 1000.0 / chainLength << " us per job\n";
+
+	return EXIT_SUCCESS;
+}
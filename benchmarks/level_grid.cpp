@@ -0,0 +1,270 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CounterRandom.h"
+#include "LevelGrid.h"
+#include "LevelLoader.h"
+#include "MazeGenerator.h"
+
+/**
+*   Measures wall queries: the open neighbours of a tile, the question every ghost and the player
+*   ask when they move. The LevelGrid bitboard in both layouts is compared against the nested
+*   vectors of ints the level is loaded into and against a flat array of 1 byte per tile.
+*
+*   Two access patterns: "random" asks about tiles all over the level, "walk" follows ghosts that
+*   step to a random open neighbour, so queries stay close together like in a game. Every kind
+*   of storage has to give the same answers, the exit code is non zero when one doesn't.
+*
+*   @name pacman_bench_level_grid
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const int WALKERS = 256;
+
+/**
+*   Open neighbours from the nested vectors, bounds checked the way the movement code did it.
+*/
+static unsigned nestedOpen(const std::vector<std::vector<int>>& level, int x, int z)
+{
+	int tilesX = static_cast<int>(level[0].size());
+	int tilesZ = static_cast<int>(level.size());
+	int left = x == 0 ? tilesX - 1 : x - 1;
+	int right = x == tilesX - 1 ? 0 : x + 1;
+
+	unsigned open = 0;
+	if (z > 0 && level[z - 1][x] != 1) { open |= LevelGrid::OPEN_UP; }
+	if (z < tilesZ - 1 && level[z + 1][x] != 1) { open |= LevelGrid::OPEN_DOWN; }
+	if (level[z][left] != 1) { open |= LevelGrid::OPEN_LEFT; }
+	if (level[z][right] != 1) { open |= LevelGrid::OPEN_RIGHT; }
+	return open;
+}
+
+/* 1 byte per tile, row major. */
+struct ByteGrid
+{
+	int tilesX;
+	int tilesZ;
+	std::vector<uint8_t> tiles;
+
+	explicit ByteGrid(const std::vector<std::vector<int>>& level)
+		: tilesX(static_cast<int>(level[0].size())), tilesZ(static_cast<int>(level.size()))
+	{
+		for (const std::vector<int>& row : level)
+		{
+			for (int tile : row)
+			{
+				tiles.push_back(tile == 1 ? 1 : 0);
+			}
+		}
+	}
+
+	unsigned open(int x, int z) const
+	{
+		int left = x == 0 ? tilesX - 1 : x - 1;
+		int right = x == tilesX - 1 ? 0 : x + 1;
+		const uint8_t* row = tiles.data() + static_cast<size_t>(z) * tilesX;
+
+		unsigned open = 0;
+		if (z > 0 && row[x - tilesX] == 0) { open |= LevelGrid::OPEN_UP; }
+		if (z < tilesZ - 1 && row[x + tilesX] == 0) { open |= LevelGrid::OPEN_DOWN; }
+		if (row[left] == 0) { open |= LevelGrid::OPEN_LEFT; }
+		if (row[right] == 0) { open |= LevelGrid::OPEN_RIGHT; }
+		return open;
+	}
+};
+
+/* The tiles a benchmark asks about. */
+struct Queries
+{
+	std::vector<int> randomTiles;		// x and z interleaved.
+	std::vector<uint32_t> walkChoices;	// random numbers the walkers choose their next step with.
+	std::vector<int> walkStarts;		// x and z of each walker.
+};
+
+/**
+*   Runs a query function over both access patterns.
+*
+*   @param queries - The tiles to ask about.
+*   @param tilesX  - Tiles in X, for the walkers to wrap around.
+*   @param open    - Open neighbours of (x, z).
+*   @param randomNs - Gets the time per random query.
+*   @param walkNs   - Gets the time per walk query.
+*
+*   @return unsigned long long - checksum of the answers.
+*/
+template <typename Open>
+static unsigned long long run(const Queries& queries, int tilesX, Open open, double& randomNs, double& walkNs)
+{
+	unsigned long long checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < queries.randomTiles.size(); i += 2)
+	{
+		checksum += open(queries.randomTiles[i], queries.randomTiles[i + 1]) * (i % 7 + 1); // no chain between the queries.
+	}
+	auto randomEnd = std::chrono::steady_clock::now();
+
+	// nextDirection[open][choice] is the first open direction from the chosen one on, 4 for none.
+	uint8_t nextDirection[16][4];
+	for (unsigned bits = 0; bits < 16; bits++)
+	{
+		for (unsigned choice = 0; choice < 4; choice++)
+		{
+			nextDirection[bits][choice] = 4;
+			for (unsigned i = 0; i < 4; i++)
+			{
+				if ((bits >> ((choice + i) % 4)) & 1u)
+				{
+					nextDirection[bits][choice] = static_cast<uint8_t>((choice + i) % 4);
+					break;
+				}
+			}
+		}
+	}
+	static const int stepX[] = { 0, 0, -1, 1, 0 }; // up, down, left, right, none.
+	static const int stepZ[] = { -1, 1, 0, 0, 0 };
+
+	std::vector<int> walkers = queries.walkStarts;
+	size_t steps = queries.walkChoices.size() / WALKERS;
+	for (size_t step = 0; step < steps; step++)
+	{
+		for (int w = 0; w < WALKERS; w++)
+		{
+			int& x = walkers[w * 2];
+			int& z = walkers[w * 2 + 1];
+			unsigned bits = open(x, z);
+			checksum += bits * (w % 7 + 1);
+
+			uint8_t direction = nextDirection[bits][queries.walkChoices[step * WALKERS + w] % 4];
+			x += stepX[direction];
+			z += stepZ[direction];
+			x = x < 0 ? tilesX - 1 : x == tilesX ? 0 : x;
+		}
+	}
+	auto walkEnd = std::chrono::steady_clock::now();
+
+	randomNs = std::chrono::duration<double, std::nano>(randomEnd - start).count() / (queries.randomTiles.size() / 2);
+	walkNs = std::chrono::duration<double, std::nano>(walkEnd - randomEnd).count() / queries.walkChoices.size();
+	return checksum;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> levels = { "level0", "1024x1024", "4096x4096" };
+	int queryCount = 4000000;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--levels" && hasValue)
+		{
+			levels.clear();
+			std::stringstream list(argv[++i]);
+			std::string item;
+			while (std::getline(list, item, ','))
+			{
+				levels.push_back(item);
+			}
+		}
+		else if (arg == "--queries" && hasValue) { queryCount = std::atoi(argv[++i]); }
+		else
+		{
+			std::cerr << "usage: pacman_bench_level_grid [--levels level0,1024x1024,...] [--queries N]\n";
+			return EXIT_FAILURE;
+		}
+	}
+	if (queryCount < WALKERS)
+	{
+		queryCount = WALKERS;
+	}
+
+	bool failed = false;
+	std::cout << queryCount << " queries per pattern\n\n";
+	std::cout << "level       storage       bytes   random ns   walk ns  result\n";
+
+	for (const std::string& name : levels)
+	{
+		std::vector<std::vector<int>> level;
+		int tilesX = 0;
+		int tilesZ = 0;
+		if (std::sscanf(name.c_str(), "%dx%d", &tilesX, &tilesZ) == 2)
+		{
+			MazeGenerator generator(42u);
+			generator.generate(tilesX, tilesZ);
+			level = generator.getLevel();
+		}
+		else
+		{
+			LevelLoader loader;
+			loader.loadLevel("assets/levels/" + name);
+			level = loader.getLevel();
+		}
+		tilesX = static_cast<int>(level[0].size());
+		tilesZ = static_cast<int>(level.size());
+
+		// only open tiles are asked about, that is all the movement code ever does.
+		Queries queries;
+		CounterRandom random(7u);
+		while (static_cast<int>(queries.randomTiles.size()) < queryCount * 2)
+		{
+			int x = random.nextInt(tilesX - 1);
+			int z = random.nextInt(tilesZ - 1);
+			if (level[z][x] != 1)
+			{
+				queries.randomTiles.push_back(x);
+				queries.randomTiles.push_back(z);
+			}
+		}
+		for (int w = 0; w < WALKERS; w++)
+		{
+			queries.walkStarts.push_back(queries.randomTiles[w * 2]);
+			queries.walkStarts.push_back(queries.randomTiles[w * 2 + 1]);
+		}
+		for (int i = 0; i < queryCount / WALKERS * WALKERS; i++)
+		{
+			queries.walkChoices.push_back(static_cast<uint32_t>(random.next()));
+		}
+
+		ByteGrid bytes(level);
+		LevelGrid rows(level, LevelGrid::ROWS);
+		LevelGrid blocks(level, LevelGrid::BLOCKS);
+
+		size_t nestedBytes = 0;
+		for (const std::vector<int>& row : level)
+		{
+			nestedBytes += sizeof(row) + row.capacity() * sizeof(int);
+		}
+
+		double randomNs = 0.0;
+		double walkNs = 0.0;
+		char row[160];
+
+		unsigned long long reference = run(queries, tilesX, [&level](int x, int z) { return nestedOpen(level, x, z); }, randomNs, walkNs);
+		std::snprintf(row, sizeof(row), "%-11s %-9s %11zu %11.3f %9.3f\n", name.c_str(), "nested", nestedBytes, randomNs, walkNs);
+		std::cout << row;
+
+		unsigned long long checksum = run(queries, tilesX, [&bytes](int x, int z) { return bytes.open(x, z); }, randomNs, walkNs);
+		std::snprintf(row, sizeof(row), "%-11s %-9s %11zu %11.3f %9.3f  %s\n", name.c_str(), "bytes", bytes.tiles.size(), randomNs, walkNs,
+			checksum == reference ? "same" : "DIFFERS");
+		std::cout << row;
+		failed = failed || checksum != reference;
+
+		for (const LevelGrid* grid : { &rows, &blocks })
+		{
+			checksum = run(queries, tilesX, [grid](int x, int z) { return static_cast<unsigned>(grid->openNeighbours(x, z)); }, randomNs, walkNs);
+			std::snprintf(row, sizeof(row), "%-11s %-9s %11zu %11.3f %9.3f  %s\n", name.c_str(), grid->getLayout() == LevelGrid::ROWS ? "rows" : "blocks",
+				grid->getWallBytes(), randomNs, walkNs, checksum == reference ? "same" : "DIFFERS");
+			std::cout << row;
+			failed = failed || checksum != reference;
+		}
+		std::cout << "\n";
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
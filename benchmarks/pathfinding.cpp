@@ -0,0 +1,213 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ClusterGraph.h"
+#include "CounterRandom.h"
+#include "JobSystem.h"
+#include "LevelGrid.h"
+#include "LevelLoader.h"
+#include "MazeGenerator.h"
+#include "PathPlanner.h"
+
+/**
+*   Compares the two ways the PathPlanner searches: A* over the tiles and the hierarchical search
+*   over a ClusterGraph. Random open tiles are joined on generated mazes, the table shows the
+*   time per search, the tiles or nodes expanded and how much longer the hierarchical paths are,
+*   with the time, size and memory of building the graph.
+*
+*   Every hierarchical path has to exist where A* finds one and can't be shorter than it. Ghosts
+*   only take the first step of a path and ask again from the next tile, so a few shorter paths,
+*   still across several clusters, are also walked that way and have to get to the target in no
+*   more steps than the first answer.
+*   The exit code is non zero when one of these fails.
+*
+*   @name pacman_bench_pathfinding
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const int WALKED_PATHS = 8;
+static const int WALK_REACH = 48; // tiles the targets of walked paths are away at most in X and Z.
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> levels = { "1024x1024", "4096x4096" };
+	int queryCount = 30;
+	int threads = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--levels" && hasValue)
+		{
+			levels.clear();
+			std::stringstream list(argv[++i]);
+			std::string item;
+			while (std::getline(list, item, ','))
+			{
+				levels.push_back(item);
+			}
+		}
+		else if (arg == "--queries" && hasValue) { queryCount = std::atoi(argv[++i]); }
+		else if (arg == "--threads" && hasValue) { threads = std::atoi(argv[++i]); }
+		else
+		{
+			std::cerr << "usage: pacman_bench_pathfinding [--levels 1024x1024,4096x4096,...] [--queries N] [--threads N]\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::unique_ptr<JobSystem> jobSystem;
+	if (threads > 1)
+	{
+		jobSystem = std::make_unique<JobSystem>(threads);
+	}
+
+	bool failed = false;
+	std::cout << queryCount << " searches per level, " << WALKED_PATHS << " of them walked\n\n";
+	std::cout << "level       build ms   nodes     edges    graph MB   A* ms  A* expanded  HPA* ms  HPA* expanded  length  result\n";
+
+	for (const std::string& name : levels)
+	{
+		std::vector<std::vector<int>> level;
+		int tilesX = 0;
+		int tilesZ = 0;
+		if (std::sscanf(name.c_str(), "%dx%d", &tilesX, &tilesZ) == 2)
+		{
+			MazeGenerator generator(42u);
+			generator.generate(tilesX, tilesZ);
+			level = generator.getLevel();
+		}
+		else
+		{
+			LevelLoader loader;
+			loader.loadLevel("assets/levels/" + name);
+			level = loader.getLevel();
+		}
+		std::shared_ptr<const LevelGrid> grid = std::make_shared<const LevelGrid>(level);
+		tilesX = grid->getTilesX();
+		tilesZ = grid->getTilesZ();
+
+		auto buildStart = std::chrono::steady_clock::now();
+		ClusterGraph clusters(*grid, jobSystem.get());
+		double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+		PathPlanner planner(grid); // for searchTiles(), a second graph on big levels doesn't matter here.
+
+		std::vector<PathRequest> requests;
+		CounterRandom random(7u);
+		while (static_cast<int>(requests.size()) < queryCount)
+		{
+			int from = random.nextInt(tilesX * tilesZ - 1);
+			int to = random.nextInt(tilesX * tilesZ - 1);
+			if (grid->getTiles()[from] != LevelGrid::WALL && grid->getTiles()[to] != LevelGrid::WALL)
+			{
+				requests.push_back({ static_cast<int>(requests.size()), from, to, GHOST_NONE });
+			}
+		}
+		std::vector<PathRequest> walks;
+		while (static_cast<int>(walks.size()) < WALKED_PATHS)
+		{
+			int from = random.nextInt(tilesX * tilesZ - 1);
+			int x = from % tilesX + random.nextInt(WALK_REACH * 2) - WALK_REACH;
+			int z = from / tilesX + random.nextInt(WALK_REACH * 2) - WALK_REACH;
+			if (x < 0 || z < 0 || x >= tilesX || z >= tilesZ)
+			{
+				continue;
+			}
+			int to = z * tilesX + x;
+			if (grid->getTiles()[from] != LevelGrid::WALL && grid->getTiles()[to] != LevelGrid::WALL)
+			{
+				walks.push_back({ static_cast<int>(walks.size()), from, to, GHOST_NONE });
+			}
+		}
+
+		std::vector<PathResult> shortest;
+		unsigned long long tileExpanded = 0;
+		auto searchStart = std::chrono::steady_clock::now();
+		for (const PathRequest& pathRequest : requests)
+		{
+			shortest.push_back(planner.searchTiles(pathRequest, tileExpanded));
+		}
+		double tileMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - searchStart).count() / requests.size();
+
+		std::vector<PathResult> hierarchical;
+		unsigned long long clusterExpanded = 0;
+		searchStart = std::chrono::steady_clock::now();
+		for (const PathRequest& pathRequest : requests)
+		{
+			hierarchical.push_back(clusters.solve(pathRequest, clusterExpanded));
+		}
+		double clusterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - searchStart).count() / requests.size();
+
+		bool valid = true;
+		long long shortestSteps = 0;
+		long long hierarchicalSteps = 0;
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if ((shortest[i].length < 0) != (hierarchical[i].length < 0) || hierarchical[i].length < shortest[i].length)
+			{
+				valid = false;
+			}
+			shortestSteps += shortest[i].length > 0 ? shortest[i].length : 0;
+			hierarchicalSteps += hierarchical[i].length > 0 ? hierarchical[i].length : 0;
+		}
+
+		// walk the first steps like a ghost, the heading keeps it from turning back.
+		for (const PathRequest& walk : walks)
+		{
+			unsigned long long expanded = 0;
+			PathResult first = clusters.solve(walk, expanded);
+			PathResult tiles = planner.searchTiles(walk, expanded);
+			if ((first.length < 0) != (tiles.length < 0) || first.length < tiles.length)
+			{
+				valid = false;
+			}
+			if (first.length <= 0)
+			{
+				continue;
+			}
+			PathRequest pathRequest = walk;
+			int steps = 0;
+			while (pathRequest.fromTile != pathRequest.targetTile && steps <= first.length)
+			{
+				PathResult result = clusters.solve(pathRequest, expanded);
+				if (result.direction == GHOST_NONE)
+				{
+					break;
+				}
+				int x = pathRequest.fromTile % tilesX;
+				int z = pathRequest.fromTile / tilesX;
+				switch (result.direction)
+				{
+				case GHOST_UP:		z--; break;
+				case GHOST_DOWN:	z++; break;
+				case GHOST_LEFT:	x = x == 0 ? tilesX - 1 : x - 1; break;
+				default:			x = x == tilesX - 1 ? 0 : x + 1; break;
+				}
+				pathRequest.fromTile = z * tilesX + x;
+				pathRequest.heading = result.direction;
+				steps++;
+			}
+			if (pathRequest.fromTile != pathRequest.targetTile || steps > first.length)
+			{
+				valid = false;
+			}
+		}
+		failed = failed || !valid;
+
+		char row[200];
+		std::snprintf(row, sizeof(row), "%-11s %8.1f %7zu %9zu %10.2f %8.3f %12.0f %8.3f %14.0f %7.3f  %s\n", name.c_str(), buildMs,
+			clusters.getNodes().size(), clusters.getEdges().size(), clusters.getBytes() / (1024.0 * 1024.0),
+			tileMs, static_cast<double>(tileExpanded) / requests.size(), clusterMs, static_cast<double>(clusterExpanded) / requests.size(),
+			shortestSteps > 0 ? static_cast<double>(hierarchicalSteps) / shortestSteps : 1.0, valid ? "ok" : "WRONG");
+		std::cout << row;
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
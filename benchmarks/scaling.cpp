@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "DrawList.h"
+#include "JobSystem.h"
+#include "LevelLoader.h"
+#include "MazeGenerator.h"
+#include "Simulation.h"
+
+/**
+*   Runs the simulation on generated scenarios of growing size and prints a scaling table: time
+*   per tick, memory and the time of each system. By default the number of ghosts is swept on
+*   level0 and the level size is swept with a fixed number of ghosts, --grid runs every
+*   combination. --render also builds the ghost draw list every tick, the CPU side of a frame.
+*   --plan lets the ghosts plan their chase with the PathPlanner instead of the flow field, the
+*   worst tick shows the spikes of searching the whole level when the player changes tile.
+*   --events moves the ghosts by events, a tick only runs the ghosts that decide in it.
+*   --lod 16:4,48:16 moves the ghosts far from the player every few ticks, in distance bands.
+*   --fixed moves the player and the ghosts in 16.16 fixed point, not with --events or --lod,
+*   which only work in float.
+*
+*   The games are endless, the player is never caught and never wins, so every tick does the
+*   same work however many ghosts there are.
+*
+*   @name pacman_bench_scaling
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+struct Scenario
+{
+	std::string level;	// "level0" or a generated size like "512x512".
+	int ghosts;
+};
+
+/**
+*   Resident memory of the process.
+*
+*   @return double - megabytes, 0 where it can't be read.
+*/
+static double residentMegabytes()
+{
+#ifdef __linux__
+	std::ifstream statm("/proc/self/statm");
+	long long pages = 0;
+	long long resident = 0;
+	if (statm >> pages >> resident)
+	{
+		return resident * 4096.0 / (1024.0 * 1024.0);
+	}
+#endif
+	return 0.0;
+}
+
+/**
+*   Splits a comma separated list.
+*
+*   @param list - e.g. "4,100,1000".
+*
+*   @return std::vector<std::string> - the items.
+*/
+static std::vector<std::string> split(const std::string& list)
+{
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ','))
+	{
+		if (!item.empty())
+		{
+			items.push_back(item);
+		}
+	}
+	return items;
+}
+
+/**
+*   Loads level0 or generates a level of the size in the name.
+*
+*   @param name - "level0" or "<x>x<y>".
+*   @param seed - Seed of generated levels.
+*
+*   @return std::shared_ptr<const LevelGrid> - the level.
+*/
+static std::shared_ptr<const LevelGrid> makeLevel(const std::string& name, uint64_t seed)
+{
+	if (name == "level0")
+	{
+		LevelLoader levelLoader;
+		levelLoader.loadLevel("assets/levels/level0");
+		return levelLoader.getGrid();
+	}
+
+	int sizeX = std::atoi(name.c_str());
+	size_t separator = name.find('x');
+	int sizeY = separator == std::string::npos ? sizeX : std::atoi(name.c_str() + separator + 1);
+
+	MazeGenerator generator(seed);
+	generator.generate(sizeX, sizeY);
+	return std::make_shared<const LevelGrid>(generator.getLevel());
+}
+
+/**
+*   Builds a scenario, runs it for a number of ticks and prints one row of the table.
+*
+*   @param scenario  - Level and number of ghosts.
+*   @param ticks     - Ticks to run.
+*   @param render    - Also build the draw list every tick.
+*   @param plan      - Ghosts plan their chase with the PathPlanner.
+*   @param scheduled - Ghosts are moved by events.
+*   @param bands     - Ghosts far from the player move every few ticks, empty for none.
+*   @param fixed     - The player and the ghosts move in fixed point.
+*   @param jobSystem - Jobs for the simulation and the draw list.
+*/
+static void runScenario(const Scenario& scenario, int ticks, bool render, bool plan, bool scheduled, const std::vector<DetailBand>& bands,
+	bool fixed, JobSystem& jobSystem)
+{
+	double memoryBefore = residentMegabytes();
+	auto setupStart = std::chrono::steady_clock::now();
+
+	std::unique_ptr<Simulation> simulation = std::make_unique<Simulation>(makeLevel(scenario.level, 1234u), scenario.ghosts, 1234u);
+	simulation->setJobSystem(&jobSystem);
+	simulation->setEndless(true);
+	simulation->setPathPlanning(plan);
+	simulation->setEventScheduling(scheduled);
+	simulation->setDetailBands(bands);
+	simulation->setFixedPoint(fixed);
+
+	SimulationTimings timings;
+	simulation->setTimings(&timings);
+
+	DrawList drawList;
+	double drawListMs = 0.0;
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 1200.0f);
+
+	double setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupStart).count();
+	double memory = residentMegabytes() - memoryBefore;
+
+	bool keys[1024] = {};
+	keys[KEY_W] = true; // walk forward and turn now and then, the ghosts follow.
+	const float dt = 1.0f / 120.0f;
+
+	double worstMs = 0.0;
+	auto runStart = std::chrono::steady_clock::now();
+	for (int tick = 0; tick < ticks; tick++)
+	{
+		float changeX = tick % 60 == 0 ? 90.0f / 0.03f / 60.0f : 0.0f;
+		auto tickStart = std::chrono::steady_clock::now();
+		simulation->update(keys, changeX, 0.0f, dt);
+		worstMs = std::max(worstMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tickStart).count());
+
+		if (render)
+		{
+			auto renderStart = std::chrono::steady_clock::now();
+			simulation->interpolate(0.5f);
+			std::shared_ptr<Camera>& camera = simulation->getCamera();
+			drawList.buildGhosts(simulation->getGhosts(), projection * camera->calculateViewMatrix(),
+				projection * camera->calculateMinimapView(), camera->getRenderPosition(), &jobSystem);
+			drawListMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+		}
+	}
+	double tickMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count() / ticks;
+
+	char row[256];
+	std::snprintf(row, sizeof(row), "%-11s %8d %9d %9.1f %8.1f %9.4f %9.4f %9.4f %9.4f %9.4f %9.4f\n",
+		scenario.level.c_str(), scenario.ghosts, simulation->getPellets().getNumPellets(), setupMs, memory, tickMs, worstMs,
+		timings.playerMs / ticks, timings.ghostsMs / ticks, timings.pelletsMs / ticks, render ? drawListMs / ticks : 0.0);
+	std::cout << row << std::flush;
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> ghostList = split("4,100,1000,10000,100000");
+	std::vector<std::string> levelList = split("level0,128x128,512x512,1024x1024,4096x4096");
+	int baseGhosts = 100;
+	int ticks = 100;
+	int threads = 0;
+	bool grid = false;
+	bool render = false;
+	bool plan = false;
+	bool scheduled = false;
+	std::vector<DetailBand> bands;
+	bool fixed = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--grid") { grid = true; }
+		else if (arg == "--render") { render = true; }
+		else if (arg == "--plan") { plan = true; }
+		else if (arg == "--events") { scheduled = true; }
+		else if (arg == "--fixed") { fixed = true; }
+		else if (arg == "--lod" && hasValue)
+		{
+			for (const std::string& item : split(argv[++i]))
+			{
+				DetailBand band = { 0, 0 };
+				if (std::sscanf(item.c_str(), "%d:%d", &band.tiles, &band.interval) != 2)
+				{
+					std::cerr << "--lod takes tiles:interval pairs like 16:4,48:16\n";
+					return EXIT_FAILURE;
+				}
+				bands.push_back(band);
+			}
+		}
+		else if (arg == "--ghosts" && hasValue) { ghostList = split(argv[++i]); }
+		else if (arg == "--levels" && hasValue) { levelList = split(argv[++i]); }
+		else if (arg == "--base-ghosts" && hasValue) { baseGhosts = std::atoi(argv[++i]); }
+		else if (arg == "--ticks" && hasValue) { ticks = std::atoi(argv[++i]); }
+		else if (arg == "--threads" && hasValue) { threads = std::atoi(argv[++i]); }
+		else
+		{
+			std::cerr << "usage: pacman_bench_scaling [--ghosts 4,100,...] [--levels level0,512x512,...] "
+				"[--base-ghosts N] [--ticks N] [--threads N] [--grid] [--render] [--plan] [--events] [--lod TILES:TICKS,...] [--fixed]\n";
+			return EXIT_FAILURE;
+		}
+	}
+	if (fixed && (scheduled || !bands.empty()))
+	{
+		std::cerr << "--fixed can't be combined with --events or --lod, they move the ghosts in float\n";
+		return EXIT_FAILURE;
+	}
+	if (ticks < 1)
+	{
+		ticks = 1;
+	}
+	if (levelList.empty() || ghostList.empty())
+	{
+		std::cerr << "no levels or ghosts to run\n";
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Scenario> scenarios;
+	if (grid)
+	{
+		for (auto& level : levelList)
+		{
+			for (auto& ghosts : ghostList)
+			{
+				scenarios.push_back({ level, std::atoi(ghosts.c_str()) });
+			}
+		}
+	}
+	else
+	{
+		for (auto& ghosts : ghostList) // ghosts on the first level.
+		{
+			scenarios.push_back({ levelList.front(), std::atoi(ghosts.c_str()) });
+		}
+		for (size_t i = 1; i < levelList.size(); i++) // bigger levels with a fixed number of ghosts.
+		{
+			scenarios.push_back({ levelList[i], baseGhosts });
+		}
+	}
+
+	JobSystem jobSystem(threads);
+	std::cout << "threads " << jobSystem.getNumberOfThreads() << ", ticks " << ticks << (render ? ", with draw list" : "")
+		<< (plan ? ", planned chase" : "") << (scheduled ? ", scheduled ghosts" : "")
+		<< (bands.empty() ? "" : ", distance bands") << "\n\n";
+	std::cout << "level         ghosts   pellets  setup ms  mem MB   tick ms  worst ms player ms ghosts ms pellet ms  draw ms\n";
+
+	for (auto& scenario : scenarios)
+	{
+		runScenario(scenario, ticks, render, plan, scheduled, bands, fixed, jobSystem);
+	}
+
+	return EXIT_SUCCESS;
+}
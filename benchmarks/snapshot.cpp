@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "LevelLoader.h"
+#include "Simulation.h"
+
+/**
+*   Measures Simulation::saveState() and restoreState() on level0 in the middle of a game, and
+*   checks that a restored game plays out exactly like the original: the state is saved, the game
+*   runs on, is restored and runs the same ticks again, both runs have to end in the same bytes.
+*   Every ghost count is run in float, in fixed point, with event scheduling and with distance
+*   bands, and a state of each mode has to be refused by a game in every other mode.
+*
+*   The round trip on level0 in float with the default 4 ghosts has to stay under 10
+*   microseconds, the exit code is non zero when it doesn't, when a restored game differs or when
+*   a state restores into another mode.
+*
+*   @name pacman_bench_snapshot
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const double BUDGET_US = 10.0;
+
+enum SnapshotMode { MODE_FLOAT, MODE_FIXED, MODE_EVENTS, MODE_LOD, MODE_COUNT };
+
+static const char* modeNames[] = { "float", "fixed", "events", "lod" }; // indexed by SnapshotMode.
+
+/**
+*   Sets a game up in one of the modes a state can be saved in.
+*
+*   @param simulation - The game.
+*   @param mode       - The mode.
+*/
+static void setMode(Simulation& simulation, SnapshotMode mode)
+{
+	simulation.setFixedPoint(mode == MODE_FIXED);
+	simulation.setEventScheduling(mode == MODE_EVENTS);
+	simulation.setDetailBands(mode == MODE_LOD ? std::vector<DetailBand>{ { 16, 4 }, { 48, 16 } } : std::vector<DetailBand>());
+}
+
+/**
+*   Steps a game with the player walking forward and turning every second.
+*
+*   @param simulation - The game.
+*   @param ticks      - How many ticks to run.
+*/
+static void play(Simulation& simulation, int ticks)
+{
+	bool keys[1024] = {};
+	keys[KEY_W] = true;
+	for (int i = 0; i < ticks; i++)
+	{
+		float changeX = simulation.getTick() % 120 == 0 ? 1000.0f : 0.0f;
+		simulation.update(keys, changeX, 0.0f, 1.0f / 120.0f);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<int> ghostCounts = { 4, 100, 1000 };
+	int iterations = 100000;
+	int warmupTicks = 600;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--ghosts" && hasValue)
+		{
+			ghostCounts.clear();
+			std::stringstream list(argv[++i]);
+			std::string item;
+			while (std::getline(list, item, ','))
+			{
+				ghostCounts.push_back(std::atoi(item.c_str()));
+			}
+		}
+		else if (arg == "--iterations" && hasValue) { iterations = std::atoi(argv[++i]); }
+		else if (arg == "--warmup-ticks" && hasValue) { warmupTicks = std::atoi(argv[++i]); }
+		else
+		{
+			std::cerr << "usage: pacman_bench_snapshot [--ghosts 4,100,...] [--iterations N] [--warmup-ticks N]\n";
+			return EXIT_FAILURE;
+		}
+	}
+	if (iterations < 1)
+	{
+		iterations = 1;
+	}
+
+	LevelLoader levelLoader;
+	levelLoader.loadLevel("assets/levels/level0");
+
+	bool failed = false;
+	std::cout << "level0, " << iterations << " iterations\n\n";
+	std::cout << "mode   ghosts     bytes   save us restore us  round us  replay   other modes\n";
+
+	for (int modeIndex = 0; modeIndex < MODE_COUNT; modeIndex++)
+	{
+		SnapshotMode mode = static_cast<SnapshotMode>(modeIndex);
+		for (int ghosts : ghostCounts)
+		{
+			Simulation simulation(levelLoader.getGrid(), ghosts, 1234u);
+			simulation.setEndless(true); // stays mid-game however often the player is caught.
+			setMode(simulation, mode);
+			play(simulation, warmupTicks);
+
+			std::vector<uint8_t> saved;
+			std::vector<uint8_t> first;
+			std::vector<uint8_t> second;
+
+			simulation.saveState(saved);
+			play(simulation, 300);
+			simulation.saveState(first);
+			bool restored = simulation.restoreState(saved);
+			play(simulation, 300);
+			simulation.saveState(second);
+			bool replayed = restored && first == second;
+
+			bool refused = true;
+			for (int other = 0; other < MODE_COUNT; other++)
+			{
+				if (other != modeIndex)
+				{
+					Simulation otherGame(levelLoader.getGrid(), ghosts, 1234u);
+					setMode(otherGame, static_cast<SnapshotMode>(other));
+					refused = refused && !otherGame.restoreState(saved);
+				}
+			}
+
+			std::vector<uint8_t> buffer;
+			simulation.saveState(buffer); // the buffer has its capacity from here on.
+
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++)
+			{
+				simulation.saveState(buffer);
+			}
+			auto saveEnd = std::chrono::steady_clock::now();
+			for (int i = 0; i < iterations; i++)
+			{
+				simulation.restoreState(buffer);
+			}
+			auto restoreEnd = std::chrono::steady_clock::now();
+
+			double saveUs = std::chrono::duration<double, std::micro>(saveEnd - start).count() / iterations;
+			double restoreUs = std::chrono::duration<double, std::micro>(restoreEnd - saveEnd).count() / iterations;
+
+			char row[128];
+			std::snprintf(row, sizeof(row), "%-6s %-6d %9zu %9.3f %10.3f %9.3f  %-8s %s\n", modeNames[mode], ghosts, buffer.size(), saveUs,
+				restoreUs, saveUs + restoreUs, replayed ? "exact" : "DIFFERS", refused ? "refused" : "RESTORED");
+			std::cout << row;
+
+			failed = failed || !replayed || !refused || (mode == MODE_FLOAT && ghosts == 4 && saveUs + restoreUs >= BUDGET_US);
+		}
+	}
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,402 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CounterRandom.h"
+#include "InputRecording.h"
+#include "InputState.h"
+#include "JobSystem.h"
+#include "LevelLoader.h"
+#include "Simulation.h"
+
+/**
+*   Runs whole games of Pacman without a window or an OpenGL context. The player is driven by
+*   a script instead of the keyboard, which makes it possible to run thousands of games on a
+*   machine without a GPU, for tuning the ghost AI or for load testing.
+*
+*   Script files have one step per line: <ticks> <keys> <mouseX>. Keys is any combination of
+*   W, A, S and D (or - for none) held for that many ticks, mouseX is the mouse movement
+*   applied on the first tick of the step. Lines starting with # are ignored. The script
+*   loops until the game is over or the tick limit is hit.
+*
+*   --replay <file> instead plays back one game recorded with Pacman3D --record, with the
+*   seed, tick rate and fixed point mode stored in the recording, --plan, --events, --lod and
+*   --fixed are not used then. The recording format also has room for planning, events and
+*   bands, which Pacman3D doesn't play with, and replays them as well. --profile <file> writes a Chrome trace of the run.
+*   --lod 16:4,48:16 moves the ghosts 16 tiles or more from the player every 4 ticks and those
+*   48 or more every 16, see GhostStore::setDetailBands(). --fixed moves the player and the
+*   ghosts in 16.16 fixed point, see Simulation::setFixedPoint(). Events and bands only work in
+*   float, --fixed can't be given with --events or --lod.
+*
+*   @name pacman_headless
+*   @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+struct ScriptStep
+{
+	int ticks;
+	std::string keys;
+	float changeX;
+};
+
+/* Added up from the events of every game, the same events the windowed game reacts to. */
+struct Telemetry
+{
+	unsigned long long pelletsEaten;
+	unsigned long long tilesEntered;
+	unsigned long long collisions;
+	unsigned long long levelsCleared;
+	unsigned long long pathsPlanned;
+	long long score;
+
+	Telemetry() : pelletsEaten(0), tilesEntered(0), collisions(0), levelsCleared(0), pathsPlanned(0), score(0) {}
+};
+
+/**
+*   Parses a script in the format described above.
+*
+*   @param in - Stream with the script.
+*
+*   @return std::vector<ScriptStep> - the steps, in order.
+*/
+static std::vector<ScriptStep> parseScript(std::istream& in)
+{
+	std::vector<ScriptStep> steps;
+	std::string line;
+
+	while (std::getline(in, line))
+	{
+		if (line.empty() || line[0] == '#')
+		{
+			continue;
+		}
+
+		std::istringstream lineStream(line);
+		ScriptStep step{ 0, "-", 0.0f };
+		if (lineStream >> step.ticks >> step.keys)
+		{
+			lineStream >> step.changeX;
+			if (step.ticks > 0)
+			{
+				steps.push_back(step);
+			}
+		}
+	}
+	return steps;
+}
+
+/**
+*   The script used when none is given: walk along the corridors and turn a quarter now and then.
+*/
+static const char* defaultScript =
+	"90 W 0\n"
+	"1 - 3000\n"
+	"60 W 0\n"
+	"40 WD 0\n"
+	"1 - -3000\n"
+	"120 W 0\n"
+	"30 S 0\n"
+	"1 - 1500\n";
+
+/**
+*   Reads the distance bands of --lod.
+*
+*   @param text - Comma separated tiles:interval pairs.
+*
+*	@return std::vector<DetailBand> - the bands, empty if one of them can't be read.
+*/
+static std::vector<DetailBand> parseDetailBands(const std::string& text)
+{
+	std::vector<DetailBand> bands;
+	std::stringstream list(text);
+	std::string item;
+	while (std::getline(list, item, ','))
+	{
+		DetailBand band;
+		char separator = 0;
+		std::istringstream pair(item);
+		if (!(pair >> band.tiles >> separator >> band.interval) || separator != ':')
+		{
+			return std::vector<DetailBand>();
+		}
+		bands.push_back(band);
+	}
+	return bands;
+}
+
+/**
+*   Plays one game until it is won, lost or the tick limit is reached.
+*
+*   @param grid           - The level to play on, shared by every game.
+*   @param seed           - Seed of the game.
+*   @param script         - Input to feed the player with.
+*   @param numberOfGhosts - How many ghosts to spawn.
+*   @param maxTicks       - Tick limit for the game.
+*   @param dt             - Length of a tick in seconds.
+*   @param ticksRun       - Gets the number of ticks the game ran for.
+*   @param jobSystem      - Moves the ghosts in parallel when there are many of them, may be null.
+*   @param plan           - Ghosts plan their chase with the PathPlanner instead of the flow field.
+*   @param scheduled      - Ghosts are moved by events instead of every tick.
+*   @param bands          - Ghosts far from the player move every few ticks, empty for none.
+*   @param fixed          - The player and the ghosts move in fixed point.
+*   @param telemetry      - Gets the events of the game added.
+*
+*   @return GameStatus - how the game ended, RUNNING if the tick limit was hit.
+*/
+static GameStatus playGame(const std::shared_ptr<const LevelGrid>& grid, uint64_t seed, const std::vector<ScriptStep>& script,
+	int numberOfGhosts, unsigned long long maxTicks, float dt, unsigned long long& ticksRun, JobSystem* jobSystem, bool plan, bool scheduled, const std::vector<DetailBand>& bands, bool fixed, Telemetry& telemetry)
+{
+	Simulation simulation(grid, numberOfGhosts, seed);
+	simulation.setJobSystem(jobSystem);
+	simulation.setPathPlanning(plan);
+	simulation.setEventScheduling(scheduled);
+	simulation.setDetailBands(bands);
+	simulation.setFixedPoint(fixed);
+
+	EventBus& events = simulation.getEvents();
+	events.subscribe<PelletEaten>([&telemetry](const std::vector<PelletEaten>& eaten) { telemetry.pelletsEaten += eaten.size(); });
+	events.subscribe<TileEntered>([&telemetry](const std::vector<TileEntered>& entered) { telemetry.tilesEntered += entered.size(); });
+	events.subscribe<GhostCollision>([&telemetry](const std::vector<GhostCollision>&) { telemetry.collisions++; });
+	events.subscribe<LevelCleared>([&telemetry](const std::vector<LevelCleared>&) { telemetry.levelsCleared++; });
+
+	bool keys[1024] = { false };
+	size_t stepIndex = 0;
+	int ticksLeftInStep = 0;
+	float changeX = 0.0f;
+
+	while (simulation.getStatus() == GameStatus::RUNNING && simulation.getTick() < maxTicks)
+	{
+		if (ticksLeftInStep == 0)
+		{
+			const ScriptStep& step = script[stepIndex];
+			stepIndex = (stepIndex + 1) % script.size();
+
+			ticksLeftInStep = step.ticks;
+			changeX = step.changeX;
+
+			keys[KEY_W] = step.keys.find('W') != std::string::npos;
+			keys[KEY_A] = step.keys.find('A') != std::string::npos;
+			keys[KEY_S] = step.keys.find('S') != std::string::npos;
+			keys[KEY_D] = step.keys.find('D') != std::string::npos;
+		}
+
+		simulation.update(keys, changeX, 0.0f, dt);
+		changeX = 0.0f; // mouse movement only counts once.
+		ticksLeftInStep--;
+	}
+
+	ticksRun = simulation.getTick();
+	telemetry.score += simulation.getScore();
+	if (simulation.getPlanner() != nullptr)
+	{
+		telemetry.pathsPlanned += simulation.getPlanner()->getSolvedPaths();
+	}
+	return simulation.getStatus();
+}
+
+/**
+*   Plays a recorded game until it is over, the recording runs out or the tick limit is reached.
+*
+*   @param grid           - The level the game was recorded on.
+*   @param replay         - The recording, gives the seed, tick rate, modes and input.
+*   @param numberOfGhosts - How many ghosts to spawn.
+*   @param maxTicks       - Tick limit for the game.
+*
+*   @return int - exit code for main().
+*/
+static int replayGame(const std::shared_ptr<const LevelGrid>& grid, InputReplay& replay, int numberOfGhosts, unsigned long long maxTicks)
+{
+	std::vector<DetailBand> bands;
+	for (const InputBand& band : replay.getBands())
+	{
+		bands.push_back({ band.tiles, band.interval });
+	}
+
+	Simulation simulation(grid, numberOfGhosts, replay.getSeed());
+	simulation.setPathPlanning((replay.getModes() & INPUT_MODE_PLAN) != 0);
+	simulation.setEventScheduling((replay.getModes() & INPUT_MODE_EVENTS) != 0);
+	simulation.setDetailBands(bands);
+	simulation.setFixedPoint((replay.getModes() & INPUT_MODE_FIXED) != 0);
+	InputState input;
+	float dt = 1.0f / (replay.getTickRate() > 0 ? replay.getTickRate() : 1);
+
+	while (simulation.getStatus() == GameStatus::RUNNING && !replay.finished() && simulation.getTick() < maxTicks)
+	{
+		replay.applyTick(static_cast<uint32_t>(simulation.getTick()), input);
+		simulation.update(input.retrieveKeys(), input.getChangeX(), input.getChangeY(), dt);
+	}
+
+	const char* result = simulation.getStatus() == GameStatus::WON ? "won" : simulation.getStatus() == GameStatus::LOST ? "lost" : "unfinished";
+	std::cout << "seed:         " << replay.getSeed() << '\n'
+		<< "events:       " << replay.getEventCount() << '\n'
+		<< "ticks:        " << simulation.getTick() << '\n'
+		<< "score:        " << simulation.getScore() << '\n'
+		<< "result:       " << result << '\n';
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+	int games = 1000;
+	int numberOfGhosts = 4;
+	int tickRate = 120;
+	unsigned long long maxTicks = 120 * 60 * 5; // five minutes of game time.
+	uint64_t seed = 1;
+	std::string levelPath = "assets/levels/level0";
+	std::string scriptPath;
+	std::string replayPath;
+	std::string profilePath;
+	int threads = 1;
+	bool plan = false;
+	bool scheduled = false;
+	std::vector<DetailBand> bands;
+	bool fixed = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--games" && hasValue) { games = std::atoi(argv[++i]); }
+		else if (arg == "--ghosts" && hasValue) { numberOfGhosts = std::atoi(argv[++i]); }
+		else if (arg == "--tick-rate" && hasValue) { tickRate = std::atoi(argv[++i]); }
+		else if (arg == "--max-ticks" && hasValue) { maxTicks = std::strtoull(argv[++i], nullptr, 10); }
+		else if (arg == "--seed" && hasValue) { seed = std::strtoull(argv[++i], nullptr, 10); }
+		else if (arg == "--level" && hasValue) { levelPath = argv[++i]; }
+		else if (arg == "--script" && hasValue) { scriptPath = argv[++i]; }
+		else if (arg == "--replay" && hasValue) { replayPath = argv[++i]; }
+		else if (arg == "--profile" && hasValue) { profilePath = argv[++i]; }
+		else if (arg == "--threads" && hasValue) { threads = std::atoi(argv[++i]); }
+		else if (arg == "--plan") { plan = true; }
+		else if (arg == "--events") { scheduled = true; }
+		else if (arg == "--fixed") { fixed = true; }
+		else if (arg == "--lod" && hasValue)
+		{
+			bands = parseDetailBands(argv[++i]);
+			if (bands.empty())
+			{
+				std::cerr << "--lod takes tiles:interval pairs like 16:4,48:16\n";
+				return EXIT_FAILURE;
+			}
+		}
+		else
+		{
+			std::cerr << "usage: pacman_headless [--games N] [--ghosts N] [--tick-rate HZ] [--max-ticks N] "
+				<< "[--seed N] [--level PATH] [--script PATH] [--replay PATH] [--profile PATH] [--threads N] [--plan] [--events] [--lod TILES:TICKS,...] [--fixed]\n";
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (fixed && (scheduled || !bands.empty()))
+	{
+		std::cerr << "--fixed can't be combined with --events or --lod, they move the ghosts in float\n";
+		return EXIT_FAILURE;
+	}
+
+	if (tickRate < 1)
+	{
+		tickRate = 1;
+	}
+
+	if (!profilePath.empty())
+	{
+		PROFILE_THREAD_NAME("main");
+		Profiler::start(profilePath);
+	}
+
+	if (!replayPath.empty())
+	{
+		InputReplay replay;
+		if (!replay.open(replayPath))
+		{
+			return EXIT_FAILURE;
+		}
+
+		LevelLoader levelLoader;
+		levelLoader.loadLevel(levelPath);
+		int result = replayGame(levelLoader.getGrid(), replay, numberOfGhosts, maxTicks);
+		Profiler::save();
+		return result;
+	}
+
+	std::vector<ScriptStep> script;
+	if (scriptPath.empty())
+	{
+		std::istringstream in(defaultScript);
+		script = parseScript(in);
+	}
+	else
+	{
+		std::ifstream in(scriptPath);
+		if (!in)
+		{
+			std::cerr << "Unable to open script " << scriptPath << '\n';
+			return EXIT_FAILURE;
+		}
+		script = parseScript(in);
+	}
+
+	if (script.empty())
+	{
+		std::cerr << "Script has no steps." << '\n';
+		return EXIT_FAILURE;
+	}
+
+	LevelLoader levelLoader;
+	levelLoader.loadLevel(levelPath);
+	std::shared_ptr<const LevelGrid> grid = levelLoader.getGrid();
+
+	int won = 0;
+	int lost = 0;
+	int unfinished = 0;
+	unsigned long long totalTicks = 0;
+	Telemetry telemetry;
+
+	std::unique_ptr<JobSystem> jobSystem;
+	if (threads != 1)
+	{
+		jobSystem = std::make_unique<JobSystem>(threads); // 0 uses every core.
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < games; i++)
+	{
+		unsigned long long ticksRun = 0;
+		uint64_t gameSeed = CounterRandom::hash(seed, i, 0); // every game is different, but the same for the same --seed.
+		GameStatus status = playGame(grid, gameSeed, script, numberOfGhosts, maxTicks, 1.0f / tickRate, ticksRun, jobSystem.get(), plan, scheduled, bands, fixed, telemetry);
+
+		totalTicks += ticksRun;
+		if (status == GameStatus::WON) { won++; }
+		else if (status == GameStatus::LOST) { lost++; }
+		else { unfinished++; }
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << "games:        " << games << '\n'
+		<< "won:          " << won << '\n'
+		<< "lost:         " << lost << '\n'
+		<< "unfinished:   " << unfinished << '\n'
+		<< "ticks:        " << totalTicks << '\n'
+		<< "pellets:      " << telemetry.pelletsEaten << '\n'
+		<< "tiles:        " << telemetry.tilesEntered << '\n'
+		<< "collisions:   " << telemetry.collisions << '\n'
+		<< "cleared:      " << telemetry.levelsCleared << '\n'
+		<< "paths:        " << telemetry.pathsPlanned << '\n'
+		<< "mean score:   " << (games > 0 ? static_cast<double>(telemetry.score) / games : 0.0) << '\n'
+		<< "seconds:      " << seconds << '\n'
+		<< "games/sec:    " << (seconds > 0.0 ? games / seconds : 0.0) << '\n'
+		<< "ticks/sec:    " << (seconds > 0.0 ? totalTicks / seconds : 0.0) << '\n';
+
+	Profiler::save();
+
+	return EXIT_SUCCESS;
+}
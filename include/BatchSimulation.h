@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CounterRandom.h"
+#include "EventBus.h"
+#include "FlowField.h"
+#include "GhostKernel.h"
+#include "JunctionGraph.h"
+#include "LevelGrid.h"
+#include "Simulation.h"
+#include "JobSystem.h"
+
+/* Steps many independent games of Pacman at once. Every world plays on the same level, which is
+   shared read-only. The state of all worlds is kept in flat arrays (one array per field) so a
+   step is a tight loop over memory, and the worlds are split into jobs on a JobSystem.
+
+   The rules are the same as Camera::keyControls / checkWallCollision and GhostStore::move /
+   calculateAiDirection, just for many worlds at once. The ghosts of a world are moved by
+   GhostKernel, like those of a GhostStore.
+
+   The worlds raise the same events as a Simulation, with the world index set. While the jobs run
+   a world only marks what happened to it, the events are emitted in world order after the step. */
+
+// bits of the per-world input, one per movement key.
+const uint8_t INPUT_W = 1;
+const uint8_t INPUT_A = 2;
+const uint8_t INPUT_S = 4;
+const uint8_t INPUT_D = 8;
+
+class BatchSimulation
+{
+private:
+
+	enum Direction : uint8_t { DIR_NONE, DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT }; // same values as GhostDirection.
+
+	// bits of worldEvents, what happened to a world in the last step.
+	enum WorldEvent : uint8_t { EVENT_PELLET = 1, EVENT_COLLISION = 2, EVENT_CLEARED = 4, EVENT_TILE = 8 };
+
+	/* -- Shared, read-only after construction -- */
+
+	int numberOfWorlds;
+	int numberOfGhosts;
+	int tilesX;
+	int tilesZ;
+	int pelletWords;	// 64 bit words per world in the pellet bit set.
+	int totalPellets;
+
+	std::shared_ptr<const LevelGrid> grid;	// the level, shared with every other user of it.
+	std::vector<int> pelletIndex;			// tile -> pellet number, -1 for tiles without a pellet.
+	std::vector<int> spawnTiles;			// tiles ghosts may spawn on.
+	std::unique_ptr<JunctionGraph> graph;	// where ghosts choose a way, shared by every world.
+	glm::vec3 startingPos;
+
+	bool autoReset;
+
+	/* -- Per world -- */
+
+	std::vector<float> playerX;
+	std::vector<float> playerZ;
+	std::vector<float> playerYaw;
+	std::vector<uint8_t> inputKeys;
+	std::vector<float> inputChangeX;
+	std::vector<GameStatus> status;
+	std::vector<uint32_t> ticks;
+	std::vector<int> pelletsLeft;
+	std::vector<uint64_t> pellets;
+	std::vector<uint64_t> worldSeeds;
+	std::vector<FlowField> flowFields;	// distances to the world's player, one search per tile the player enters.
+	std::vector<int> playerTile;		// tile the player was in at the end of the last step.
+	std::vector<uint8_t> worldEvents;	// WorldEvent bits of the last step.
+	std::vector<int> caughtBy;			// first ghost of the world that caught the player in the last step.
+
+	/* -- Per ghost, index is world * numberOfGhosts + ghost -- */
+
+	std::vector<float> ghostX;
+	std::vector<float> ghostZ;
+	std::vector<uint8_t> ghostDirection;
+	std::vector<int> ghostTileX;	// tile the ghost last made a decision in.
+	std::vector<int> ghostTileZ;
+	std::vector<uint64_t> ghostRandomCounter; // position in the ghost's CounterRandom stream.
+
+	std::unique_ptr<JobSystem> jobSystem;
+	EventBus events;
+
+	int tileIndexX(float x, uint8_t direction) const;
+	int tileIndexZ(float z, uint8_t direction) const;
+	uint8_t ghostCell(int ghost) const;
+	int randomNumber(int ghost, int highestRandomNumber);
+	uint8_t randomOpenDirection(int ghost, uint8_t cell);
+
+	bool playerWallCollision(int world, float unitX, float unitZ, float speed) const;
+	void stepPlayer(int world, float dt);
+	void turnGhost(int world, int ghost);
+	void calculateAiDirection(int world, int ghost, uint8_t cell);
+	void stepWorld(int world, float dt);
+	void emitEvents();
+
+public:
+
+	BatchSimulation(std::shared_ptr<const LevelGrid> levelGrid, int numberOfWorlds, int numberOfGhosts,
+		uint64_t seed, int numberOfThreads = 0);
+	~BatchSimulation();
+
+	void resetWorld(int world);
+	void setInput(int world, uint8_t keys, float changeX);
+	void step(float dt);
+
+	inline void setAutoReset(bool reset) { autoReset = reset; }
+
+	inline int getNumberOfWorlds() const { return numberOfWorlds; }
+	inline int getNumberOfGhosts() const { return numberOfGhosts; }
+	inline int getNumberOfThreads() const { return jobSystem->getNumberOfThreads(); }
+	inline EventBus& getEvents() { return events; }
+
+	inline GameStatus getStatus(int world) const { return status[world]; }
+	inline uint32_t getTick(int world) const { return ticks[world]; }
+	inline uint64_t getWorldSeed(int world) const { return worldSeeds[world]; }
+	inline int getPelletsLeft(int world) const { return pelletsLeft[world]; }
+	inline glm::vec3 getPlayerPosition(int world) const { return glm::vec3(playerX[world], startingPos.y, playerZ[world]); }
+	inline glm::vec3 getGhostPosition(int world, int ghost) const
+	{
+		return glm::vec3(ghostX[world * numberOfGhosts + ghost], 0.5f, ghostZ[world * numberOfGhosts + ghost]);
+	}
+};
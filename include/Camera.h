@@ -1,19 +1,21 @@
 #pragma once
 
-#include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <GLFW/glfw3.h>
-#include <glm/gtx/rotate_vector.hpp>
-
 #include <iostream>
+#include <memory>
 #include <vector>
 
-#include "Renderer.h"
-#include "Material.h"
-#include "Shader.h"
+#include "FixedPoint.h"
+#include "LevelGrid.h"
+
+// key codes the camera reacts to, same values as GLFW_KEY_* so GLWindow::retrieveKeys() can be passed straight in.
+const int KEY_W = 87;
+const int KEY_A = 65;
+const int KEY_S = 83;
+const int KEY_D = 68;
 
 class Camera
 {
@@ -21,58 +23,68 @@ class Camera
 private:
 
 	glm::vec3 position;
+	glm::vec3 previousPosition; // position at the start of the last tick.
+	glm::vec3 renderPosition;	// position between the last two ticks, used for the view.
 	glm::vec3 front;
 	glm::vec3 up;
 	glm::vec3 right;
 	glm::vec3 worldUp;
 
-	GLfloat yaw;
-	GLfloat pitch;
-
-	GLfloat moveSpeed;
-	GLfloat turnSpeed;
-
-	std::vector<std::vector<int>> levelArray;
-
-	std::shared_ptr<VertexArray>		miniMapPacmanVAO;
-	std::unique_ptr<VertexBuffer>		miniMapPacmanVBO;
-	std::unique_ptr<VertexBufferLayout> miniMapPacmanVBLayout;
-	std::shared_ptr<IndexBuffer>		miniMapPacmanIBO;
+	float yaw;
+	float pitch;
 
-	std::shared_ptr<Material> miniMapPacmanMat;
-	std::shared_ptr<Renderer> miniMapPacmanRenderer;
+	float moveSpeed;
+	float turnSpeed;
 
-	std::shared_ptr<Shader> shader;
+	std::shared_ptr<const LevelGrid> grid; // the level, shared with the rest of the game.
 
-	GLuint uniformModel;
-	GLuint uniformView;
-	GLuint uniformProjection;
+	bool fixedPoint;	// move on the 16.16 values below, see setFixedPoint().
+	int32_t fixedX;
+	int32_t fixedZ;
+	int32_t fixedYaw;	// degrees, in [0, FixedPoint::FULL_TURN).
+	int32_t fixedFrontX;
+	int32_t fixedFrontZ;
 
 	enum class direction {
 		UP, DOWN, LEFT, RIGHT
 	};
 
 	void update();
+	void updateFixed();
+	void keyControlsFixed(bool* keys, float deltaTime);
+	bool checkWallCollisionFixed(int32_t directionX, int32_t directionZ, int32_t speed);
 
 public:
 
-	Camera(std::vector<std::vector<int>> levelArrayData, glm::vec3 startPosition, glm::vec3 startUp, 
-		      GLfloat startYaw, GLfloat startPitch, GLfloat startMoveSpeed, GLfloat startTurnSpeed);
+	Camera(std::shared_ptr<const LevelGrid> levelGrid, glm::vec3 startPosition, glm::vec3 startUp, 
+		      float startYaw, float startPitch, float startMoveSpeed, float startTurnSpeed);
 	~Camera();
 
-	void keyControls(bool* keys, GLfloat deltaTime);
-	void mouseControl(GLfloat changeX, GLfloat changeY);
+	void keyControls(bool* keys, float deltaTime);
+	void mouseControl(float changeX, float changeY);
 
 	glm::vec3 getCameraPosition();
 	glm::vec3 getCameraDirection();
+	inline glm::vec3 getRenderPosition() { return renderPosition; }
+	inline glm::vec3 getPreviousPosition() const { return previousPosition; }
+	inline float getYaw() const { return yaw; }
+	inline float getPitch() const { return pitch; }
+
+	void setPose(glm::vec3 newPosition, glm::vec3 newPreviousPosition, float newYaw, float newPitch);
+
+	void setFixedPoint(bool enabled);
+	void setFixedPose(int32_t newX, int32_t newZ, int32_t newYaw);
+	inline bool isFixedPoint() const { return fixedPoint; }
+	inline int32_t getFixedX() const { return fixedX; }
+	inline int32_t getFixedZ() const { return fixedZ; }
+	inline int32_t getFixedYaw() const { return fixedYaw; }
+
+	void interpolate(float alpha);
 
 	glm::mat4 calculateViewMatrix();
 	glm::mat4 calculateMinimapView();
 
-	void drawMiniMapPacman(glm::mat4 projection, std::shared_ptr<Shader>& shader);
-
-	bool checkWallCollision(glm::vec3 unitDirection, GLfloat speed);
+	bool checkWallCollision(glm::vec3 unitDirection, float speed);
 
 
 };
-
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "JobSystem.h"
+#include "LevelGrid.h"
+#include "PathPlanner.h"
+
+/* Hierarchical view of a level for path finding on levels far bigger than level0 (HPA*). The
+   tiles are split into square clusters. Where open tiles meet across the border of two clusters
+   there is an entrance: a node on each side of it, joined by a step. Inside a cluster every two
+   nodes that can reach each other are joined by an edge as long as the shortest walk between
+   them that stays in the cluster. This is all worked out once, when the graph is built.
+
+   A search only walks the tiles of two clusters: the one it starts in, to find how far each
+   node of that cluster is, and the one the target is in. Everything in between is a search
+   over nodes, a few per cluster instead of hundreds of tiles. The paths are not always the
+   shortest, they go through the entrances, but never longer than the length solve() gives.
+   Of the path only the first step is worked out tile by tile, that is all a ghost needs to
+   know at a junction. Asked again from the next tile the length is at least one step shorter,
+   so following the first steps always gets to the target.
+
+   Clusters at the left and right edge are neighbours through the tunnel. */
+
+struct ClusterNode
+{
+	int tile;		// row major index.
+	int cluster;
+	int edgeBegin;	// edges leaving the node in getEdges().
+	int edgeEnd;
+};
+
+struct ClusterEdge
+{
+	int to;			// node index.
+	uint32_t cost;	// steps.
+};
+
+class ClusterGraph
+{
+public:
+
+	static constexpr int CLUSTER_SIZE = 16;	// tiles along each side of a cluster.
+	static const int WIDE_ENTRANCE = 6;	// openings this wide get an entrance at both ends instead of one in the middle.
+
+private:
+
+	const LevelGrid* grid;				// kept alive by whoever owns the graph.
+	int tilesX;
+	int tilesZ;
+	int clustersX;
+	int clustersZ;
+
+	std::vector<ClusterNode> nodes;		// sorted by cluster, then tile.
+	std::vector<ClusterEdge> edges;
+	std::vector<int> clusterNodes;		// nodes of cluster c are clusterNodes[c] to clusterNodes[c + 1] - 1.
+
+	void addEntrances(std::vector<std::pair<int, int>>& steps, int firstA, int firstB, int along, int count) const;
+	void searchCluster(int tile, uint8_t forbidden, std::vector<uint32_t>& distances, std::vector<uint8_t>& firstSteps, std::vector<int>& queue) const;
+	int localIndex(int tile) const;
+	int findNode(int tile) const;
+	int heuristic(int fromTile, int toTile) const;
+	uint8_t directionTo(int fromTile, int toTile) const;
+
+public:
+
+	ClusterGraph(const LevelGrid& levelGrid, JobSystem* jobSystem = nullptr);
+
+	PathResult solve(const PathRequest& pathRequest, unsigned long long& expanded) const;
+
+	/**
+	*   Cluster a tile is in.
+	*
+	*   @param tile - Row major index.
+	*
+	*   @return int - row major index of the cluster.
+	*/
+	inline int clusterOf(int tile) const { return (tile / tilesX) / CLUSTER_SIZE * clustersX + (tile % tilesX) / CLUSTER_SIZE; }
+
+	inline const std::vector<ClusterNode>& getNodes() const { return nodes; }
+	inline const std::vector<ClusterEdge>& getEdges() const { return edges; }
+	inline int getClusters() const { return clustersX * clustersZ; }
+	inline size_t getBytes() const { return nodes.size() * sizeof(ClusterNode) + edges.size() * sizeof(ClusterEdge) + clusterNodes.size() * sizeof(int); }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+/* Counter based random numbers. A number is a pure function of (seed, stream, counter), so there is
+   no generator state to seed or share: every entity keeps its own stream and a counter, and any
+   world, thread or replay gets exactly the same numbers for the same three values. */
+
+class CounterRandom
+{
+private:
+
+	uint64_t seed;
+	uint64_t stream;
+	uint64_t counter;
+
+public:
+
+	CounterRandom(uint64_t seed = 0, uint64_t stream = 0);
+
+	static uint64_t hash(uint64_t seed, uint64_t stream, uint64_t counter);
+	static int uniformInt(uint64_t seed, uint64_t stream, uint64_t counter, int highestNumber);
+
+	uint64_t next();
+	int nextInt(int highestNumber);
+
+	inline uint64_t getSeed() const { return seed; }
+	inline uint64_t getStream() const { return stream; }
+	inline uint64_t getCounter() const { return counter; }
+	inline void setCounter(uint64_t value) { counter = value; }
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "GhostStore.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+
+/* A flat list of everything to draw in a frame. It is built from the game state before any OpenGL
+   call is made: objects outside the view are dropped, model matrices are calculated and the items
+   are sorted by pass, mesh and distance. Building can be split over a JobSystem, the GL thread only
+   walks the finished list and submits it. */
+
+enum DrawPass : uint8_t { DRAW_PASS_SCENE = 0, DRAW_PASS_MINIMAP = 1, DRAW_PASS_COUNT = 2 };
+enum DrawMesh : uint8_t { DRAW_MESH_GHOST = 0 };
+
+struct DrawItem
+{
+	uint64_t sortKey;	// pass | mesh | depth | entity, see makeSortKey().
+	glm::mat4 model;
+	uint32_t entity;	// index of the object in its own container, e.g. the ghost index.
+	uint8_t pass;
+	uint8_t mesh;
+	bool visible;
+};
+
+class DrawList
+{
+private:
+
+	std::vector<DrawItem> items;
+	size_t passBegin[DRAW_PASS_COUNT + 1]; // items of pass p are [passBegin[p], passBegin[p + 1]).
+	size_t culled;
+
+	void buildGhost(const GhostStore& ghosts, uint32_t index, const glm::vec4* scenePlanes, const glm::vec4* minimapPlanes, glm::vec3 eye, size_t ghostCount);
+
+public:
+
+	static const int PARALLEL_ITEMS = 256; // below this, one thread builds the list faster than several.
+
+	DrawList();
+
+	void buildGhosts(const GhostStore& ghosts, const glm::mat4& sceneViewProjection,
+		const glm::mat4& minimapViewProjection, glm::vec3 eye, JobSystem* jobSystem);
+
+	static glm::mat4 ghostModelMatrix(glm::vec3 position, uint8_t direction);
+	static uint64_t makeSortKey(uint8_t pass, uint8_t mesh, float depth, uint32_t entity);
+	static void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4* planes);
+	static bool sphereVisible(const glm::vec4* planes, glm::vec3 center, float radius);
+
+	inline const DrawItem* begin(uint8_t pass) const { return items.data() + passBegin[pass]; }
+	inline const DrawItem* end(uint8_t pass) const { return items.data() + passBegin[pass + 1]; }
+	inline size_t size() const { return passBegin[DRAW_PASS_COUNT]; }
+	inline size_t getCulled() const { return culled; }
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <functional>
+#include <tuple>
+#include <vector>
+#include <glm/glm.hpp>
+
+/* Things that happen during a tick. The simulation only records them, whoever cares (scoring,
+   the window, telemetry) subscribes to the kind it wants and gets every event of that kind of a
+   tick in one call. World is the index of the game in a BatchSimulation, 0 for a Simulation. */
+
+struct PelletEaten
+{
+	int world;
+	int tileX;
+	int tileZ;
+	int pelletsLeft;
+};
+
+struct GhostCollision
+{
+	int world;
+	int ghost;	// the lowest index of the ghosts that caught the player this tick.
+	glm::vec3 position;
+};
+
+struct LevelCleared
+{
+	int world;
+	unsigned long long tick;
+};
+
+struct TileEntered
+{
+	int world;
+	int tileX;
+	int tileZ;
+};
+
+/* Queues the events of a tick, one queue per event type, and hands every queue to its handlers
+   at once in dispatch(). Nothing is called while the tick runs, so handlers see the tick as a
+   whole and the hot loops only push into a vector.
+
+   Events are emitted from one thread at a time, handlers run on the thread that calls
+   dispatch(). To move the events of a tick to another thread, append() them to a bus there. */
+
+template <typename Event>
+struct EventQueue
+{
+	std::vector<Event> events;
+	std::vector<std::function<void(const std::vector<Event>&)>> handlers;
+};
+
+class EventBus
+{
+private:
+
+	std::tuple<EventQueue<PelletEaten>, EventQueue<GhostCollision>, EventQueue<LevelCleared>, EventQueue<TileEntered>> queues;
+
+	template <typename Event>
+	inline EventQueue<Event>& queue() { return std::get<EventQueue<Event>>(queues); }
+
+	template <typename Event>
+	inline const EventQueue<Event>& queue() const { return std::get<EventQueue<Event>>(queues); }
+
+	template <typename Function>
+	inline void forEachQueue(Function function)
+	{
+		std::apply([&function](auto&... queue) { (function(queue), ...); }, queues);
+	}
+
+public:
+
+	EventBus() {}
+
+	EventBus(const EventBus&) = delete;
+	EventBus& operator=(const EventBus&) = delete;
+
+	/**
+	*   Queues an event until the next dispatch().
+	*
+	*   @param event - The event.
+	*/
+	template <typename Event>
+	inline void emit(const Event& event) { queue<Event>().events.push_back(event); }
+
+	/**
+	*   Adds a handler that gets all events of a type of a tick at once.
+	*
+	*   @param handler - Called with the queued events, never with an empty list.
+	*/
+	template <typename Event>
+	inline void subscribe(std::function<void(const std::vector<Event>&)> handler)
+	{
+		queue<Event>().handlers.push_back(std::move(handler));
+	}
+
+	/**
+	*   The events of a type queued since the last clear(), for reading them without a handler.
+	*
+	*   @return const std::vector<Event>& - the events in the order they were emitted.
+	*/
+	template <typename Event>
+	inline const std::vector<Event>& get() const { return queue<Event>().events; }
+
+	/**
+	*   Calls the handlers of every type that has events queued. The events stay queued.
+	*/
+	inline void dispatch()
+	{
+		forEachQueue([](auto& queue)
+		{
+			if (!queue.events.empty())
+			{
+				for (auto& handler : queue.handlers)
+				{
+					handler(queue.events);
+				}
+			}
+		});
+	}
+
+	/**
+	*   Drops every queued event, handlers are kept.
+	*/
+	inline void clear()
+	{
+		forEachQueue([](auto& queue) { queue.events.clear(); });
+	}
+
+	/**
+	*   Queues a copy of every event queued on another bus, after the events already queued.
+	*
+	*   @param other - The bus to copy from, its handlers are not copied.
+	*/
+	inline void append(const EventBus& other)
+	{
+		forEachQueue([&other](auto& queue)
+		{
+			using Event = typename std::decay_t<decltype(queue.events)>::value_type;
+			const std::vector<Event>& events = other.get<Event>();
+			queue.events.insert(queue.events.end(), events.begin(), events.end());
+		});
+	}
+
+	/**
+	*   Whether there are no events queued.
+	*
+	*   @return bool - true if every queue is empty.
+	*/
+	inline bool empty() const
+	{
+		bool anyEvents = false;
+		std::apply([&anyEvents](const auto&... queue) { ((anyEvents = anyEvents || !queue.events.empty()), ...); }, queues);
+		return !anyEvents;
+	}
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+
+/* 16.16 fixed point: an int32_t with 16 bits after the point, so 1.0 is 65536. Positions and
+   angles moved with it only go through integer adds, multiplies and shifts, which give the same
+   bits with every compiler, build and CPU. Float math doesn't promise that, a compiler may fuse
+   a multiply and an add, or keep x87 intermediates, and std::sin and std::cos differ between
+   standard libraries. Positions up to 32767, levels of 16383 tiles, fit.
+
+   Tiles are 2 wide, so the tile of a position is the position shifted right by TILE_SHIFT, with
+   the floor of negative positions included. Right shifts of negative numbers are arithmetic on
+   every compiler the game is built with, and by the standard since C++20. */
+
+class FixedPoint
+{
+public:
+
+	static const int FRACTION_BITS = 16;
+	static const int32_t ONE = 1 << FRACTION_BITS;
+	static const int TILE_SHIFT = FRACTION_BITS + 1;
+	static const int32_t FULL_TURN = 360 * ONE;	// angles are in degrees.
+
+	/**
+	*   The nearest fixed point number to a float, halfway rounds away from 0 like std::lround().
+	*	Used to bring settings and input into the fixed point world, it is exact on every machine:
+	*	the float times ONE and the part after the point are exact in double. Rounded by hand
+	*	because std::lround() is a library call, this is used in loops over every pellet.
+	*
+	*   @param value - The float.
+	*
+	*	@return int32_t - the fixed point number.
+	*/
+	static inline int32_t fromFloat(float value)
+	{
+		double scaled = static_cast<double>(value) * ONE;
+		int64_t whole = static_cast<int64_t>(scaled); // towards 0.
+		double rest = scaled - static_cast<double>(whole);
+		return static_cast<int32_t>(whole + (rest >= 0.5 ? 1 : rest <= -0.5 ? -1 : 0));
+	}
+
+	/**
+	*   The float nearest to a fixed point number, for drawing and for code that stays in float.
+	*
+	*   @param value - The fixed point number.
+	*
+	*	@return float - the float.
+	*/
+	static inline float toFloat(int32_t value)
+	{
+		return static_cast<float>(value) * (1.0f / ONE);
+	}
+
+	/**
+	*   Tile a position is in, the floor of position / 2.
+	*
+	*   @param position - X or Z of a position.
+	*
+	*	@return int - column or row of the tile.
+	*/
+	static inline int tile(int32_t position)
+	{
+		return position >> TILE_SHIFT;
+	}
+
+	/**
+	*   Product of two fixed point numbers, rounded down.
+	*
+	*   @param a - First factor.
+	*   @param b - Second factor.
+	*
+	*	@return int32_t - the product.
+	*/
+	static inline int32_t multiply(int32_t a, int32_t b)
+	{
+		return static_cast<int32_t>((static_cast<int64_t>(a) * b) >> FRACTION_BITS);
+	}
+
+	/**
+	*   An angle moved into [0, FULL_TURN).
+	*
+	*   @param degrees - The angle.
+	*
+	*	@return int32_t - the same angle, at least 0 and less than a full turn.
+	*/
+	static inline int32_t wrapDegrees(int32_t degrees)
+	{
+		int32_t wrapped = degrees % FULL_TURN;
+		return wrapped < 0 ? wrapped + FULL_TURN : wrapped;
+	}
+
+	static void sinCos(int32_t degrees, int32_t& sine, int32_t& cosine);
+};
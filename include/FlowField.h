@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "LevelGrid.h"
+
+enum GhostDirection : uint8_t { GHOST_NONE, GHOST_UP, GHOST_DOWN, GHOST_LEFT, GHOST_RIGHT };
+
+/* Distance in steps from every tile of a level to one target tile, found with a breadth first
+   search over the open tiles. Walking off the left or right edge comes out on the other side,
+   like the tunnel does. It is shared by every ghost of a game: the search runs once when the
+   player enters a new tile, after that each ghost finds its way with a look at its neighbours. */
+
+class FlowField
+{
+public:
+
+	static constexpr uint32_t UNREACHABLE = 0xffffffffu;
+
+private:
+
+	const LevelGrid* grid;				// kept alive by whoever owns the field.
+	int tilesX;
+	int tilesZ;
+	int targetTile;						// -1 until setTarget() is called.
+	unsigned long long searches;
+
+	std::vector<uint32_t> distances;
+
+	void search();
+	int neighbourX(int tileX, uint8_t direction) const;
+
+public:
+
+	FlowField(const LevelGrid& levelGrid);
+
+	bool setTarget(int tileX, int tileZ);
+	uint8_t bestDirection(int tileX, int tileZ) const;
+	uint32_t getDistance(int tileX, int tileZ) const;
+
+	inline unsigned long long getSearches() const { return searches; }
+};
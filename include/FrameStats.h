@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Frame time statistics. Every frame is added to fixed-size histograms for percentiles over the
+   whole session and to a ring of the most recent frames for rolling percentiles and the CSV log.
+   Adding frames and the rolling percentiles don't allocate after construction, only writing the
+   files does. */
+
+struct FrameSample
+{
+	float frameMs;		// wall time of the whole frame, including waiting for the swap.
+	float cpuMs;		// time spent on input, simulation and submitting draws, pipelined without the simulation.
+	float gpuMs;		// GPU time of the frame, a few frames late, 0 when not measured.
+	uint32_t ticks;		// simulation ticks run in the frame.
+	uint32_t drawCalls;
+};
+
+class FrameHistogram
+{
+public:
+
+	static const int BUCKETS = 5000;
+	static constexpr float BUCKET_MS = 0.02f; // 0 - 100 ms in 0.02 ms steps, slower frames go in the last bucket.
+
+private:
+
+	std::vector<uint32_t> counts;
+	unsigned long long total;
+	double sumMs;
+	float maxMs;
+
+public:
+
+	FrameHistogram();
+
+	void add(float ms);
+	float percentile(float p) const;
+
+	inline unsigned long long getCount() const { return total; }
+	inline float getMax() const { return maxMs; }
+	inline float getMean() const { return total > 0 ? static_cast<float>(sumMs / total) : 0.0f; }
+};
+
+class FrameStats
+{
+private:
+
+	float budgetMs;
+	std::string label;		// what was measured, e.g. which loop ran, written to the JSON.
+
+	FrameHistogram frameTimes;
+	FrameHistogram cpuTimes;
+	FrameHistogram gpuTimes;
+
+	std::vector<FrameSample> recent;	// ring of the last frames.
+	mutable std::vector<float> sorted;	// rollingPercentile() partly sorts the last frame times in here.
+	unsigned long long frameCount;
+
+	unsigned long long hitches;			// frames over the budget.
+	unsigned long long severeHitches;	// frames over twice the budget.
+	unsigned long long totalTicks;
+	unsigned long long totalDrawCalls;
+
+public:
+
+	FrameStats(float budgetMs = 1000.0f / 60.0f, size_t recentFrames = 1 << 16);
+
+	void addFrame(const FrameSample& sample);
+	float rollingPercentile(size_t frames, float p) const;
+	float rollingMax(size_t frames) const;
+
+	void printRolling(std::ostream& out, size_t frames) const;
+	bool writeCsv(const std::string& path) const;
+	bool writeJson(const std::string& path) const;
+
+	inline void setLabel(const std::string& text) { label = text; }
+	inline unsigned long long getFrameCount() const { return frameCount; }
+	inline unsigned long long getHitches() const { return hitches; }
+	inline const FrameHistogram& getFrameTimes() const { return frameTimes; }
+};
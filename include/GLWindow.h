@@ -1,9 +1,14 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
+#include <string>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include "InputState.h"
+#include "InputRecording.h"
+
 class GLWindow 
 {
 
@@ -13,27 +18,24 @@ private:
 	GLuint width, height;
 	GLint bufferWidth, bufferHeight;
 
-	bool keys[1024]; // ascii length
+	InputState input;
+
+	std::unique_ptr<InputRecorder> recorder;	// set while recording.
+	std::unique_ptr<InputReplay> replay;		// set while replaying, live input is ignored then.
+	uint32_t inputTick;							// tick that will consume the input arriving now.
 	
 	static void inputHandler(GLFWwindow* window, int key, int code, int action, int mode); // has to be static!
 	static void mouseHandler(GLFWwindow* window, double xPos, double yPos);
 
 	void callback();
 
-	GLfloat changeX;
-	GLfloat changeY;
-	GLfloat lastPosX;
-	GLfloat lastPosY;
-
-	bool initialPos;
-
 public:
 
 	GLWindow();
 	~GLWindow();
 	GLWindow(GLint wWidth, GLint wHeight);
 
-	bool* retrieveKeys() { return keys; } // don't have to pass window all the time.
+	bool* retrieveKeys() { return input.retrieveKeys(); } // don't have to pass window all the time.
 	bool shouldClose() { return glfwWindowShouldClose(mainWindow); }
 
 	GLfloat getChangeX();
@@ -43,7 +45,17 @@ public:
 
 	void swapBuffer() { return glfwSwapBuffers(mainWindow); }
 	void closeWindow();
-	void updateFPS();
+
+	bool startRecording(const std::string& path, uint64_t seed, uint32_t tickRate, uint32_t modes);
+	bool startReplay(const std::string& path);
+	bool isReplaying() { return replay != nullptr; }
+	uint64_t getReplaySeed() { return replay->getSeed(); }
+	uint32_t getReplayTickRate() { return replay->getTickRate(); }
+	uint32_t getReplayModes() { return replay->getModes(); }
+	std::vector<InputBand> getReplayBands() { return replay->getBands(); }
+
+	void beginTick(uint32_t tick);
+	void setInputTick(uint32_t tick);
 
 	inline GLfloat getBufferWidth() { return bufferWidth; }
 	inline GLfloat getBufferHeight() { return bufferHeight; }
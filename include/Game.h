@@ -13,10 +13,17 @@
 #include "LevelLoader.h"
 #include "GLWindow.h"
 #include "Map.h"
-#include "Pellets.h"
+#include "Simulation.h"
+#include "SimulationThread.h"
 #include "Camera.h"
-#include "Ghost.h"
+#include "DrawList.h"
+#include "GhostRenderer.h"
+#include "PelletRenderer.h"
+#include "MinimapPacman.h"
 #include "FrameBuffer.h"
+#include "GpuProfiler.h"
+#include "FrameStats.h"
+#include "Profiler.h"
 
 #include "Material.h"
 #include "Renderer.h"
@@ -32,16 +39,30 @@ private:
 
 	GLfloat deltaTime;
 	GLfloat lastTime;
-	GLfloat time;
 	GLfloat now;
 
+	GLfloat tickLength;		// seconds of game time simulated by one tick.
+	GLfloat accumulator;	// frame time not yet consumed by the simulation.
+	GLfloat interpolation;	// how far the renderer is between the last two ticks [0, 1).
+
 	int numberOfGhosts;
+	int ticksPerSecond;
+	bool pipelined;			// step the simulation on its own thread, see SimulationThread.
+	bool gameOver;			// set by the first game over event, later ones are ignored.
+	bool fixedPoint;		// move in fixed point, see Simulation::setFixedPoint().
+	uint64_t seed;
 
+	std::unique_ptr<JobSystem> jobSystem;
 	std::unique_ptr<Map> map;
-	std::unique_ptr<Pellets> pellets;
+	std::unique_ptr<Simulation> simulation;	// what is drawn, a copy of the snapshots when pipelined.
+	std::unique_ptr<SimulationThread> simulationThread;
+	EventBus events;		// events of the ticks since the last frame, dispatched once a frame.
 	std::unique_ptr<FrameBuffer> frameBuffer;
 
-	std::vector<std::unique_ptr<Ghost>> ghosts;
+	std::unique_ptr<GhostRenderer> ghostRenderer;
+	std::unique_ptr<DrawList> drawList;
+	std::unique_ptr<PelletRenderer> pelletRenderer;
+	std::unique_ptr<MinimapPacman> minimapPacman;
 
 	std::shared_ptr<Renderer> renderer;
 
@@ -95,25 +116,43 @@ private:
 	glm::mat4 model;
 	glm::mat4 projection;
 	glm::mat4 projectionMinimap;
+	glm::mat4 view;			// view matrices of the current frame, calculated once in renderGame().
+	glm::mat4 minimapView;
 
 	glm::vec3 map_pos;
 	glm::vec3 floor_pos;
 	glm::vec3 pellets_pos;
 	glm::vec3 startingPos;
 
-	std::vector<std::vector<int>> levelArrayData;
+	std::shared_ptr<const LevelGrid> levelGrid; // shared by the map and every simulation.
 
 	glm::vec3 lowerLight;
 
 public:
 
-	Game();
+	Game(int ticksPerSecond = 120);
 	~Game();
 
 	void generateGame(std::shared_ptr<GLWindow>& mainWindow);
 	void updateGame(std::shared_ptr<GLWindow>& mainWindow);
+	void updateSimulation(std::shared_ptr<GLWindow>& mainWindow);
+	void updatePipelined(std::shared_ptr<GLWindow>& mainWindow);
+	void updateFlashLight(std::shared_ptr<GLWindow>& mainWindow);
+	void subscribeEvents(std::shared_ptr<GLWindow>& mainWindow);
+	void dispatchEvents();
+	void renderGame();
 	void updateMinimap();
 
+	void setTickRate(int ticksPerSecond);
+	inline void setSeed(uint64_t gameSeed) { seed = gameSeed; }
+	inline uint64_t getSeed() { return seed; }
+	inline int getTickRate() { return ticksPerSecond; }
+	inline void setPipelined(bool threaded) { pipelined = threaded; }
+	inline bool isPipelined() { return pipelined; }
+	inline void setFixedPoint(bool fixed) { fixedPoint = fixed; }
+	inline bool isFixedPoint() { return fixedPoint; }
+	inline unsigned long long getSimulationTick() { return simulation->getTick(); }
+
 	void generateShaders();
 	void generateLights();
 	void generateMinimap(std::shared_ptr<GLWindow>& mainWindow);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+
+/* The inner loop of moving ghosts, run over flat arrays of many ghosts at once: every ghost is
+   moved one step in its direction, the tile it is in is found with the same offsets as
+   GhostStore::tileIndexX/Z(), ghosts past the left or right edge come out on the other side, and
+   the ghosts that entered a new tile are listed. Deciding where those go next is left to the
+   caller, it only has to look at the listed ghosts.
+
+   There is a scalar version, an SSE4.1 version for 4 ghosts at a time and an AVX2 version for 8.
+   They give exactly the same bits, all the products in the step are exact, so the choice never
+   changes a game. The best one the CPU has is picked at startup, setLevel() forces another.
+   advanceListed() moves ghosts picked from anywhere in the arrays, one at a time.
+
+   advanceFixed() is the same step on 16.16 fixed point positions, see FixedPoint.h: only integer
+   adds, compares and shifts, which give the same bits on any compiler and CPU. It only writes
+   16.16 positions, whoever reads them as floats converts them when it needs them. */
+
+struct GhostLanes
+{
+	float* x;
+	float* z;
+	float* previousX;			// gets the position before the step, nullptr if it isn't kept.
+	float* previousZ;
+	const uint8_t* directions;	// GhostDirection of every ghost.
+	int* tileX;					// tile of the last decision, gets the tile the ghost is in now.
+	int* tileZ;
+};
+
+struct GhostStep
+{
+	float distance;		// how far a ghost moves, speed times the length of the tick.
+	float wrapBelow;	// x under this comes out at wrapBelowTo.
+	float wrapAbove;	// x over this comes out at wrapAboveTo.
+	float wrapBelowTo;
+	float wrapAboveTo;
+};
+
+struct FixedLanes
+{
+	int32_t* x;					// 16.16 positions.
+	int32_t* z;
+	int32_t* previousX;			// gets the position before the step, nullptr if it isn't kept.
+	int32_t* previousZ;
+	const uint8_t* directions;
+	int* tileX;
+	int* tileZ;
+};
+
+struct FixedStep
+{
+	int32_t distance;	// all in 16.16, like GhostStep.
+	int32_t wrapBelow;
+	int32_t wrapAbove;
+	int32_t wrapBelowTo;
+	int32_t wrapAboveTo;
+};
+
+class GhostKernel
+{
+public:
+
+	enum Level : uint8_t { SCALAR, SSE41, AVX2 };
+
+	static const int32_t FIXED_CORNER = 58982;	// 0.9 in 16.16, how far past its edge a ghost decides in a tile.
+
+private:
+
+	static int advanceScalar(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered);
+	static int advanceSse41(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered);
+	static int advanceAvx2(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered);
+	static int advanceFixedScalar(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered);
+	static int advanceFixedSse41(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered);
+	static int advanceFixedAvx2(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered);
+
+public:
+
+	static Level detect();
+	static bool setLevel(Level level);
+	static Level getLevel();
+	static const char* getName(Level level);
+
+	static int advance(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered);
+	static int advanceListed(const GhostLanes& lanes, const int* ghosts, const float* distances, int count, const GhostStep& step, int* entered);
+	static int advanceFixed(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered);
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "DrawList.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "Shader.h"
+
+/* Draws ghosts. One model is loaded and shared by every ghost in the game, the ghosts to draw
+   and their matrices come from a DrawList. */
+
+class GhostRenderer
+{
+private:
+
+	std::unique_ptr<Model> ghostModel;
+
+	GLuint uniformModel;
+	GLuint uniformView;
+	GLuint uniformProjection;
+
+public:
+
+	GhostRenderer();
+	~GhostRenderer();
+
+	void draw(const DrawList& drawList, uint8_t pass, std::shared_ptr<Shader>& shader, const glm::mat4& view, const glm::mat4& projection);
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "CounterRandom.h"
+#include "FixedPoint.h"
+#include "FlowField.h"
+#include "GhostKernel.h"
+#include "JunctionGraph.h"
+#include "LevelGrid.h"
+#include "PathPlanner.h"
+#include "Profiler.h"
+#include "StateBuffer.h"
+
+/* All the ghosts of one game, stored as components: one flat array per field instead of one
+   object per ghost. The level is stored once for every ghost, a ghost is just an index. The
+   systems (move, catches, interpolate) loop over a range of indices, so thousands of ghosts are
+   a few linear passes over memory, and ranges can be given to different jobs.
+
+   Every ghost draws its random numbers from stream "index" of the game seed, so a ghost behaves
+   the same however many ghosts there are and however they are split. Ghosts only choose a way at
+   the junctions and dead ends of a JunctionGraph, those that chase the player read a FlowField.
+   Both are shared by all of them.
+
+   Positions are kept as separate x and z arrays, ghosts never leave the floor, so GhostKernel
+   can move them several at a time. Only the ghosts it reports in a new tile run their AI.
+
+   With a PathPlanner the flow field isn't searched at all. A ghost leaving a junction decides
+   right away whether it will chase at the next one, and if so asks the planner for a path from
+   that junction to the player. The answer comes in a tick later, long before the ghost gets
+   there.
+
+   With setScheduled() the ghosts aren't moved every tick at all. A ghost goes in a straight line
+   at the same speed as every other ghost until the next tile where it may turn, so its position
+   is where it was when it last turned plus how far all ghosts have moved since. Each ghost is
+   put in a timing wheel at the distance it reaches its next such tile, and a tick only runs the
+   ghosts that are due. The ghosts are also kept in buckets of BLOCK_TILES x BLOCK_TILES tiles,
+   entering another block is an event too, so catching the player only has to look at the ghosts
+   near it. A tick then costs as much as the ghosts that decide in it, not as all the ghosts.
+   Positions are worked out in double instead of adding up a float step every tick, so a
+   scheduled game plays out differently from one that isn't, like with a planner.
+
+   setDetailBands() moves ghosts far from the player less often instead: a ghost in a band is
+   moved every interval ticks, the distance of all the ticks in one step, and put in the band of
+   where it then is. The ghosts of a band are spread over its interval, so a tick only moves the
+   ghosts near the player and a share of the others. Only the ghosts near the player are checked
+   for catching it, moved and checked every tick like without bands. No ghost of a slower band
+   can have come close enough to catch the player before it is moved again: the player and the
+   ghosts are only so fast, and when the player moved further than a band allows, e.g. through
+   the tunnel, every ghost is moved and put in its band again.
+
+   setFixedPoint() moves the ghosts on 16.16 positions with GhostKernel::advanceFixed() and
+   checks catching the player in integers, so a game plays out the same bits on every machine.
+   Only the 16.16 positions are moved, getPosition() and interpolate() convert them to floats
+   for the ghosts that are looked at. Scheduling and bands are worked out in float, so fixed
+   point turns them off and either of them turns fixed point off. */
+
+struct DetailBand
+{
+	int tiles;		// ghosts at least this many tiles from the player's tile, in X or in Z,
+	int interval;	// are moved every this many ticks.
+};
+
+class GhostStore
+{
+private:
+
+	/* -- Shared by every ghost, read-only after construction -- */
+
+	int tilesX;
+	int tilesZ;
+	uint64_t seed;
+	std::shared_ptr<const LevelGrid> grid;	// the level, shared with the rest of the game.
+	std::vector<glm::vec3> spawnPositions;	// tiles ghosts may spawn on.
+	FlowField flowField;					// distances to the player's tile, see track().
+	JunctionGraph graph;
+	float wrapAbove;						// ghosts with an x over this teleport to the other side.
+	PathPlanner* planner;					// not owned, null chases with the flow field.
+	int targetTile;							// the player's tile, where planned paths lead.
+
+	/* -- Event scheduling, see setScheduled() -- */
+
+	bool scheduled;
+	double travelled;						// how far every ghost has moved since scheduling started.
+	double lastTravelled;					// travelled at the start of the last tick.
+	long long drainedSlot;					// the wheel slots before this one are empty.
+	std::vector<std::vector<std::pair<double, int>>> wheel;	// events as (travelled when due, ghost), by slot.
+	std::vector<int> dueGhosts;				// scratch space of advanceScheduled() and moveDetailed().
+	int blocksX;
+	int blocksZ;
+	std::vector<std::vector<int>> blockGhosts;	// ghosts by the block of their decision tile.
+
+	/* -- Level of detail, see setDetailBands() -- */
+
+	std::vector<DetailBand> detailBands;	// sorted by tiles, empty moves every ghost every tick.
+	std::vector<std::vector<std::vector<int>>> bandSlots;	// ghosts of band b due in tick t are in bandSlots[b][t % interval], band 0 is every tick.
+	glm::vec3 playerPosition;				// from track().
+	glm::vec3 detailPlayer;					// the player at the end of the last tick with bands.
+	unsigned long long detailTick;			// ticks moved with bands.
+	std::vector<float> detailSteps;			// distance a ghost moved in each of the last ticks, by tick % DETAIL_TICKS.
+	std::vector<float> detailClosing;		// how much closer a ghost and the player could get in each of the last ticks.
+	uint8_t detailReset;					// 1 moves every ghost in the next tick and puts it in its band.
+
+	/* -- Fixed point, see setFixedPoint() -- */
+
+	bool fixedPoint;
+	FixedStep fixedEdges;					// the tunnel edges, the distance is set every tick.
+
+	/* -- Per ghost -- */
+
+	std::vector<float> positionX;
+	std::vector<float> positionZ;
+	std::vector<float> previousX;				// position at the start of the last tick.
+	std::vector<float> previousZ;
+	std::vector<glm::vec3> renderPositions;		// position between the last two ticks that gets drawn.
+	std::vector<uint8_t> directions;
+	std::vector<int> decisionTileX;				// tile the ghost last made a decision in.
+	std::vector<int> decisionTileZ;
+	std::vector<uint64_t> randomCounters;		// position in the ghost's CounterRandom stream.
+	std::vector<int> planTiles;					// junction the planned step is for, -1 for none.
+	std::vector<uint8_t> planDirections;		// the planned step, PLAN_PENDING until the planner answers.
+	std::vector<double> segmentStarts;			// scheduled: travelled when the ghost was at positionX/Z.
+	std::vector<double> eventDistances;			// scheduled: travelled when the next event is due.
+	std::vector<int> ghostBlocks;				// scheduled: block the ghost is in, -1 for none.
+	std::vector<int> blockSlots;				// scheduled: index of the ghost in blockGhosts.
+	std::vector<uint8_t> ghostBands;			// bands: the ghost's band, 0 is the one moved every tick.
+	std::vector<unsigned long long> lastSteps;	// bands: detailTick the ghost was last moved in.
+	std::vector<int32_t> fixedX;				// fixed point: the position in 16.16.
+	std::vector<int32_t> fixedZ;
+	std::vector<int32_t> fixedPreviousX;		// fixed point: the position at the start of the last tick.
+	std::vector<int32_t> fixedPreviousZ;
+
+	int tileIndexX(int ghost) const;
+	int tileIndexZ(int ghost) const;
+	int randomNumber(int ghost, int highestRandomNumber);
+	uint8_t randomOpenDirection(int ghost, uint8_t cell);
+	void calculateAiDirection(int ghost, int tileX, int tileZ, uint8_t cell);
+	uint8_t takePlan(int ghost, int tile);
+	void planNextNode(int ghost, int tileX, int tileZ);
+	void requestPlan(int ghost, int tileX, int tileZ);
+	void enterTile(int ghost, int tileX, int tileZ);
+	glm::vec3 positionAt(int ghost, double distance) const;
+	void runEvent(int ghost);
+	void scheduleNext(int ghost);
+	void placeInBlock(int ghost, int tileX, int tileZ);
+	void rebuildSchedule();
+	void moveDue();
+	void rebuildBands();
+	void placeInBand(int ghost, int band);
+	void syncFixed();
+
+public:
+
+	static constexpr float HEIGHT = 0.5f; // y of every ghost.
+	static constexpr float CATCH_DISTANCE = 1.65f; // a ghost closer than this to the player catches it.
+	static const int32_t FIXED_CATCH_DISTANCE = 108134;	// CATCH_DISTANCE in 16.16.
+	static const uint8_t PLAN_PENDING = 0xff;
+	static const int BLOCK_TILES = 8;				// tiles along each side of a block of scheduled ghosts.
+	static constexpr double SLOT_DISTANCE = 1.0 / 16;	// distance a slot of the timing wheel covers.
+	static const int WHEEL_SLOTS = 512;				// more than the farthest ahead an event can be, about 2 * (BLOCK_TILES + 2) / SLOT_DISTANCE.
+	static constexpr int MAX_DETAIL_INTERVAL = 16;		// a ghost moves less than half a tile in this many of the longest ticks.
+	static const int DETAIL_TICKS = 32;				// ticks of detailSteps kept, more than MAX_DETAIL_INTERVAL.
+
+	GhostStore(std::shared_ptr<const LevelGrid> levelGrid, int numberOfGhosts, uint64_t seed);
+
+	GhostStore(const GhostStore&) = delete;
+	GhostStore& operator=(const GhostStore&) = delete;
+
+	void track(glm::vec3 pacmanPosition);
+	void move(int begin, int end, float dt);
+	int catches(int begin, int end, glm::vec3 playerPosition) const;
+	void interpolate(float alpha);
+	void setPose(int ghost, glm::vec3 position, glm::vec3 previousPosition, uint8_t direction);
+
+	void setScheduled(bool enabled);
+	int advanceScheduled(float dt);
+	int catchesNear(glm::vec3 playerPosition) const;
+
+	void setDetailBands(std::vector<DetailBand> bands);
+	int moveDetailed(float dt);
+	int catchesDetailed(glm::vec3 playerPosition) const;
+
+	void setFixedPoint(bool enabled);
+	int catchesFixed(int begin, int end, int32_t playerX, int32_t playerZ) const;
+
+	void setPlanner(PathPlanner* pathPlanner);
+	void applyPlans(const std::vector<PathResult>& results);
+	void requestPendingPlans();
+
+	void saveState(StateWriter& writer) const;
+	bool restoreState(StateReader& reader);
+
+	static glm::vec3 directionVector(uint8_t direction);
+	static float wrapEdge(int tilesX);
+
+	static inline bool closeEnough(float x, float z, glm::vec3 playerPosition) // a ghost at x, z catches the player.
+	{
+		double dx = playerPosition.x - x;
+		double dz = playerPosition.z - z;
+		return static_cast<float>(std::sqrt(dx * dx + dz * dz)) < CATCH_DISTANCE;
+	}
+
+	inline int size() const { return static_cast<int>(positionX.size()); }
+	inline bool isScheduled() const { return scheduled; }
+	inline bool hasDetailBands() const { return !detailBands.empty(); }
+	inline bool isFixedPoint() const { return fixedPoint; }
+	inline const std::vector<DetailBand>& getDetailBands() const { return detailBands; }
+
+	inline glm::vec3 getPosition(int ghost) const
+	{
+		if (fixedPoint)
+		{
+			return glm::vec3(FixedPoint::toFloat(fixedX[ghost]), HEIGHT, FixedPoint::toFloat(fixedZ[ghost]));
+		}
+		return scheduled ? positionAt(ghost, travelled) : glm::vec3(positionX[ghost], HEIGHT, positionZ[ghost]);
+	}
+	inline glm::vec3 getPreviousPosition(int ghost) const // a scheduled ghost that turned this tick keeps it in previousX/Z.
+	{
+		if (fixedPoint)
+		{
+			return glm::vec3(FixedPoint::toFloat(fixedPreviousX[ghost]), HEIGHT, FixedPoint::toFloat(fixedPreviousZ[ghost]));
+		}
+		if (scheduled)
+		{
+			return segmentStarts[ghost] < travelled ? positionAt(ghost, lastTravelled) : glm::vec3(previousX[ghost], HEIGHT, previousZ[ghost]);
+		}
+		if (!detailBands.empty() && lastSteps[ghost] != detailTick) // not moved in the last tick.
+		{
+			return getPosition(ghost);
+		}
+		return glm::vec3(previousX[ghost], HEIGHT, previousZ[ghost]);
+	}
+	inline glm::vec3 getRenderPosition(int ghost) const { return renderPositions[ghost]; }
+	inline uint8_t getDirection(int ghost) const { return directions[ghost]; }
+	inline glm::vec3 getVelocity(int ghost) const { return directionVector(directions[ghost]); }
+	inline const FlowField& getFlowField() const { return flowField; }
+	inline const JunctionGraph& getGraph() const { return graph; }
+	inline const LevelGrid& getGrid() const { return *grid; }
+};
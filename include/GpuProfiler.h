@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Profiler.h"
+
+/* GPU timings of render passes. GPU_PROFILE_SCOPE("name") puts a GL_TIMESTAMP query at the start
+   and end of the enclosing block, scopes may nest. Queries of a frame are read back FRAMES_IN_FLIGHT
+   frames later, when the GPU is long done with them, so reading them never stalls the pipeline.
+   Results go to a "GPU" track in the Profiler trace and to per-pass averages. */
+
+#ifdef PACMAN_PROFILE
+#define GPU_PROFILE_SCOPE(name) GpuScope PROFILE_CONCAT(gpuScope, __LINE__)(name)
+#else
+#define GPU_PROFILE_SCOPE(name)
+#endif
+
+class GpuProfiler
+{
+private:
+
+	static const int FRAMES_IN_FLIGHT = 4;
+	static const int MAX_PASSES = 32; // per frame, passes beyond this are not timed.
+
+	struct Frame
+	{
+		GLuint queries[MAX_PASSES * 2];	// start and end timestamp of every pass.
+		const char* names[MAX_PASSES];
+		int passCount;
+		int64_t clockOffset;			// profiler time minus GPU time when the frame started.
+		bool pending;					// queries issued but not read back yet.
+	};
+
+	struct PassStats
+	{
+		const char* name;
+		double lastMs;
+		double totalMs;
+		unsigned long long frames;
+	};
+
+	static Frame frames[FRAMES_IN_FLIGHT];
+	static int frameIndex;
+	static bool active;
+	static int framePass;
+
+	static ProfileBuffer* lane;
+	static std::vector<PassStats> stats;
+	static double lastFrameMs;
+	static unsigned long long droppedFrames;
+
+	static void collect(Frame& frame);
+	static void addStats(const char* name, double ms);
+
+public:
+
+	static void initialise();
+	static void shutdown();
+	static inline bool isActive() { return active; }
+
+	static void beginFrame();
+	static void endFrame();
+	static int beginPass(const char* name);
+	static void endPass(int pass);
+
+	static inline double getLastFrameTime() { return lastFrameMs; }
+	static void writeSummary(std::ostream& out);
+};
+
+class GpuScope
+{
+private:
+
+	int pass;
+
+public:
+
+	explicit GpuScope(const char* name) : pass(GpuProfiler::isActive() ? GpuProfiler::beginPass(name) : -1) {}
+	~GpuScope() { GpuProfiler::endPass(pass); }
+
+	GpuScope(const GpuScope&) = delete;
+	GpuScope& operator=(const GpuScope&) = delete;
+};
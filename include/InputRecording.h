@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "InputState.h"
+
+/* Binary recordings of a play session. The file is a fixed header followed by fixed size events,
+   appended in tick order and never rewritten, so a crashed session still leaves a valid file and
+   the whole thing can be mapped into memory and read in place:
+
+	   InputFileHeader | InputEvent | InputEvent | ...
+
+   Events are stamped with the simulation tick that consumes them. Replaying them before the same
+   ticks, with the same seed, tick rate and modes, plays the same game. The modes are the settings
+   of the Simulation that change how a game plays out: path planning, event scheduling, the
+   distance bands and fixed point. */
+
+const uint32_t INPUT_FILE_MAGIC = 0x52494d50; // "PMIR" in little endian.
+const uint32_t INPUT_FILE_VERSION = 2;
+const uint32_t INPUT_MAX_BANDS = 8;
+
+enum InputEventType : uint8_t { INPUT_EVENT_KEY = 1, INPUT_EVENT_MOUSE = 2 };
+
+enum InputMode : uint32_t { INPUT_MODE_PLAN = 1, INPUT_MODE_EVENTS = 2, INPUT_MODE_FIXED = 4 }; // Pacman3D only records FIXED.
+
+struct InputBand
+{
+	int32_t tiles;		// DetailBand of the session, see GhostStore::setDetailBands().
+	int32_t interval;
+};
+
+struct InputFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t seed;		// Simulation seed of the session.
+	uint32_t tickRate;	// ticks per second of the session.
+	uint32_t eventSize;	// sizeof(InputEvent), guards against reading a file from another layout.
+	uint32_t modes;		// InputMode flags of the session.
+	uint32_t bandCount;	// distance bands of the session, the rest of bands is 0.
+	InputBand bands[INPUT_MAX_BANDS];
+};
+
+struct InputEvent
+{
+	uint32_t tick;
+	uint8_t type;	// InputEventType
+	uint8_t action;	// INPUT_PRESS, INPUT_RELEASE or INPUT_REPEAT for key events.
+	int16_t key;
+	double xPos;	// raw cursor position for mouse events.
+	double yPos;
+};
+
+static_assert(sizeof(InputFileHeader) == 96, "InputFileHeader layout is part of the file format");
+static_assert(sizeof(InputEvent) == 24, "InputEvent layout is part of the file format");
+
+class InputRecorder
+{
+private:
+
+	std::ofstream file;
+	std::vector<InputEvent> pending; // events of the current frame, written in one go by flush().
+
+public:
+
+	InputRecorder();
+	~InputRecorder();
+
+	bool open(const std::string& path, uint64_t seed, uint32_t tickRate, uint32_t modes, const std::vector<InputBand>& bands);
+
+	void recordKey(uint32_t tick, int key, int action);
+	void recordMouse(uint32_t tick, double xPos, double yPos);
+	void flush();
+};
+
+class InputReplay
+{
+private:
+
+	const unsigned char* data;
+	size_t size;
+
+	std::vector<unsigned char> buffer; // used where the file can't be mapped.
+	void* mapping;
+
+	InputFileHeader header;
+	const InputEvent* events;
+	size_t eventCount;
+	size_t nextEvent;
+
+	void close();
+
+public:
+
+	InputReplay();
+	~InputReplay();
+
+	bool open(const std::string& path);
+
+	void applyTick(uint32_t tick, InputState& input);
+	bool finished() const { return nextEvent >= eventCount; }
+
+	inline uint64_t getSeed() const { return header.seed; }
+	inline uint32_t getTickRate() const { return header.tickRate; }
+	inline uint32_t getModes() const { return header.modes; }
+	inline std::vector<InputBand> getBands() const { return std::vector<InputBand>(header.bands, header.bands + header.bandCount); }
+	inline size_t getEventCount() const { return eventCount; }
+	inline const InputEvent& getEvent(size_t index) const { return events[index]; }
+};
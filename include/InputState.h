@@ -0,0 +1,35 @@
+#pragma once
+
+/* Keyboard and mouse state the game reads every tick. GLWindow feeds it from GLFW, a replay feeds
+   it from a recording, both through handleKey() and handleMouse() so the result is the same. */
+
+// same values as GLFW_RELEASE, GLFW_PRESS and GLFW_REPEAT.
+const int INPUT_RELEASE = 0;
+const int INPUT_PRESS = 1;
+const int INPUT_REPEAT = 2;
+
+class InputState
+{
+private:
+
+	bool keys[1024]; // ascii length
+
+	float changeX;
+	float changeY;
+	float lastPosX;
+	float lastPosY;
+
+	bool initialPos;
+
+public:
+
+	InputState();
+
+	void handleKey(int key, int action);
+	void handleMouse(double xPos, double yPos);
+
+	bool* retrieveKeys() { return keys; }
+
+	float getChangeX();
+	float getChangeY();
+};
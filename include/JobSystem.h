@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Profiler.h"
+
+/* Work-stealing job system. Every worker has its own queue, it takes new work from the back of it
+   and steals from the front of the others when it runs dry. Jobs may depend on other jobs, a job
+   is only queued once everything it depends on has finished, which makes it easy to build a
+   graph: decode textures -> upload, or move ghosts + check pellets -> resolve collisions.
+
+   Threads that wait for a job help running jobs instead of blocking. */
+
+class JobSystem;
+
+class Job
+{
+private:
+
+	friend class JobSystem;
+
+	std::function<void()> function;
+	std::atomic<int> unfinishedDependencies;
+	std::atomic<bool> finished;
+
+	std::mutex continuationsMutex;
+	std::vector<std::shared_ptr<Job>> continuations; // jobs waiting for this one.
+
+public:
+
+	Job(std::function<void()> function) : function(std::move(function)), unfinishedDependencies(1), finished(false) {}
+
+	inline bool isFinished() const { return finished.load(std::memory_order_acquire); }
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+class JobSystem
+{
+private:
+
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<JobHandle> jobs;
+	};
+
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<WorkerQueue>> queues; // one per worker, the last one is for threads outside the system.
+
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+	std::atomic<int> queuedJobs;
+	std::atomic<bool> stopping;
+
+	void workerLoop(int workerIndex);
+	void enqueue(const JobHandle& job);
+	JobHandle findJob(int queueIndex);
+	void runJob(const JobHandle& job);
+	int currentQueue() const;
+
+public:
+
+	JobSystem(int numberOfThreads = 0);
+	~JobSystem();
+
+	JobHandle submit(std::function<void()> function, std::initializer_list<JobHandle> dependencies = {});
+	JobHandle submit(std::function<void()> function, const std::vector<JobHandle>& dependencies);
+	void wait(const JobHandle& job);
+	void wait(const std::vector<JobHandle>& jobs);
+
+	void parallelFor(int count, const std::function<void(int, int)>& function, int jobsPerThread = 4);
+
+	inline int getNumberOfThreads() const { return static_cast<int>(workers.size()) + 1; }
+};
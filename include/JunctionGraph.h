@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "FlowField.h"
+#include "LevelGrid.h"
+
+/* The level as a graph: junctions and dead ends are the nodes, the corridors between them are the
+   edges, with their length and the tiles they run through. Ghosts only have a choice at a node,
+   everywhere else they follow the corridor, so the per tile work of moving is one table lookup.
+
+   Every tile gets a cell byte: one bit per open neighbour (tunnel wrap included) and a bit that
+   marks the nodes. Tiles on a loop without any junction belong to no edge. */
+
+struct JunctionNode
+{
+	int tile;		// row major index of the tile.
+	int edges[4];	// edge leaving up, down, left and right, -1 where there is a wall.
+};
+
+struct JunctionEdge
+{
+	int from;				// node at the start of the run.
+	int to;					// node at the end, can be the same node for a loop.
+	uint8_t fromDirection;	// GhostDirection leaving from.
+	uint8_t toDirection;	// GhostDirection leaving to, back into the corridor.
+	int length;				// steps from node to node.
+	int runBegin;			// tiles between the nodes in getRun(), in order from "from" to "to".
+	int runEnd;
+};
+
+class JunctionGraph
+{
+public:
+
+	static const uint8_t NODE = 0x10; // cell bit of junctions and dead ends.
+
+	/**
+	*   Cell bit of an open neighbour.
+	*
+	*   @param direction - A GhostDirection.
+	*
+	*   @return uint8_t - the bit, 0 for GHOST_NONE.
+	*/
+	static inline uint8_t openBit(uint8_t direction) { return direction == GHOST_NONE ? 0 : static_cast<uint8_t>(1u << (direction - 1)); }
+
+	/**
+	*   The first direction that has its bit set, in the order up, down, left, right.
+	*
+	*   @param bits - openBit() values.
+	*
+	*   @return uint8_t - a GhostDirection, GHOST_NONE if no bit is set.
+	*/
+	static inline uint8_t firstDirection(uint8_t bits)
+	{
+		for (uint8_t direction = GHOST_UP; direction <= GHOST_RIGHT; direction++)
+		{
+			if (bits & openBit(direction))
+			{
+				return direction;
+			}
+		}
+		return GHOST_NONE;
+	}
+
+	/**
+	*   The way back.
+	*
+	*   @param direction - A GhostDirection.
+	*
+	*   @return uint8_t - the opposite GhostDirection, GHOST_NONE stays GHOST_NONE.
+	*/
+	static inline uint8_t reverse(uint8_t direction)
+	{
+		static const uint8_t opposite[] = { GHOST_NONE, GHOST_DOWN, GHOST_UP, GHOST_RIGHT, GHOST_LEFT };
+		return opposite[direction];
+	}
+
+private:
+
+	int tilesX;
+	int tilesZ;
+
+	std::vector<uint8_t> cells;
+	std::vector<JunctionNode> nodes;	// sorted by tile.
+	std::vector<JunctionEdge> edges;
+	std::vector<int> runs;
+
+	int neighbour(int tile, uint8_t direction) const;
+	void walkCorridor(int node, uint8_t direction);
+
+public:
+
+	JunctionGraph(const LevelGrid& grid);
+
+	int findNode(int tileX, int tileZ) const;
+
+	/**
+	*   Open neighbours of a tile and whether it is a node.
+	*
+	*   @param tileX - Column.
+	*   @param tileZ - Row.
+	*
+	*   @return uint8_t - openBit() of every open neighbour, plus NODE. 0 for walls and outside the level.
+	*/
+	inline uint8_t cell(int tileX, int tileZ) const
+	{
+		if (tileX < 0 || tileZ < 0 || tileX >= tilesX || tileZ >= tilesZ)
+		{
+			return 0;
+		}
+		return cells[static_cast<size_t>(tileZ) * tilesX + tileX];
+	}
+
+	inline const std::vector<JunctionNode>& getNodes() const { return nodes; }
+	inline const std::vector<JunctionEdge>& getEdges() const { return edges; }
+	inline const int* getRun(const JunctionEdge& edge) const { return runs.data() + edge.runBegin; }
+	inline int getTilesX() const { return tilesX; }
+	inline int getTilesZ() const { return tilesZ; }
+};
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* The level every system plays on, built once when it is loaded and never changed after that, so
+   one grid is shared by the map, the player, the ghosts and the pellets of any number of games
+   through a std::shared_ptr<const LevelGrid>. It holds the tiles as they are in the level file,
+   1 byte each in one flat array, and a copy of the walls packed into bits for the movement and
+   collision code.
+
+   In the bitboard a bit is set for walls. Every row has a guard bit on
+   both sides that holds the tile on the other edge, so left of the first and right of the last
+   column read the tile the tunnel leads to. There is also a padding row of walls above and below
+   the level. Reading two bytes then gives a tile together with its left and right neighbour, and
+   openNeighbours() tests all four directions with six byte reads and a few shifts. There are no
+   branches and no bounds checks.
+
+   The ROWS layout stores a row as consecutive bytes. The BLOCKS layout keeps blocks of 8x8 tiles in
+   8 consecutive bytes instead, one byte per row of the block. The tiles above and below are then
+   mostly in the same cache line, which helps vertical steps on huge maps. Both layouts give the
+   same answers, the bits are in the same order within a byte. */
+
+class LevelGrid
+{
+public:
+
+	enum Layout : uint8_t { ROWS, BLOCKS };
+
+	// tile values, the same as in the level file.
+	static const uint8_t OPEN = 0;
+	static const uint8_t WALL = 1;
+	static const uint8_t START = 2;
+
+	// bits of openNeighbours(), the same as JunctionGraph::openBit() of the GhostDirections.
+	static const uint8_t OPEN_UP = 1;
+	static const uint8_t OPEN_DOWN = 2;
+	static const uint8_t OPEN_LEFT = 4;
+	static const uint8_t OPEN_RIGHT = 8;
+
+private:
+
+	int tilesX;
+	int tilesZ;
+	Layout layout;
+	int startTile;				// first tile marked START, -1 if there is none.
+
+	std::vector<uint8_t> tiles;	// row major.
+
+	// bit b of row z (b = column + 1, because of the guard) is bit b & 7 of byte
+	// ((z >> zShift) + 1) * rowStride + (z & zMask) + (b >> 3) * groupStride. The + 1 skips the
+	// padding row.
+	int zShift;
+	int zMask;
+	size_t rowStride;
+	size_t groupStride;
+
+	std::vector<uint8_t> bits;
+
+	size_t byteIndex(int bit, int tileZ) const;
+
+	/**
+	*   The walls at and around a tile in one row.
+	*
+	*   @param tileX - Column, 0 to tilesX - 1.
+	*   @param tileZ - Row, -1 to tilesZ.
+	*
+	*   @return unsigned - bit 0 is the tile to the left, bit 1 the tile, bit 2 the tile to the right.
+	*/
+	inline unsigned window(int tileX, int tileZ) const
+	{
+		size_t group = static_cast<size_t>((tileZ >> zShift) + 1) * rowStride + (tileZ & zMask) + (tileX >> 3) * groupStride;
+		unsigned pair = bits[group] | static_cast<unsigned>(bits[group + groupStride]) << 8;
+		return pair >> (tileX & 7);
+	}
+
+public:
+
+	LevelGrid(const std::vector<std::vector<int>>& levelArray, Layout layout = ROWS);
+
+	/**
+	*   Whether a tile is a wall. Rows -1 and tilesZ, just outside the level, are walls.
+	*
+	*   @param tileX - Column, 0 to tilesX - 1.
+	*   @param tileZ - Row, -1 to tilesZ.
+	*
+	*   @return bool - true for walls.
+	*/
+	inline bool isWall(int tileX, int tileZ) const { return (window(tileX, tileZ) & 2u) != 0; }
+
+	/**
+	*   The open tiles next to a tile. Left of the first column is the last column and right of
+	*	the last column is the first, like the tunnel. Above the first and below the last row are
+	*	walls.
+	*
+	*   @param tileX - Column, 0 to tilesX - 1.
+	*   @param tileZ - Row, 0 to tilesZ - 1.
+	*
+	*   @return uint8_t - OPEN_UP, OPEN_DOWN, OPEN_LEFT and OPEN_RIGHT of the open neighbours.
+	*/
+	inline uint8_t openNeighbours(int tileX, int tileZ) const
+	{
+		unsigned row = window(tileX, tileZ);
+		unsigned walls = ((window(tileX, tileZ - 1) >> 1) & 1u) | (window(tileX, tileZ + 1) & 2u)
+			| (row & 1u) << 2 | (row & 4u) << 1;
+		return static_cast<uint8_t>(~walls & 0xfu);
+	}
+
+	/**
+	*   Whether a tile is inside the level.
+	*
+	*   @param tileX - Column.
+	*   @param tileZ - Row.
+	*
+	*   @return bool - true if it is.
+	*/
+	inline bool contains(int tileX, int tileZ) const
+	{
+		return static_cast<unsigned>(tileX) < static_cast<unsigned>(tilesX) && static_cast<unsigned>(tileZ) < static_cast<unsigned>(tilesZ);
+	}
+
+	/**
+	*   The value of a tile.
+	*
+	*   @param tileX - Column, 0 to tilesX - 1.
+	*   @param tileZ - Row, 0 to tilesZ - 1.
+	*
+	*   @return uint8_t - OPEN, WALL or START.
+	*/
+	inline uint8_t tile(int tileX, int tileZ) const { return tiles[static_cast<size_t>(tileZ) * tilesX + tileX]; }
+
+	inline const uint8_t* getTiles() const { return tiles.data(); }
+	inline int getTilesX() const { return tilesX; }
+	inline int getTilesZ() const { return tilesZ; }
+	inline int getStartTile() const { return startTile; }
+	inline Layout getLayout() const { return layout; }
+	inline size_t getWallBytes() const { return bits.size(); }
+	inline size_t getBytes() const { return tiles.size() + bits.size(); }
+};
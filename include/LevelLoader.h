@@ -2,9 +2,12 @@
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
 
+#include "LevelGrid.h"
+
 class LevelLoader 
 {
 private:
@@ -13,13 +16,15 @@ private:
 	int tilesY;
 
 	std::vector<std::vector<int>> levelArray;
+	std::shared_ptr<const LevelGrid> grid;
 
 public:
 
 	LevelLoader();
 
 	void loadLevel(std::string levelPath);
-	std::vector<std::vector<int>> getLevel();
+	const std::vector<std::vector<int>>& getLevel();
+	std::shared_ptr<const LevelGrid> getGrid();
 
 	int getTilesX();
 	int getTilesY();
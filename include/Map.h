@@ -2,12 +2,15 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "LevelGrid.h"
 #include "LevelLoader.h"
 #include "GLWindow.h"
 #include "Material.h"
 #include "Shader.h"
 #include "Camera.h"
 #include "Renderer.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
 
 /*Objects that make up the map - Floor, walls*/
 
@@ -38,7 +41,7 @@ private:
 	std::vector <unsigned int> wallIndices;
 	std::vector<GLuint> indices;
 	std::vector<GLfloat> vertices;
-	std::vector<std::vector<int>> levelArray;
+	std::shared_ptr<const LevelGrid> grid; // the level, shared with the simulation.
 
 	glm::vec3 startingPlayerPos;
 
@@ -62,7 +65,7 @@ private:
 
 public:
 
-	Map(std::shared_ptr<GLWindow>& mainWindow);
+	Map(std::shared_ptr<GLWindow>& mainWindow, JobSystem* jobSystem = nullptr);
 	~Map();
 
 	void generateWall(Wall buildDirection, int x, int z, int numberOfWalls);
@@ -72,7 +75,7 @@ public:
 	void draw(glm::mat4 model, glm::mat4 projection, std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& shader);
 	void drawMinimap(glm::mat4 model, glm::mat4 projection, std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& shader);
 
-	std::vector<std::vector<int>> getLevelArray();
+	std::shared_ptr<const LevelGrid> getGrid() const;
 
 	glm::vec3 getStartingPosition();
 };
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 #include "GL/glew.h"
 #include "stb_image.h"
+#include "Profiler.h"
 
 class Material
 {
@@ -16,6 +17,8 @@ private:
 
 	const char* fileLocation;
 
+	unsigned char* texData; // decoded pixels waiting for uploadTextureA().
+
 public:
 
 	Material();
@@ -28,6 +31,8 @@ public:
 
 	bool loadTexture();
 	bool loadTextureA();
+	bool decodeTexture();
+	bool uploadTextureA();
 
 	void useTexture();
 	void useMaterial(GLuint specularIntensityLocation, GLuint shininessLocation);
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CounterRandom.h"
+
+/* Generates levels of any size in the same format LevelLoader reads: 1 is a wall, 0 an open tile
+   with a pellet and 2 the player start. The maze is carved on the odd tiles and then has some
+   of its inner walls knocked out, so ghosts get junctions to choose at like in the real level.
+   The same seed and size always give the same level. */
+
+class MazeGenerator
+{
+private:
+
+	int tilesX;
+	int tilesY;
+	uint64_t seed;
+
+	std::vector<std::vector<int>> levelArray;
+
+public:
+
+	MazeGenerator(uint64_t seed = 0);
+
+	void generate(int tilesX, int tilesY, float loopChance = 0.15f);
+
+	inline const std::vector<std::vector<int>>& getLevel() const { return levelArray; }
+	inline int getTilesX() const { return tilesX; }
+	inline int getTilesY() const { return tilesY; }
+};
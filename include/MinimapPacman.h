@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Renderer.h"
+#include "Material.h"
+#include "Shader.h"
+#include "Camera.h"
+
+/* The flat Pacman marker that shows where the camera is on the minimap. */
+
+class MinimapPacman
+{
+private:
+
+	std::shared_ptr<VertexArray>		miniMapPacmanVAO;
+	std::unique_ptr<VertexBuffer>		miniMapPacmanVBO;
+	std::unique_ptr<VertexBufferLayout> miniMapPacmanVBLayout;
+	std::shared_ptr<IndexBuffer>		miniMapPacmanIBO;
+
+	std::shared_ptr<Material> miniMapPacmanMat;
+	std::shared_ptr<Renderer> miniMapPacmanRenderer;
+
+	GLuint uniformModel;
+	GLuint uniformProjection;
+
+public:
+
+	MinimapPacman();
+	~MinimapPacman();
+
+	void draw(std::shared_ptr<Camera>& camera, glm::mat4 projection, std::shared_ptr<Shader>& shader);
+};
@@ -14,6 +14,7 @@
 #include "VertexArray.h"
 
 #include "Renderer.h"
+#include "Profiler.h"
 
 class Model
 {
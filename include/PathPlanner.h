@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "JunctionGraph.h"
+#include "LevelGrid.h"
+#include "Profiler.h"
+
+/* Finds paths for ghosts away from the tick that asks for them. Ghosts request() a path while
+   they move, dispatch() hands everything requested in a tick to the JobSystem, where each path
+   is searched with A* on the shared level, and collect() hands the results to the next tick.
+   A result is never used in the tick that asked for it, so the game plays out the same however
+   long the searches take and on however many threads they run.
+
+   Paths wrap around the left and right edge like the tunnel. A request can forbid turning back
+   on the first step, ghosts never reverse at the junction they plan from.
+
+   Levels of HIERARCHY_TILES tiles and more are searched on a ClusterGraph instead of tile by
+   tile. Its paths can be a few steps longer than the shortest, but a search costs about the
+   same on any size of level. */
+
+class ClusterGraph;
+
+struct PathRequest
+{
+	int ghost;			// who asked, the result is handed back with it.
+	int fromTile;		// row major index of the tile the path starts in.
+	int targetTile;
+	uint8_t heading;	// GhostDirection the ghost arrives in fromTile with, the first step can't
+						// go back the way it came. GHOST_NONE allows any first step.
+};
+
+struct PathResult
+{
+	int ghost;
+	int fromTile;
+	uint8_t direction;	// first step from fromTile, GHOST_NONE if the target can't be reached.
+	int length;			// steps to the target, -1 if it can't be reached.
+};
+
+class PathPlanner
+{
+private:
+
+	std::shared_ptr<const LevelGrid> grid;
+	std::unique_ptr<ClusterGraph> clusters;	// only on levels of HIERARCHY_TILES and more.
+	JobSystem* jobSystem; // not owned, null searches in collect() on the calling thread.
+
+	std::mutex requestMutex;
+	std::vector<PathRequest> requests;	// requested this tick.
+	std::vector<PathRequest> batch;		// dispatched, being searched.
+	std::vector<PathResult> results;	// one per request of the batch.
+	std::vector<JobHandle> jobs;
+	bool solved;						// the batch has been searched.
+
+	std::atomic<unsigned long long> expandedTiles;
+	unsigned long long solvedPaths;
+
+	void solveRange(int begin, int end);
+	int heuristic(int fromTile, int toTile) const;
+
+public:
+
+	static const int REQUESTS_PER_JOB = 16;
+	static const int HIERARCHY_TILES = 256 * 256;
+
+	PathPlanner(std::shared_ptr<const LevelGrid> levelGrid, JobSystem* jobSystem = nullptr);
+	~PathPlanner();
+
+	PathPlanner(const PathPlanner&) = delete;
+	PathPlanner& operator=(const PathPlanner&) = delete;
+
+	void request(const PathRequest& pathRequest);
+	void dispatch();
+	const std::vector<PathResult>& collect();
+	void cancel();
+
+	PathResult solve(const PathRequest& pathRequest, unsigned long long& expanded) const;
+	PathResult searchTiles(const PathRequest& pathRequest, unsigned long long& expanded) const;
+
+	void setJobSystem(JobSystem* jobs);
+
+	inline const ClusterGraph* getClusterGraph() const { return clusters.get(); }
+	inline unsigned long long getSolvedPaths() const { return solvedPaths; }
+	inline unsigned long long getExpandedTiles() const { return expandedTiles.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Pellets.h"
+#include "Camera.h"
+#include "Shader.h"
+#include "Material.h"
+#include "Model.h"
+#include "Profiler.h"
+
+/* Instanced drawing of the pellets that are left in a Pellets object. */
+
+class PelletRenderer {
+
+private:
+
+	std::unique_ptr<Model> pelletModel;
+	std::unique_ptr<Material> pelletSpec;
+
+	std::shared_ptr<VertexArray> instancedVAO;
+	std::shared_ptr<VertexBuffer> instancedVBO;
+
+	std::vector<glm::mat4> modelMatrices;
+
+	int numInstances;
+	unsigned int uploadedVersion;
+
+	GLuint uniformSpecularIntensity;
+	GLuint uniformShininess;
+
+	GLuint uView;
+	GLuint uProj;
+
+	void buildMatrices(const Pellets& pellets);
+
+public:
+
+	PelletRenderer(const Pellets& pellets);
+
+	void update(const Pellets& pellets);
+
+	void draw(std::shared_ptr<Shader>& pelletShader);
+	void drawMinimap(std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& pelletShader, glm::mat4 projection);
+};
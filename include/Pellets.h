@@ -1,67 +1,43 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
-#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+#include <glm/glm.hpp>
 
-#include "DirectionalLight.h"
-
-#include "GLWindow.h"
-#include "Shader.h"
-#include "Camera.h"
-
-#include "Material.h"
-#include "Renderer.h"
-
-#include "Model.h"
+#include "EventBus.h"
+#include "FixedPoint.h"
+#include "LevelGrid.h"
+#include "Profiler.h"
+#include "StateBuffer.h"
 
 class Pellets {
 
 private:
 
-	std::unique_ptr<Model> pelletModel;
-	std::unique_ptr<Material> pelletSpec;
-	std::unique_ptr<Material> minimapPelletSpec;
-
-	std::shared_ptr<VertexArray> instancedVAO;
-	std::shared_ptr<VertexBuffer> instancedVBO;
-	std::shared_ptr<VertexBufferLayout> instancedVBLayout;
-
-	std::shared_ptr<Shader> shader;
-
-	int numPellets;
-	int numPelletsEaten;
+	int totalPellets;
+	int tilesX;
+	int tilesZ;
 
-	float x;
-	float z;
+	unsigned int version; // bumped every time a pellet is removed, lets renderers know to re-upload.
 
-	std::vector<std::vector<int>> levelArray;
 	std::vector<glm::vec3> pelletsPositions;
 
-	glm::mat4 projection;
-	glm::mat4 model;
-	glm::vec3 position;
-
-	glm::mat4* modelMatrices; // Raw because of.
-
-	GLuint uniformStoneTex = 0;
-	GLuint uniformSpecularIntensity;
-	GLuint uniformShininess;
-
-	GLuint uView;
-	GLuint uProj;
-	GLuint uMod;
-
 public:
 
-	Pellets(std::vector<std::vector<int>> levelArrayData, std::shared_ptr<GLWindow>& mainWindow);
+	Pellets(const LevelGrid& grid);
 
-	void generatePellets();
-	void checkPelletsCollision(glm::vec3 playerPosition);
+	void checkPelletsCollision(glm::vec3 playerPosition, EventBus& events);
+	void checkPelletsCollisionFixed(int32_t playerX, int32_t playerY, int32_t playerZ, EventBus& events);
 	bool allPelletsEaten();
+	void setPositions(const std::vector<glm::vec3>& positions, unsigned int newVersion);
+
+	void saveState(StateWriter& writer) const;
+	bool restoreState(StateReader& reader);
 
-	void draw(std::shared_ptr<Shader>& pelletShader);
-	void drawMinimap(std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& pelletShader, glm::mat4 projection);
+	inline const std::vector<glm::vec3>& getPelletPositions() const { return pelletsPositions; }
+	inline unsigned int getVersion() const { return version; }
 
-	inline int getNumPellets() { return numPellets; }
-	inline int getNumPelletsEaten() { return numPelletsEaten; }
-};
\ No newline at end of file
+	inline int getNumPellets() const { return static_cast<int>(pelletsPositions.size()); }
+	inline int getNumPelletsEaten() const { return totalPellets - getNumPellets(); }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Scoped CPU timers. PROFILE_SCOPE("name") records how long the rest of the enclosing block takes,
+   scopes nest naturally and every thread writes to its own ring buffer without locking. The result
+   is written as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+
+   Recording is off until Profiler::start() is called and costs one relaxed load per scope then.
+   Building without PACMAN_PROFILE removes the scopes completely. */
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PACMAN_PROFILE
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD_NAME(name)
+#endif
+
+struct ProfileEvent
+{
+	const char* name;	// has to outlive the profiler, string literals in practice.
+	uint64_t start;		// nanoseconds since the profiler clock started.
+	uint64_t end;
+};
+
+class ProfileBuffer
+{
+public:
+
+	static const size_t CAPACITY = 1 << 17; // events kept per thread, older ones are overwritten.
+
+	std::vector<ProfileEvent> events;
+	std::atomic<uint64_t> head;	// number of events ever written, only the owning thread writes.
+	std::string threadName;
+	int threadId;
+
+	ProfileBuffer(int threadId) : events(CAPACITY), head(0), threadId(threadId) {}
+};
+
+class Profiler
+{
+private:
+
+	static std::atomic<bool> enabled;
+	static std::string outputPath;
+
+	static std::mutex buffersMutex;	// only taken when a thread records for the first time and on export.
+	static std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+
+	static ProfileBuffer& threadBuffer();
+
+public:
+
+	static void start(const std::string& path);
+	static void stop();
+	static inline bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	static uint64_t now();
+	static void record(const char* name, uint64_t start, uint64_t end);
+	static void record(ProfileBuffer& buffer, const char* name, uint64_t start, uint64_t end);
+	static void setThreadName(const std::string& name);
+	static ProfileBuffer* createLane(const std::string& name);
+
+	static bool save();
+	static bool writeChromeTrace(const std::string& path);
+};
+
+class ProfileScope
+{
+private:
+
+	const char* name;
+	uint64_t start;
+
+public:
+
+	explicit ProfileScope(const char* name)
+		: name(name), start(Profiler::isEnabled() ? Profiler::now() : 0) {}
+
+	~ProfileScope()
+	{
+		if (start != 0 && Profiler::isEnabled())
+		{
+			Profiler::record(name, start, Profiler::now());
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
@@ -8,8 +8,13 @@ class Renderer
 {
 private:
 
+	static unsigned int drawCalls; // since the last resetDrawCalls().
+
 public:
 
+	static inline unsigned int getDrawCalls() { return drawCalls; }
+	static inline void resetDrawCalls() { drawCalls = 0; }
+
 	void drawArrays(std::shared_ptr<VertexArray>& va);
 	void drawElements(std::shared_ptr<VertexArray>& va, std::shared_ptr<IndexBuffer>& ib);
 	void drawInstanced(std::shared_ptr<VertexArray>& va, std::shared_ptr<IndexBuffer>& ib, int numInstanced);
@@ -14,6 +14,7 @@
 #include "DirectionalLight.h"
 #include "PointLight.h"
 #include "SpotLight.h"
+#include "Profiler.h"
 
 
 class Shader {
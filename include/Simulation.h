@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "EventBus.h"
+#include "GhostStore.h"
+#include "JobSystem.h"
+#include "LevelGrid.h"
+#include "PathPlanner.h"
+#include "Pellets.h"
+#include "Profiler.h"
+#include "StateBuffer.h"
+
+/* The game logic for one game of Pacman: the player, the ghosts and the pellets on a level.
+   Nothing in here touches OpenGL, so it runs the same in the game and in pacman_headless. */
+
+enum class GameStatus { RUNNING, LOST, WON };
+
+struct GhostSnapshot
+{
+	glm::vec3 position;
+	glm::vec3 previousPosition;
+	uint8_t direction;	// GhostDirection.
+};
+
+/* What the renderer needs of one completed tick. Written by the simulation thread and only read
+   by the render thread once it is published, see SimulationThread. */
+struct SimulationSnapshot
+{
+	unsigned long long tick;
+	GameStatus status;
+	int score;
+	double tickTime;		// seconds on the simulation clock the tick was due at, for interpolation.
+
+	glm::vec3 cameraPosition;
+	glm::vec3 cameraPreviousPosition;
+	float cameraYaw;
+	float cameraPitch;
+
+	std::vector<GhostSnapshot> ghosts;
+
+	unsigned int pelletVersion;
+	std::vector<glm::vec3> pellets; // only copied when pelletVersion changed.
+
+	SimulationSnapshot() : tick(0), status(GameStatus::RUNNING), score(0), tickTime(0.0), cameraPosition(0.0f),
+		cameraPreviousPosition(0.0f), cameraYaw(0.0f), cameraPitch(0.0f), pelletVersion(~0u) {}
+};
+
+/* Time spent in each part of update(), added up over the ticks. With a JobSystem the pellets are
+   checked while the ghosts move, ghostsMs then includes waiting for the pellets. */
+struct SimulationTimings
+{
+	double playerMs;
+	double ghostsMs;
+	double pelletsMs;
+	unsigned long long ticks;
+
+	SimulationTimings() : playerMs(0.0), ghostsMs(0.0), pelletsMs(0.0), ticks(0) {}
+};
+
+class Simulation
+{
+private:
+
+	int numberOfGhosts;
+	unsigned long long tick;
+	uint64_t seed;
+
+	GameStatus status;
+	int score;
+
+	std::shared_ptr<const LevelGrid> grid;	// the level, shared with the renderer and other games.
+
+	std::shared_ptr<Camera> camera;
+	std::unique_ptr<GhostStore> ghosts;
+	std::unique_ptr<Pellets> pellets;
+	std::unique_ptr<PathPlanner> planner;	// null while the ghosts chase with the flow field.
+
+	glm::vec3 startingPos;
+	int playerTileX;	// tile the player was in at the end of the last tick.
+	int playerTileZ;
+
+	EventBus events;	// events of the last tick, dispatched at the end of update().
+
+	JobSystem* jobSystem; // not owned, null runs everything on the calling thread.
+	SimulationTimings* timings; // not owned, null when not measured.
+	bool endless;
+
+	glm::vec3 findStartingPosition();
+	int moveGhosts(int begin, int end, float dt);
+	void checkPellets(glm::vec3 playerPosition);
+	void emitTileEntered();
+	size_t stateSize() const;
+	void writeState(StateWriter& writer) const;
+	uint32_t stateModes() const;
+
+public:
+
+	static const int PARALLEL_GHOSTS = 64; // below this, splitting the ghosts into jobs costs more than it saves.
+	static const int PELLET_POINTS = 10;
+	static constexpr uint32_t STATE_MAGIC = 0x37534d50; // "PMS7", bump when the layout of saveState() changes.
+	static constexpr uint32_t STATE_FIXED = 1;			// stateModes() flags, a state only restores into the same modes.
+	static constexpr uint32_t STATE_SCHEDULED = 2;
+	static constexpr uint32_t STATE_BANDS = 4;
+
+	Simulation(std::shared_ptr<const LevelGrid> levelGrid, int numberOfGhosts, uint64_t seed);
+	~Simulation();
+
+	GameStatus update(bool* keys, float changeX, float changeY, float dt);
+	void interpolate(float alpha);
+
+	void writeSnapshot(SimulationSnapshot& snapshot) const;
+	void applySnapshot(const SimulationSnapshot& snapshot);
+
+	void saveState(std::vector<uint8_t>& buffer) const;
+	bool restoreState(const std::vector<uint8_t>& buffer);
+
+	void setJobSystem(JobSystem* jobs);
+	void setPathPlanning(bool enabled);
+	void setEventScheduling(bool enabled);
+	void setDetailBands(const std::vector<DetailBand>& bands);
+	void setFixedPoint(bool enabled);
+	inline void setTimings(SimulationTimings* times) { timings = times; }
+	inline void setEndless(bool neverEnds) { endless = neverEnds; }
+
+	inline std::shared_ptr<Camera>& getCamera() { return camera; }
+	inline GhostStore& getGhosts() { return *ghosts; }
+	inline Pellets& getPellets() { return *pellets; }
+	inline const PathPlanner* getPlanner() const { return planner.get(); }
+	inline EventBus& getEvents() { return events; }
+
+	inline int getNumberOfGhosts() { return numberOfGhosts; }
+	inline unsigned long long getTick() { return tick; }
+	inline uint64_t getSeed() { return seed; }
+	inline GameStatus getStatus() { return status; }
+	inline int getScore() { return score; }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "EventBus.h"
+#include "Profiler.h"
+#include "Simulation.h"
+#include "TripleBuffer.h"
+
+/* Runs a Simulation on its own thread at a fixed tick rate, so a slow frame does not hold back
+   the game and a slow tick does not hold back the frame. After every tick the thread publishes a
+   snapshot through a TripleBuffer, the render thread takes the newest one whenever it starts a
+   frame. Input goes the other way: the render thread hands over the keys and the mouse movement
+   every frame, they are consumed by the next tick. The events of every tick are queued until the
+   render thread takes them, unlike snapshots none of them are skipped. */
+
+class SimulationThread
+{
+public:
+
+	static const int KEY_COUNT = 1024; // same size as the keys of InputState.
+
+private:
+
+	std::unique_ptr<Simulation> simulation;
+	float tickLength;
+
+	TripleBuffer<SimulationSnapshot> snapshots;
+
+	std::mutex inputMutex; // held only to copy the input, once a frame and once a tick.
+	bool keys[KEY_COUNT];
+	float changeX;
+	float changeY;
+
+	std::mutex eventMutex;
+	EventBus pendingEvents; // events of the ticks since the last takeEvents().
+
+	std::chrono::steady_clock::time_point startTime;
+	std::atomic<bool> running;
+	std::thread thread;
+
+	void run();
+
+public:
+
+	SimulationThread(std::unique_ptr<Simulation> simulation, float tickLength);
+	~SimulationThread();
+
+	void start();
+	void stop();
+
+	void setInput(const bool* newKeys, float newChangeX, float newChangeY);
+	void takeEvents(EventBus& events);
+
+	double now() const;
+
+	inline bool updateSnapshot() { return snapshots.update(); }
+	inline const SimulationSnapshot& getSnapshot() const { return snapshots.readBuffer(); }
+	inline float getTickLength() const { return tickLength; }
+};
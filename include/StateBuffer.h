@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/* Reads and writes the state of a game as raw bytes in one flat buffer, see Simulation::saveState().
+   Values are copied as they are in memory, so a buffer is only meant to be restored by the same
+   build on the same machine, e.g. for rewinding or for a bot searching ahead from a position.
+
+   The writer reuses the capacity of the buffer it is given, so saving over and over into the same
+   buffer does not allocate. A writer without a buffer only counts the bytes, so the size of a state
+   comes from the same code that writes it. The reader checks every read against the end of the
+   buffer. */
+
+class StateWriter
+{
+private:
+
+	std::vector<uint8_t>* buffer;	// nullptr when only counting.
+	size_t counted;
+
+public:
+
+	/**
+	*   Starts writing at the beginning of a buffer, what it held before is dropped.
+	*
+	*   @param buffer - The buffer to write to.
+	*/
+	explicit StateWriter(std::vector<uint8_t>& buffer) : buffer(&buffer), counted(0) { buffer.clear(); }
+
+	/**
+	*   Writes nothing, only counts the bytes that would be written, see size().
+	*/
+	StateWriter() : buffer(nullptr), counted(0) {}
+
+	/**
+	*   Adds the bytes of a value.
+	*
+	*   @param value - Anything trivially copyable.
+	*/
+	template <typename T>
+	inline void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written");
+		if (buffer == nullptr)
+		{
+			counted += sizeof(T);
+			return;
+		}
+		size_t offset = buffer->size();
+		buffer->resize(offset + sizeof(T));
+		std::memcpy(buffer->data() + offset, &value, sizeof(T));
+	}
+
+	/**
+	*   Adds the bytes of every element of an array, the count is not written.
+	*
+	*   @param values - The array.
+	*/
+	template <typename T>
+	inline void writeArray(const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values can be written");
+		if (buffer == nullptr)
+		{
+			counted += values.size() * sizeof(T);
+			return;
+		}
+		size_t offset = buffer->size();
+		buffer->resize(offset + values.size() * sizeof(T));
+		if (!values.empty())
+		{
+			std::memcpy(buffer->data() + offset, values.data(), values.size() * sizeof(T));
+		}
+	}
+
+	/**
+	*   Bytes written, or counted by a writer without a buffer.
+	*
+	*   @return size_t - bytes.
+	*/
+	inline size_t size() const { return buffer != nullptr ? buffer->size() : counted; }
+};
+
+class StateReader
+{
+private:
+
+	const uint8_t* data;
+	size_t size;
+	size_t offset;
+
+public:
+
+	/**
+	*   Starts reading at the beginning of a buffer.
+	*
+	*   @param buffer - Written by a StateWriter, must outlive the reader.
+	*/
+	explicit StateReader(const std::vector<uint8_t>& buffer) : data(buffer.data()), size(buffer.size()), offset(0) {}
+
+	/**
+	*   Takes the next value.
+	*
+	*   @param value - Gets the value.
+	*
+	*   @return bool - false if the buffer ends first, value is left as it was.
+	*/
+	template <typename T>
+	inline bool read(T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read");
+		if (size - offset < sizeof(T))
+		{
+			return false;
+		}
+		std::memcpy(&value, data + offset, sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+
+	/**
+	*   Takes the next count values into an array that already holds count elements.
+	*
+	*   @param values - Gets the values, its size is the count.
+	*
+	*   @return bool - false if the buffer ends first, values are left as they were.
+	*/
+	template <typename T>
+	inline bool readArray(std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "only plain values can be read");
+		size_t bytes = values.size() * sizeof(T);
+		if (size - offset < bytes)
+		{
+			return false;
+		}
+		if (bytes > 0)
+		{
+			std::memcpy(values.data(), data + offset, bytes);
+		}
+		offset += bytes;
+		return true;
+	}
+
+	/**
+	*   Whether every byte of the buffer has been read.
+	*
+	*   @return bool - true at the end.
+	*/
+	inline bool finished() const { return offset == size; }
+};
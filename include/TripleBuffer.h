@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/* Hands the latest value from one writer thread to one reader thread without locks. There are
+   three slots: the writer fills its back slot and swaps it with the middle one, the reader swaps
+   its front slot with the middle one when something new was published. Neither thread ever waits
+   for the other, and the reader always gets the newest complete value, older ones are skipped.
+
+   Slots are reused, a slot the writer gets back holds a value from a few publishes ago. */
+
+template <typename T>
+class TripleBuffer
+{
+private:
+
+	static const uint8_t INDEX = 0x3;
+	static const uint8_t FRESH = 0x4; // set on the middle slot when it has not been read yet.
+
+	T slots[3];
+	std::atomic<uint8_t> middle;
+	uint8_t back;	// only touched by the writer.
+	uint8_t front;	// only touched by the reader.
+
+public:
+
+	TripleBuffer() : middle(1), back(0), front(2) {}
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	/**
+	*   The slot the writer fills, only valid until the next publish().
+	*
+	*   @return T& - the back slot.
+	*/
+	inline T& writeBuffer() { return slots[back]; }
+
+	/**
+	*   Makes the back slot the newest value and gives the writer another slot.
+	*/
+	inline void publish()
+	{
+		back = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX;
+	}
+
+	/**
+	*   Takes the newest published value, if there is one the reader has not seen.
+	*
+	*   @return bool - true if readBuffer() changed.
+	*/
+	inline bool update()
+	{
+		if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+		{
+			return false;
+		}
+		front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	/**
+	*   The slot the reader looks at, valid until the next update().
+	*
+	*   @return const T& - the front slot.
+	*/
+	inline const T& readBuffer() const { return slots[front]; }
+};
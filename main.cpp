@@ -6,24 +6,130 @@
 *   Model importing is done through Assimp and GLFW supports I/O. Images
 *   are loaded through the stb_image header library. Project is built with CMake.
 * 
+*   --record <file> writes all input to a file, --replay <file> plays a recorded game again
+*   with the same seed and tick rate, e.g. to compare frame times between two builds.
+*   --profile <file> records the PROFILE_SCOPE timers and GPU pass times and writes a Chrome trace
+*   on F9 and at exit, average GPU time per pass is printed at exit.
+*   --stats <name> prints rolling frame time percentiles every few seconds and writes <name>.csv
+*   (the last frames) and <name>.json (the whole session) at exit.
+*   The simulation runs on its own thread, --serial runs it in the render loop instead. Recording
+*   and replaying always run serially, the input has to be tied to the tick that consumes it.
+*   --fixed moves the player and the ghosts in fixed point, so a recording replays the same bits
+*   on every machine. The recording stores it, a replay uses the mode it was recorded with. The
+*   game doesn't use path planning, event scheduling or distance bands, a recording that has
+*   them is refused.
 *
 *   @name Pacman3D.exe
 *   @author(s) Elvis Arifagic, Jrgen Eriksen, Salvador Bascunan.
 */
 
-int main() 
+int main(int argc, char** argv) 
 {
+	std::string recordPath;
+	std::string replayPath;
+	std::string profilePath;
+	std::string statsPath;
+	bool serial = false;
+	bool fixed = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--serial") { serial = true; }
+		else if (arg == "--fixed") { fixed = true; }
+		else if (arg == "--record" && hasValue) { recordPath = argv[++i]; }
+		else if (arg == "--replay" && hasValue) { replayPath = argv[++i]; }
+		else if (arg == "--profile" && hasValue) { profilePath = argv[++i]; }
+		else if (arg == "--stats" && hasValue) { statsPath = argv[++i]; }
+	}
+
+	if (!profilePath.empty())
+	{
+		PROFILE_THREAD_NAME("main");
+		Profiler::start(profilePath);
+	}
+
 	auto mainWindow = std::make_shared<GLWindow>(800, 600); // make the window.
 	mainWindow->initialise(); 
 
+	if (!profilePath.empty() || !statsPath.empty())
+	{
+		GpuProfiler::initialise(); // needs the OpenGL context.
+	}
+
 	auto pacmangame = std::make_unique<Game>();
+	pacmangame->setFixedPoint(fixed);
+
+	if (!replayPath.empty() && mainWindow->startReplay(replayPath))
+	{
+		if ((mainWindow->getReplayModes() & ~INPUT_MODE_FIXED) != 0 || !mainWindow->getReplayBands().empty())
+		{
+			std::cerr << replayPath << " was recorded with planning, events or bands, which the game doesn't have.\n";
+			return EXIT_FAILURE;
+		}
+		pacmangame->setSeed(mainWindow->getReplaySeed()); // same game as the one recorded.
+		pacmangame->setTickRate(mainWindow->getReplayTickRate());
+		pacmangame->setFixedPoint((mainWindow->getReplayModes() & INPUT_MODE_FIXED) != 0);
+	}
+
+	if (!recordPath.empty())
+	{
+		mainWindow->startRecording(recordPath, pacmangame->getSeed(), pacmangame->getTickRate(),
+			pacmangame->isFixedPoint() ? INPUT_MODE_FIXED : 0);
+	}
+
+	// input of a recording or replay has to be consumed by a known tick, which only the serial loop does.
+	pacmangame->setPipelined(!serial && !mainWindow->isReplaying() && recordPath.empty());
 	pacmangame->generateGame(mainWindow); // create the game.
 
+	auto frameStats = std::make_unique<FrameStats>();
+	frameStats->setLabel(pacmangame->isPipelined() ? "pipelined" : "serial");
+	if (!statsPath.empty())
+	{
+		std::cout << (pacmangame->isPipelined() ? "simulation on its own thread\n" : "simulation in the render loop\n");
+	}
+
+	double frameStart = glfwGetTime();
+	double lastReport = frameStart;
+
     while (!mainWindow->shouldClose()) 
     {
+		PROFILE_SCOPE("frame");
+		unsigned long long ticksBefore = pacmangame->getSimulationTick();
+		Renderer::resetDrawCalls();
+
 		glfwPollEvents();
 		pacmangame->updateGame(mainWindow);
+		double workDone = glfwGetTime();
 		mainWindow->swapBuffer();
+		double frameEnd = glfwGetTime();
+
+		FrameSample sample;
+		sample.frameMs = static_cast<float>((frameEnd - frameStart) * 1000.0);
+		sample.cpuMs = static_cast<float>((workDone - frameStart) * 1000.0);
+		sample.gpuMs = static_cast<float>(GpuProfiler::getLastFrameTime());
+		sample.ticks = static_cast<uint32_t>(pacmangame->getSimulationTick() - ticksBefore);
+		sample.drawCalls = Renderer::getDrawCalls();
+		frameStats->addFrame(sample);
+		frameStart = frameEnd;
+
+		if (!statsPath.empty() && frameEnd - lastReport > 5.0)
+		{
+			frameStats->printRolling(std::cout, 600);
+			lastReport = frameEnd;
+		}
     }
+
+	if (!statsPath.empty())
+	{
+		frameStats->printRolling(std::cout, 600);
+		frameStats->writeCsv(statsPath + ".csv");
+		frameStats->writeJson(statsPath + ".json");
+	}
+
+	GpuProfiler::writeSummary(std::cout);
+	GpuProfiler::shutdown();
+	Profiler::save();
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,516 @@
+#include "BatchSimulation.h"
+
+/**
+*  BatchSimulation runs a large number of independent Pacman games side by side, e.g. as
+*  environments for reinforcement learning. The level is stored once and every field of the
+*  worlds (player, ghosts, pellets) lives in its own flat array, so stepping all worlds is a
+*  loop over contiguous memory that the JobSystem splits into slices of worlds.
+*
+*  The movement rules mirror Camera::keyControls(), Camera::checkWallCollision(), GhostStore::move()
+*  and GhostStore::calculateAiDirection(), including the tile offsets and the tunnel teleport.
+*
+*  @name BatchSimulation.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Builds the shared level data and resets every world.
+*
+*   @param levelGrid       - The level, shared with every other user of it.
+*   @param numberOfWorlds  - How many games are played at once.
+*   @param numberOfGhosts  - Ghosts in every game.
+*   @param seed            - Seed of the batch. World w is seeded with CounterRandom::hash(seed, w, 0),
+*							 the same seed pacman_headless gives its game number w.
+*   @param numberOfThreads - Threads stepping the worlds, 0 uses every core.
+*
+*	@see resetWorld()
+*/
+BatchSimulation::BatchSimulation(std::shared_ptr<const LevelGrid> levelGrid, int numberOfWorlds, int numberOfGhosts,
+	uint64_t seed, int numberOfThreads)
+	: numberOfWorlds(numberOfWorlds), numberOfGhosts(numberOfGhosts), totalPellets(0), grid(std::move(levelGrid)), startingPos(1.0f), autoReset(false)
+{
+	tilesZ = grid->getTilesZ();
+	tilesX = grid->getTilesX();
+
+	pelletIndex.assign(tilesX * tilesZ, -1);
+
+	const uint8_t* tiles = grid->getTiles();
+	for (int tile = 0; tile < tilesX * tilesZ; tile++)
+	{
+		if (tiles[tile] == LevelGrid::OPEN)
+		{
+			pelletIndex[tile] = totalPellets++;
+		}
+	}
+
+	int startTileZ = -1;
+	if (grid->getStartTile() >= 0)
+	{
+		startTileZ = grid->getStartTile() / tilesX;
+		startingPos = glm::vec3(grid->getStartTile() % tilesX * 2 + 1, 1.0f, startTileZ * 2 + 1);
+	}
+
+	// ghosts don't spawn in the tunnel row the player starts in, same rule as GhostStore.
+	for (int z = 0; z < tilesZ; z++)
+	{
+		for (int x = 0; x < tilesX; x++)
+		{
+			if (tiles[z * tilesX + x] == LevelGrid::OPEN && z != startTileZ)
+			{
+				spawnTiles.push_back(z * tilesX + x);
+			}
+		}
+	}
+
+	pelletWords = (totalPellets + 63) / 64;
+	graph = std::make_unique<JunctionGraph>(*grid);
+
+	playerX.resize(numberOfWorlds);
+	playerZ.resize(numberOfWorlds);
+	playerYaw.resize(numberOfWorlds);
+	inputKeys.assign(numberOfWorlds, 0);
+	inputChangeX.assign(numberOfWorlds, 0.0f);
+	status.resize(numberOfWorlds);
+	ticks.resize(numberOfWorlds);
+	pelletsLeft.resize(numberOfWorlds);
+	playerTile.resize(numberOfWorlds);
+	worldEvents.assign(numberOfWorlds, 0);
+	caughtBy.assign(numberOfWorlds, -1);
+	pellets.resize(static_cast<size_t>(numberOfWorlds) * pelletWords);
+
+	ghostX.resize(static_cast<size_t>(numberOfWorlds) * numberOfGhosts);
+	ghostZ.resize(ghostX.size());
+	ghostDirection.resize(ghostX.size());
+	ghostTileX.resize(ghostX.size());
+	ghostTileZ.resize(ghostX.size());
+
+	ghostRandomCounter.assign(ghostX.size(), 0);
+
+	worldSeeds.resize(numberOfWorlds);
+	flowFields.reserve(numberOfWorlds);
+	for (int w = 0; w < numberOfWorlds; w++)
+	{
+		worldSeeds[w] = CounterRandom::hash(seed, w, 0);
+		flowFields.emplace_back(*grid);
+	}
+
+	for (int w = 0; w < numberOfWorlds; w++)
+	{
+		resetWorld(w);
+	}
+
+	jobSystem = std::make_unique<JobSystem>(numberOfThreads);
+}
+
+/**
+*   Destructor for the batch, everything is initialized as smart pointers or vectors.
+*/
+BatchSimulation::~BatchSimulation()
+{
+
+}
+
+/**
+*   Puts a world back to the start of a game: player on the start tile, all pellets back and
+*	ghosts on new random spawn tiles.
+*
+*   @param world - Which world to reset.
+*/
+void BatchSimulation::resetWorld(int world)
+{
+	playerX[world] = startingPos.x;
+	playerZ[world] = startingPos.z;
+	playerYaw[world] = 0.0f;
+	status[world] = GameStatus::RUNNING;
+	ticks[world] = 0;
+	pelletsLeft[world] = totalPellets;
+	playerTile[world] = static_cast<int>(startingPos.z / 2) * tilesX + static_cast<int>(startingPos.x / 2);
+	worldEvents[world] = 0;
+	caughtBy[world] = -1;
+
+	uint64_t* pelletBits = &pellets[static_cast<size_t>(world) * pelletWords];
+	for (int i = 0; i < pelletWords; i++)
+	{
+		int bitsInWord = totalPellets - i * 64 < 64 ? totalPellets - i * 64 : 64;
+		pelletBits[i] = bitsInWord == 64 ? ~0ull : (1ull << bitsInWord) - 1;
+	}
+
+	for (int g = 0; g < numberOfGhosts; g++)
+	{
+		int ghost = world * numberOfGhosts + g;
+		int tile = spawnTiles[randomNumber(ghost, static_cast<int>(spawnTiles.size()) - 1)];
+
+		ghostX[ghost] = (tile % tilesX) * 2 + 1.0f;
+		ghostZ[ghost] = (tile / tilesX) * 2 + 1.0f;
+		ghostDirection[ghost] = DIR_NONE;
+		ghostTileX[ghost] = -1;
+		ghostTileZ[ghost] = -1;
+
+		ghostDirection[ghost] = randomOpenDirection(ghost, ghostCell(ghost)); // same start direction as GhostStore
+	}
+}
+
+/**
+*   Sets the input a world uses for its next steps.
+*
+*   @param world   - Which world to steer.
+*   @param keys    - Held keys, a combination of INPUT_W, INPUT_A, INPUT_S and INPUT_D.
+*   @param changeX - Mouse movement in X, only applied on the next step.
+*/
+void BatchSimulation::setInput(int world, uint8_t keys, float changeX)
+{
+	inputKeys[world] = keys;
+	inputChangeX[world] = changeX;
+}
+
+/**
+*   Steps every world by one tick, split across the thread pool. Worlds that have ended stay
+*	as they are, or start over if auto reset is on. The events of the step are dispatched
+*	after every world is done.
+*
+*   @param dt - Length of the tick in seconds.
+*
+*	@see emitEvents()
+*/
+void BatchSimulation::step(float dt)
+{
+	PROFILE_SCOPE("BatchSimulation::step");
+	jobSystem->parallelFor(numberOfWorlds, [this, dt](int begin, int end)
+	{
+		PROFILE_SCOPE("BatchSimulation::stepWorlds");
+		for (int w = begin; w < end; w++)
+		{
+			stepWorld(w, dt);
+		}
+	});
+	emitEvents();
+}
+
+/**
+*   Turns the marks the worlds left in the last step into events, in world order, and
+*	dispatches them. The events stay readable through getEvents() until the next step.
+*/
+void BatchSimulation::emitEvents()
+{
+	events.clear();
+	for (int w = 0; w < numberOfWorlds; w++)
+	{
+		uint8_t happened = worldEvents[w];
+		if (happened == 0)
+		{
+			continue;
+		}
+
+		int tileX = playerTile[w] % tilesX;
+		int tileZ = playerTile[w] / tilesX;
+		if (happened & EVENT_TILE)
+		{
+			events.emit(TileEntered{ w, tileX, tileZ });
+		}
+		if (happened & EVENT_PELLET) // the pellet is always in the player's tile.
+		{
+			events.emit(PelletEaten{ w, tileX, tileZ, pelletsLeft[w] });
+		}
+		if (happened & EVENT_COLLISION)
+		{
+			events.emit(GhostCollision{ w, caughtBy[w], getGhostPosition(w, caughtBy[w]) });
+		}
+		if (happened & EVENT_CLEARED)
+		{
+			events.emit(LevelCleared{ w, ticks[w] - 1ull });
+		}
+	}
+	events.dispatch();
+}
+
+/**
+*   Same as GhostStore::tileIndexX(), the offset lets a ghost clear the corner before turning.
+*/
+int BatchSimulation::tileIndexX(float x, uint8_t direction) const
+{
+	float offset = 0;
+	if (direction == DIR_LEFT) { offset = 0.9f; }
+	else if (direction == DIR_RIGHT) { offset = -0.9f; }
+
+	return static_cast<int>(floor((x + offset) / 2));
+}
+
+/**
+*   Same as GhostStore::tileIndexZ().
+*/
+int BatchSimulation::tileIndexZ(float z, uint8_t direction) const
+{
+	float offset = 0;
+	if (direction == DIR_UP) { offset = 0.9f; }
+	else if (direction == DIR_DOWN) { offset = -0.9f; }
+
+	return static_cast<int>(floor((z + offset) / 2));
+}
+
+/**
+*   JunctionGraph::cell() of the tile a ghost is in, with the same offsets as GhostStore.
+*
+*   @param ghost - Index of the ghost in the ghost arrays.
+*/
+uint8_t BatchSimulation::ghostCell(int ghost) const
+{
+	return graph->cell(tileIndexX(ghostX[ghost], ghostDirection[ghost]), tileIndexZ(ghostZ[ghost], ghostDirection[ghost]));
+}
+
+/**
+*   Same as GhostStore::randomOpenDirection(), nothing is drawn when there is only one way.
+*
+*   @param ghost - Index of the ghost in the ghost arrays.
+*   @param cell  - JunctionGraph::cell() of the tile.
+*/
+uint8_t BatchSimulation::randomOpenDirection(int ghost, uint8_t cell)
+{
+	uint8_t placesToMove[4];
+	int places = 0;
+	for (uint8_t direction = DIR_UP; direction <= DIR_RIGHT; direction++)
+	{
+		if (cell & JunctionGraph::openBit(direction))
+		{
+			placesToMove[places++] = direction;
+		}
+	}
+	if (places <= 1)
+	{
+		return places == 0 ? static_cast<uint8_t>(DIR_NONE) : placesToMove[0];
+	}
+	return placesToMove[randomNumber(ghost, places - 1)];
+}
+
+/**
+*   Random number between 0 and the argument value from the ghost's own stream. Ghost g of a world
+*	uses stream g of the world seed, like Ghost does in Simulation.
+*
+*   @param ghost               - Index of the ghost in the ghost arrays.
+*   @param highestRandomNumber - The highest possible number.
+*/
+int BatchSimulation::randomNumber(int ghost, int highestRandomNumber)
+{
+	int world = ghost / numberOfGhosts;
+	return CounterRandom::uniformInt(worldSeeds[world], ghost - world * numberOfGhosts, ghostRandomCounter[ghost]++, highestRandomNumber);
+}
+
+/**
+*   Same as Camera::checkWallCollision().
+*
+*   @return bool - true if the move would go into a wall.
+*/
+bool BatchSimulation::playerWallCollision(int world, float unitX, float unitZ, float speed) const
+{
+	float offset = 0.3f;
+	int currentTileX = static_cast<int>(floor(playerX[world] / 2));
+	int projectionTileX = static_cast<int>(floor((playerX[world] / 2) + unitX * (speed + offset)));
+
+	int currentTileZ = static_cast<int>(floor(playerZ[world] / 2));
+	int projectionTileZ = static_cast<int>(floor((playerZ[world] / 2) + unitZ * (speed + offset)));
+
+	if (!grid->contains(projectionTileX, projectionTileZ)) // if about to teleport
+	{
+		return false;
+	}
+
+	if (projectionTileZ != currentTileZ)
+	{
+		return grid->isWall(currentTileX, projectionTileZ);
+	}
+	else if (projectionTileX != currentTileX)
+	{
+		return grid->isWall(projectionTileX, currentTileZ);
+	}
+	return false;
+}
+
+/**
+*   Same as Camera::keyControls() followed by Camera::mouseControl().
+*/
+void BatchSimulation::stepPlayer(int world, float dt)
+{
+	float yaw = glm::radians(playerYaw[world]);
+	float frontX = cos(yaw);
+	float frontZ = sin(yaw);
+	float rightX = -frontZ; // front x world up
+	float rightZ = frontX;
+
+	float velocity = 4 * dt;
+	uint8_t keys = inputKeys[world];
+
+	if ((keys & INPUT_W) && !playerWallCollision(world, frontX, frontZ, velocity))
+	{
+		playerX[world] += frontX * velocity;
+		playerZ[world] += frontZ * velocity;
+	}
+	if ((keys & INPUT_S) && !playerWallCollision(world, -frontX, -frontZ, velocity))
+	{
+		playerX[world] -= frontX * velocity;
+		playerZ[world] -= frontZ * velocity;
+	}
+	if ((keys & INPUT_A) && !playerWallCollision(world, -rightX, -rightZ, velocity))
+	{
+		playerX[world] -= rightX * velocity;
+		playerZ[world] -= rightZ * velocity;
+	}
+	if ((keys & INPUT_D) && !playerWallCollision(world, rightX, rightZ, velocity))
+	{
+		playerX[world] += rightX * velocity;
+		playerZ[world] += rightZ * velocity;
+	}
+
+	if (playerX[world] < 0.6f)
+	{
+		playerX[world] = tilesX * 2 - 0.8f;
+	}
+	else if (playerX[world] > tilesX * 2 - 0.6f)
+	{
+		playerX[world] = 1;
+	}
+
+	playerYaw[world] += inputChangeX[world] * 0.03f; // Camera turn speed.
+	inputChangeX[world] = 0.0f;
+}
+
+/**
+*   Same as GhostStore::calculateAiDirection(): back out of a dead end, at a junction take the
+*	shortest way to the player from the world's flow field with a chance of 1/aiValue,
+*	otherwise pick a random open direction.
+*/
+void BatchSimulation::calculateAiDirection(int world, int ghost, uint8_t cell)
+{
+	uint8_t open = cell & ~JunctionGraph::NODE;
+	if ((open & (open - 1)) == 0)
+	{
+		if (open != 0)
+		{
+			ghostDirection[ghost] = JunctionGraph::firstDirection(open);
+		}
+		return;
+	}
+
+	int aiValue = ghost - world * numberOfGhosts + 1;
+	uint8_t newDirection = DIR_NONE;
+
+	if (randomNumber(ghost, aiValue - 1) == 0)
+	{
+		newDirection = flowFields[world].bestDirection(ghostTileX[ghost], ghostTileZ[ghost]);
+	}
+
+	if (newDirection == DIR_NONE)
+	{
+		newDirection = randomOpenDirection(ghost, open);
+	}
+	ghostDirection[ghost] = newDirection;
+}
+
+/**
+*   Same as the decision in GhostStore::move(), for a ghost GhostKernel moved into a new tile.
+*/
+void BatchSimulation::turnGhost(int world, int ghost)
+{
+	uint8_t direction = ghostDirection[ghost];
+	uint8_t cell = graph->cell(ghostTileX[ghost], ghostTileZ[ghost]);
+	if (cell & JunctionGraph::NODE)
+	{
+		calculateAiDirection(world, ghost, cell);
+	}
+	else if (cell != 0) // corridor, follow the bend like GhostStore::move().
+	{
+		uint8_t forward = cell & ~JunctionGraph::openBit(JunctionGraph::reverse(direction));
+		if ((forward & JunctionGraph::openBit(direction)) == 0)
+		{
+			ghostDirection[ghost] = JunctionGraph::firstDirection(forward);
+		}
+	}
+}
+
+/**
+*   Same as Simulation::update() for one world.
+*/
+void BatchSimulation::stepWorld(int world, float dt)
+{
+	worldEvents[world] = 0;
+	if (status[world] != GameStatus::RUNNING)
+	{
+		if (autoReset)
+		{
+			resetWorld(world);
+		}
+		return;
+	}
+
+	stepPlayer(world, dt);
+
+	float px = playerX[world];
+	float pz = playerZ[world];
+	flowFields[world].setTarget(static_cast<int>(floor(px / 2)), static_cast<int>(floor(pz / 2))); // GhostStore::track()
+
+	float delta = dt;
+	if (delta > 0.03f)
+	{
+		delta = 0.02f;
+	}
+
+	static thread_local std::vector<int> entered; // reused between worlds, one per thread.
+	entered.resize(numberOfGhosts);
+
+	// no previous positions, nothing is interpolated. The teleport edge is in float here.
+	int firstGhost = world * numberOfGhosts;
+	GhostLanes lanes = { ghostX.data(), ghostZ.data(), nullptr, nullptr, ghostDirection.data(), ghostTileX.data(), ghostTileZ.data() };
+	GhostStep ghostStep = { delta * 2.0f, 1.0f, GhostStore::wrapEdge(tilesX), tilesX * 2 - 1.0f, 1.0f };
+	int count = GhostKernel::advance(lanes, firstGhost, firstGhost + numberOfGhosts, ghostStep, entered.data());
+	for (int i = 0; i < count; i++)
+	{
+		turnGhost(world, entered[i]);
+	}
+
+	for (int ghost = firstGhost; ghost < firstGhost + numberOfGhosts; ghost++)
+	{
+		if (GhostStore::closeEnough(ghostX[ghost], ghostZ[ghost], glm::vec3(px, 0.0f, pz)) && status[world] == GameStatus::RUNNING)
+		{
+			status[world] = GameStatus::LOST;
+			worldEvents[world] |= EVENT_COLLISION;
+			caughtBy[world] = ghost - firstGhost;
+		}
+	}
+
+	// Only the pellet in the player's own tile can be close enough, they are a tile (2 units) apart.
+	int tileX = static_cast<int>(floor(px / 2));
+	int tileZ = static_cast<int>(floor(pz / 2));
+	if (tileZ * tilesX + tileX != playerTile[world])
+	{
+		playerTile[world] = tileZ * tilesX + tileX;
+		worldEvents[world] |= EVENT_TILE;
+	}
+	if (tileX >= 0 && tileZ >= 0 && tileX < tilesX && tileZ < tilesZ)
+	{
+		int pellet = pelletIndex[tileZ * tilesX + tileX];
+		if (pellet >= 0)
+		{
+			uint64_t& word = pellets[static_cast<size_t>(world) * pelletWords + pellet / 64];
+			uint64_t bit = 1ull << (pellet % 64);
+
+			float dx = px - (tileX * 2 + 1);
+			float dz = pz - (tileZ * 2 + 1);
+			float dy = startingPos.y - 0.5f; // pellets float at 0.5, same 3D distance as Pellets::checkPelletsCollision().
+			if ((word & bit) && dx * dx + dy * dy + dz * dz < 0.7f * 0.7f)
+			{
+				word &= ~bit;
+				pelletsLeft[world]--;
+				worldEvents[world] |= EVENT_PELLET;
+			}
+		}
+	}
+
+	if ((worldEvents[world] & EVENT_PELLET) && pelletsLeft[world] == 0)
+	{
+		worldEvents[world] |= EVENT_CLEARED;
+	}
+	if (status[world] == GameStatus::RUNNING && pelletsLeft[world] == 0)
+	{
+		status[world] = GameStatus::WON;
+	}
+
+	ticks[world]++;
+}
@@ -14,7 +14,7 @@
 *   Constructor for camera object. This is the one acts as the default for any object.
 *	Roll is not needed for this game.
 *
-*   @param     levelArrayData - Vector with 1's and 0's that make up the map.
+*   @param     levelGrid      - The level the camera collides with.
 *   @param     startPosition  - Where the camera is initially located in the world space.
 *   @param     startUp        - Direction of the world's up direction (+y is up).
 *   @param     startYaw       - Giving the camera a non-turned view to start.
@@ -24,9 +24,12 @@
 *
 *	@see	   update()
 */
-Camera::Camera(std::vector<std::vector<int>> levelArrayData, glm::vec3 startPosition, glm::vec3 startUp, GLfloat startYaw, GLfloat startPitch, GLfloat startMoveSpeed, GLfloat startTurnSpeed)
+Camera::Camera(std::shared_ptr<const LevelGrid> levelGrid, glm::vec3 startPosition, glm::vec3 startUp, float startYaw, float startPitch, float startMoveSpeed, float startTurnSpeed)
+	: grid(std::move(levelGrid)), fixedPoint(false), fixedX(0), fixedZ(0), fixedYaw(0), fixedFrontX(FixedPoint::ONE), fixedFrontZ(0)
 {
 	position = startPosition; // initialize standard constructor way with passed user params.
+	previousPosition = startPosition;
+	renderPosition = startPosition;
 	worldUp = startUp;
 	yaw = startYaw;
 	pitch = startPitch;
@@ -35,53 +38,7 @@ Camera::Camera(std::vector<std::vector<int>> levelArrayData, glm::vec3 startPosi
 	moveSpeed = startMoveSpeed;
 	turnSpeed = startTurnSpeed;
 
-	levelArray = levelArrayData;
-
 	update();
-
-    std::vector<GLuint> indices = 
-   {
-        0, 1, 2, 
-        1, 3, 2,
-   };
-
-
-   std::vector<GLfloat> vertices = 
-    {
-         //x        y       z          u     v       
-         0.0f,    0.0f,    2.0f,      0.0f,  0.0f,	  // 0
-         2.0f,    0.0f,    2.0f,      1.0f,  0.0f,	  // 1
-		 0.0f,    0.0f,    0.0f,      0.0f,  1.0f,	  // 2
-		 2.0f,    0.0f,    0.0f,      1.0f,  1.0f     // 3
-   };
-
-	miniMapPacmanVAO = std::make_shared<VertexArray>();
-	miniMapPacmanVAO->bind();
-       
-	miniMapPacmanVBO = std::make_unique<VertexBuffer>(&vertices[0], vertices.size() * sizeof(GLfloat));
-	miniMapPacmanVBO->bind();
-       
-	miniMapPacmanVBLayout = std::make_unique<VertexBufferLayout>();
-	miniMapPacmanVBLayout->Push<float>(3);
-	miniMapPacmanVBLayout->Push<float>(2);
-
-       
-	miniMapPacmanVAO->addBuffer(*miniMapPacmanVBO, *miniMapPacmanVBLayout);
-	miniMapPacmanIBO = std::make_shared<IndexBuffer>(&indices[0], indices.size());
-
-	miniMapPacmanMat = std::make_shared<Material>();
-	miniMapPacmanMat->getTexture("assets/textures/pacman_minimap.png");
-	miniMapPacmanMat->loadTextureA();
-
-	static const char* vShader = "assets/shaders/texture.vert";
-	static const char* fShader = "assets/shaders/texture.frag";
-
-	shader = std::make_shared<Shader>();
-	shader->createShaderFromFile(vShader, fShader);
-
-	uniformModel = shader->getModelLocation();
-	uniformProjection = shader->getProjectionLocation();
-	uniformView = shader->getViewLocation();
 }
 
 /**
@@ -96,10 +53,18 @@ Camera::~Camera() {}
 *   @param     keys      - Pointer to relevant the ascii key inputs.
 *   @param     deltaTime - Calculated delta time to have uniformity in frame-rate.
 */
-void Camera::keyControls(bool* keys, GLfloat deltaTime) {
+void Camera::keyControls(bool* keys, float deltaTime) {
+
+	if (fixedPoint)
+	{
+		keyControlsFixed(keys, deltaTime);
+		return;
+	}
+
+	previousPosition = position;
 
-	GLfloat velocity = 4 * deltaTime;
-	if (keys[GLFW_KEY_W]) 
+	float velocity = 4 * deltaTime;
+	if (keys[KEY_W]) 
 	{
 		glm::vec3 direction = front;
 		if (!checkWallCollision(direction, velocity)) {
@@ -107,7 +72,7 @@ void Camera::keyControls(bool* keys, GLfloat deltaTime) {
 		}
 	}
 
-	if (keys[GLFW_KEY_S]) 
+	if (keys[KEY_S]) 
 	{
 		glm::vec3 direction = -front;
 		if (!checkWallCollision(direction, velocity)) {
@@ -115,7 +80,7 @@ void Camera::keyControls(bool* keys, GLfloat deltaTime) {
 		}
 	}
 
-	if (keys[GLFW_KEY_A]) 
+	if (keys[KEY_A]) 
 	{
 		glm::vec3 direction = -right;
 		if (!checkWallCollision(direction, velocity)) {
@@ -123,7 +88,7 @@ void Camera::keyControls(bool* keys, GLfloat deltaTime) {
 		}
 	}
 
-	if (keys[GLFW_KEY_D]) 
+	if (keys[KEY_D]) 
 	{
 		glm::vec3 direction = right;
 		if (!checkWallCollision(direction, velocity)) {
@@ -133,12 +98,164 @@ void Camera::keyControls(bool* keys, GLfloat deltaTime) {
 
 	 //This creates the teleport from one end to the other.
 	if (position.x < 0.6) {
-		position.x = levelArray[0].size()*2-0.8f;
-		
+		position.x = grid->getTilesX()*2-0.8f;
+		previousPosition = position; // don't interpolate across the whole map.
 	}
-	else if (position.x > levelArray[0].size()*2-0.6f) {
+	else if (position.x > grid->getTilesX()*2-0.6f) {
 		position.x = 1;
+		previousPosition = position;
+	}
+}
+
+/**
+*   keyControls() on the fixed point position: the same moves, collisions and teleport, in
+*	integers only. The float position is set from it afterwards.
+*
+*   @param     keys      - Pointer to relevant the ascii key inputs.
+*   @param     deltaTime - Calculated delta time to have uniformity in frame-rate.
+*
+*	@see setFixedPoint()
+*/
+void Camera::keyControlsFixed(bool* keys, float deltaTime)
+{
+	previousPosition = position;
+
+	int32_t velocity = FixedPoint::fromFloat(4 * deltaTime);
+	int32_t rightX = -fixedFrontZ; // the cross product of front and +y.
+	int32_t rightZ = fixedFrontX;
+	if (keys[KEY_W] && !checkWallCollisionFixed(fixedFrontX, fixedFrontZ, velocity))
+	{
+		fixedX += FixedPoint::multiply(fixedFrontX, velocity);
+		fixedZ += FixedPoint::multiply(fixedFrontZ, velocity);
+	}
+	if (keys[KEY_S] && !checkWallCollisionFixed(-fixedFrontX, -fixedFrontZ, velocity))
+	{
+		fixedX += FixedPoint::multiply(-fixedFrontX, velocity);
+		fixedZ += FixedPoint::multiply(-fixedFrontZ, velocity);
+	}
+	if (keys[KEY_A] && !checkWallCollisionFixed(-rightX, -rightZ, velocity))
+	{
+		fixedX += FixedPoint::multiply(-rightX, velocity);
+		fixedZ += FixedPoint::multiply(-rightZ, velocity);
+	}
+	if (keys[KEY_D] && !checkWallCollisionFixed(rightX, rightZ, velocity))
+	{
+		fixedX += FixedPoint::multiply(rightX, velocity);
+		fixedZ += FixedPoint::multiply(rightZ, velocity);
+	}
+
+	int32_t width = grid->getTilesX() * 2 * FixedPoint::ONE;
+	bool teleported = true;
+	if (fixedX < FixedPoint::fromFloat(0.6f)) { fixedX = width - FixedPoint::fromFloat(0.8f); }
+	else if (fixedX > width - FixedPoint::fromFloat(0.6f)) { fixedX = FixedPoint::ONE; }
+	else { teleported = false; }
+
+	position.x = FixedPoint::toFloat(fixedX);
+	position.z = FixedPoint::toFloat(fixedZ);
+	if (teleported)
+	{
+		previousPosition = position; // don't interpolate across the whole map.
+	}
+}
+
+/**
+*   checkWallCollision() on the fixed point position.
+*
+*   @param     directionX - X of the unit vector the camera moves along, in 16.16.
+*   @param     directionZ - Z of it.
+*   @param     speed      - How far the camera moves, in 16.16.
+*   @return    bool		  - returns false if there was no collision.
+*/
+bool Camera::checkWallCollisionFixed(int32_t directionX, int32_t directionZ, int32_t speed)
+{
+	int32_t reach = speed + FixedPoint::fromFloat(0.3f);
+	int currentTileX = FixedPoint::tile(fixedX);
+	int currentTileZ = FixedPoint::tile(fixedZ);
+	int projectionTileX = FixedPoint::tile(fixedX + 2 * FixedPoint::multiply(directionX, reach));
+	int projectionTileZ = FixedPoint::tile(fixedZ + 2 * FixedPoint::multiply(directionZ, reach));
+
+	if (!grid->contains(projectionTileX, projectionTileZ)) // if about to teleport
+	{
+		return false;
+	}
+	if (projectionTileZ != currentTileZ)
+	{
+		return grid->isWall(currentTileX, projectionTileZ);
+	}
+	if (projectionTileX != currentTileX)
+	{
+		return grid->isWall(projectionTileX, currentTileZ);
 	}
+	return false;
+}
+
+/**
+*   Switches between moving the camera on its float position and on a 16.16 fixed point
+*	position and yaw, see FixedPoint.h. With fixed point, a game plays out the same bits
+*	on every machine. The fixed point pose starts from the float one, and the float one is
+*	still set after every move, for drawing and for everything that only reads it.
+*
+*   @param enabled - true to move in fixed point.
+*/
+void Camera::setFixedPoint(bool enabled)
+{
+	if (enabled && !fixedPoint)
+	{
+		setFixedPose(FixedPoint::fromFloat(position.x), FixedPoint::fromFloat(position.z), FixedPoint::fromFloat(yaw));
+	}
+	fixedPoint = enabled;
+}
+
+/**
+*   Places the camera in fixed point, e.g. from a saved game. The float position and yaw are set
+*	from it, the previous position is left alone.
+*
+*   @param newX   - X in 16.16.
+*   @param newZ   - Z in 16.16.
+*   @param newYaw - Yaw in degrees, 16.16.
+*/
+void Camera::setFixedPose(int32_t newX, int32_t newZ, int32_t newYaw)
+{
+	fixedX = newX;
+	fixedZ = newZ;
+	fixedYaw = FixedPoint::wrapDegrees(newYaw);
+	position.x = FixedPoint::toFloat(fixedX);
+	position.z = FixedPoint::toFloat(fixedZ);
+	updateFixed();
+}
+
+/**
+*   Places the camera without moving it through the level, e.g. to show a snapshot of
+*	another simulation.
+*
+*   @param newPosition         - Position at the end of the last tick.
+*   @param newPreviousPosition - Position at the start of the last tick.
+*   @param newYaw              - Yaw in degrees.
+*   @param newPitch            - Pitch in degrees.
+*
+*	@see update()
+*/
+void Camera::setPose(glm::vec3 newPosition, glm::vec3 newPreviousPosition, float newYaw, float newPitch)
+{
+	position = newPosition;
+	previousPosition = newPreviousPosition;
+	yaw = newYaw;
+	pitch = newPitch;
+	update();
+	if (fixedPoint)
+	{
+		setFixedPose(FixedPoint::fromFloat(position.x), FixedPoint::fromFloat(position.z), FixedPoint::fromFloat(yaw));
+	}
+}
+
+/**
+*   Blends the position of the last two ticks, the result is what the view is built from.
+*
+*   @param alpha - How far into the next tick the frame is, between 0 and 1.
+*/
+void Camera::interpolate(float alpha)
+{
+	renderPosition = glm::mix(previousPosition, position, alpha);
 }
 
 /**
@@ -148,7 +265,7 @@ void Camera::keyControls(bool* keys, GLfloat deltaTime) {
 *   @param     speed		 - Ghost speed
 *   @return    bool			 - returns false if there was no collision.
 */
-bool Camera::checkWallCollision(glm::vec3 unitDirection, GLfloat speed)
+bool Camera::checkWallCollision(glm::vec3 unitDirection, float speed)
 {
 
 	float offset = 0.3f;
@@ -159,14 +276,14 @@ bool Camera::checkWallCollision(glm::vec3 unitDirection, GLfloat speed)
 	int projectionTileZ = floor((position.z / 2) + unitDirection.z * (speed + offset));
 
 
-	if (projectionTileX < 0 || projectionTileZ < 0 || projectionTileX > levelArray[0].size()-1 || projectionTileZ > levelArray.size()-1) { // if about to teleport
+	if (!grid->contains(projectionTileX, projectionTileZ)) { // if about to teleport
 		return false;
 	}
 
 
 	if (projectionTileZ != currentTileZ) // if unit is about to walk to a new z tile
 	{
-		if (levelArray[projectionTileZ][currentTileX] == 1)
+		if (grid->isWall(currentTileX, projectionTileZ))
 		{
 			return true;
 		}
@@ -174,7 +291,7 @@ bool Camera::checkWallCollision(glm::vec3 unitDirection, GLfloat speed)
 
 	else if (projectionTileX != currentTileX)
 	{
-		if (levelArray[currentTileZ][projectionTileX] == 1) {
+		if (grid->isWall(projectionTileX, currentTileZ)) {
 			return true;
 		}
 	}
@@ -191,12 +308,19 @@ bool Camera::checkWallCollision(glm::vec3 unitDirection, GLfloat speed)
 *   @param     changeY - Amount of mouse movement in y direction.
 *   @see       update()
 */
-void Camera::mouseControl(GLfloat changeX, GLfloat changeY) 
+void Camera::mouseControl(float changeX, float changeY) 
 {
 	changeX *= turnSpeed;
 	changeY *= turnSpeed;
 
-	yaw += changeX;
+	if (fixedPoint)
+	{
+		fixedYaw = FixedPoint::wrapDegrees(fixedYaw + FixedPoint::fromFloat(changeX));
+	}
+	else
+	{
+		yaw += changeX;
+	}
 	pitch += changeY;
 
 	if (pitch > 89.0f) 
@@ -209,6 +333,11 @@ void Camera::mouseControl(GLfloat changeX, GLfloat changeY)
 		pitch = -89.0f;
 	}
 
+	if (fixedPoint)
+	{
+		updateFixed();
+		return;
+	}
 	update();
 }
 
@@ -241,7 +370,7 @@ glm::vec3 Camera::getCameraDirection()
 glm::mat4 Camera::calculateViewMatrix() 
 {
 	//can place an object to lookAt where "position + front" is. Third-person view
-	return glm::lookAt(position, position + front, up);
+	return glm::lookAt(renderPosition, renderPosition + front, up);
 }
 
 /**
@@ -272,24 +401,12 @@ void Camera::update()
 }
 
 /**
-*   Draws the minimap Pacman on the minimap. Takes in the projection and shader from the Game class.
-* 
-*	@param projection	-	The projection matrix from the Game class.
-*	@param shader		-	The shader object from the Game class.
-* 
-*	@see useShader(), useTexture(), drawElements().
+*   update() for fixed point: the front the camera moves along is the cosine and sine of the
+*	fixed point yaw, from FixedPoint::sinCos(). The float yaw and vectors follow it for the view.
 */
-void Camera::drawMiniMapPacman(glm::mat4 projection, std::shared_ptr<Shader>& shader) 
+void Camera::updateFixed()
 {
-	shader->useShader();
-
-	glm::mat4 model(1.0f);
-	glm::vec3 pacmanMiniMapPosition = position + glm::vec3(-1.0f, 2.0f, -1.0f);
-	model = glm::translate(model, glm::vec3(pacmanMiniMapPosition));
-
-	glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, glm::value_ptr(projection));
-	glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(model));
-
-	miniMapPacmanMat->useTexture();
-	miniMapPacmanRenderer->drawElements(miniMapPacmanVAO, miniMapPacmanIBO);
+	FixedPoint::sinCos(fixedYaw, fixedFrontZ, fixedFrontX);
+	yaw = FixedPoint::toFloat(fixedYaw);
+	update();
 }
@@ -0,0 +1,453 @@
+#include "ClusterGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+/**
+*  ClusterGraph finds the entrances between the clusters of a level and the walks between them
+*  once, so ghosts on huge levels can plan a path with a search over a few nodes per cluster.
+*
+*  @name ClusterGraph.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+namespace
+{
+	const uint32_t FAR = 0xffffffffu; // not reachable inside the cluster.
+
+	/* Search state of one thread: the tiles of the start and the target cluster, and the nodes
+	   of the graph. A node belongs to the current search when its stamp is the generation. */
+	struct ClusterScratch
+	{
+		std::vector<uint32_t> startDistances;
+		std::vector<uint8_t> startSteps;
+		std::vector<uint32_t> targetDistances;
+		std::vector<uint8_t> targetSteps;
+		std::vector<int> queue;
+
+		std::vector<uint32_t> stamps;
+		std::vector<uint32_t> costs;
+		std::vector<uint8_t> firstSteps;
+		std::vector<uint64_t> open;		// f << 32 | node, a min heap.
+		uint32_t generation = 0;
+	};
+
+	thread_local ClusterScratch scratch;
+}
+
+/**
+*   Builds the graph: entrances on every border between two clusters, then the walks between
+*	the nodes of each cluster. The clusters are independent, with a JobSystem they are searched
+*	in parallel.
+*
+*   @param levelGrid - The level, has to outlive the graph.
+*   @param jobSystem - Builds the clusters in parallel, may be null.
+*/
+ClusterGraph::ClusterGraph(const LevelGrid& levelGrid, JobSystem* jobSystem)
+	: grid(&levelGrid), tilesX(levelGrid.getTilesX()), tilesZ(levelGrid.getTilesZ()),
+	clustersX((levelGrid.getTilesX() + CLUSTER_SIZE - 1) / CLUSTER_SIZE), clustersZ((levelGrid.getTilesZ() + CLUSTER_SIZE - 1) / CLUSTER_SIZE)
+{
+	PROFILE_SCOPE("ClusterGraph::build");
+
+	// steps across a border, as the tiles on both sides.
+	std::vector<std::pair<int, int>> steps;
+	for (int cz = 0; cz < clustersZ; cz++)
+	{
+		int z = cz * CLUSTER_SIZE;
+		int rows = std::min(CLUSTER_SIZE, tilesZ - z);
+		for (int cx = 0; cx < clustersX; cx++)
+		{
+			int x = cx * CLUSTER_SIZE;
+			int columns = std::min(CLUSTER_SIZE, tilesX - x);
+
+			if (cx + 1 < clustersX) // right border.
+			{
+				addEntrances(steps, z * tilesX + x + columns - 1, z * tilesX + x + columns, tilesX, rows);
+			}
+			else if (clustersX > 1) // the tunnel to the first column.
+			{
+				addEntrances(steps, z * tilesX + tilesX - 1, z * tilesX, tilesX, rows);
+			}
+			if (cz + 1 < clustersZ) // bottom border.
+			{
+				addEntrances(steps, (z + rows - 1) * tilesX + x, (z + rows) * tilesX + x, 1, columns);
+			}
+		}
+	}
+
+	std::vector<int> nodeTiles;
+	for (const std::pair<int, int>& step : steps)
+	{
+		nodeTiles.push_back(step.first);
+		nodeTiles.push_back(step.second);
+	}
+	std::sort(nodeTiles.begin(), nodeTiles.end(), [this](int a, int b)
+	{
+		return clusterOf(a) != clusterOf(b) ? clusterOf(a) < clusterOf(b) : a < b;
+	});
+	nodeTiles.erase(std::unique(nodeTiles.begin(), nodeTiles.end()), nodeTiles.end());
+
+	int clusters = clustersX * clustersZ;
+	clusterNodes.assign(clusters + 1, 0);
+	nodes.reserve(nodeTiles.size());
+	for (int tile : nodeTiles)
+	{
+		nodes.push_back({ tile, clusterOf(tile), 0, 0 });
+		clusterNodes[clusterOf(tile) + 1]++;
+	}
+	for (int c = 0; c < clusters; c++)
+	{
+		clusterNodes[c + 1] += clusterNodes[c];
+	}
+
+	// walks inside each cluster, every cluster only writes the lists of its own nodes.
+	std::vector<std::vector<ClusterEdge>> adjacent(nodes.size());
+	auto connectClusters = [this, &adjacent](int begin, int end)
+	{
+		std::vector<uint32_t> distances;
+		std::vector<uint8_t> firstSteps;
+		std::vector<int> queue;
+		for (int c = begin; c < end; c++)
+		{
+			for (int from = clusterNodes[c]; from < clusterNodes[c + 1]; from++)
+			{
+				searchCluster(nodes[from].tile, 0, distances, firstSteps, queue);
+				for (int to = clusterNodes[c]; to < clusterNodes[c + 1]; to++)
+				{
+					uint32_t distance = distances[localIndex(nodes[to].tile)];
+					if (to != from && distance != FAR)
+					{
+						adjacent[from].push_back({ to, distance });
+					}
+				}
+			}
+		}
+	};
+	if (jobSystem != nullptr)
+	{
+		jobSystem->parallelFor(clusters, connectClusters);
+	}
+	else
+	{
+		connectClusters(0, clusters);
+	}
+
+	for (const std::pair<int, int>& step : steps)
+	{
+		int a = findNode(step.first);
+		int b = findNode(step.second);
+		adjacent[a].push_back({ b, 1 });
+		adjacent[b].push_back({ a, 1 });
+	}
+
+	for (size_t node = 0; node < nodes.size(); node++)
+	{
+		nodes[node].edgeBegin = static_cast<int>(edges.size());
+		edges.insert(edges.end(), adjacent[node].begin(), adjacent[node].end());
+		nodes[node].edgeEnd = static_cast<int>(edges.size());
+	}
+}
+
+/**
+*   Finds the openings along one border and puts entrances in them. An opening is a run of
+*	tiles that are open on both sides. Narrow ones get one entrance in the middle, wide ones
+*	one at each end.
+*
+*   @param steps  - Gets the entrances added, as the tiles on both sides.
+*   @param firstA - First tile on one side of the border.
+*   @param firstB - The tile across from it.
+*   @param along  - Step from one tile of the border to the next, 1 or tilesX.
+*   @param count  - Tiles along the border.
+*/
+void ClusterGraph::addEntrances(std::vector<std::pair<int, int>>& steps, int firstA, int firstB, int along, int count) const
+{
+	int runStart = -1;
+	for (int i = 0; i <= count; i++)
+	{
+		bool open = false;
+		if (i < count)
+		{
+			int a = firstA + i * along;
+			int b = firstB + i * along;
+			open = !grid->isWall(a % tilesX, a / tilesX) && !grid->isWall(b % tilesX, b / tilesX);
+		}
+
+		if (open && runStart < 0)
+		{
+			runStart = i;
+		}
+		else if (!open && runStart >= 0)
+		{
+			int runEnd = i - 1;
+			if (runEnd - runStart + 1 >= WIDE_ENTRANCE)
+			{
+				steps.push_back({ firstA + runStart * along, firstB + runStart * along });
+				steps.push_back({ firstA + runEnd * along, firstB + runEnd * along });
+			}
+			else
+			{
+				int middle = (runStart + runEnd) / 2;
+				steps.push_back({ firstA + middle * along, firstB + middle * along });
+			}
+			runStart = -1;
+		}
+	}
+}
+
+/**
+*   Index of a tile within its cluster.
+*
+*   @param tile - Row major index.
+*
+*	@return int - row * CLUSTER_SIZE + column inside the cluster.
+*/
+int ClusterGraph::localIndex(int tile) const
+{
+	return (tile / tilesX) % CLUSTER_SIZE * CLUSTER_SIZE + (tile % tilesX) % CLUSTER_SIZE;
+}
+
+/**
+*   Node on a tile.
+*
+*   @param tile - Row major index.
+*
+*	@return int - index in getNodes(), -1 if the tile is no node.
+*/
+int ClusterGraph::findNode(int tile) const
+{
+	int cluster = clusterOf(tile);
+	auto begin = nodes.begin() + clusterNodes[cluster];
+	auto end = nodes.begin() + clusterNodes[cluster + 1];
+	auto found = std::lower_bound(begin, end, tile, [](const ClusterNode& node, int value) { return node.tile < value; });
+	return found != end && found->tile == tile ? static_cast<int>(found - nodes.begin()) : -1;
+}
+
+/**
+*   Breadth first search from a tile that stays inside its cluster.
+*
+*   @param tile       - Where the search starts.
+*   @param forbidden  - LevelGrid::OPEN_* bits the first step may not take.
+*   @param distances  - Gets the steps to every tile of the cluster by localIndex(), FAR where it can't get.
+*   @param firstSteps - Gets the GhostDirection of the first step towards every tile.
+*   @param queue      - Scratch space.
+*/
+void ClusterGraph::searchCluster(int tile, uint8_t forbidden, std::vector<uint32_t>& distances, std::vector<uint8_t>& firstSteps, std::vector<int>& queue) const
+{
+	int cluster = clusterOf(tile);
+	int left = cluster % clustersX * CLUSTER_SIZE;
+	int top = cluster / clustersX * CLUSTER_SIZE;
+
+	distances.assign(CLUSTER_SIZE * CLUSTER_SIZE, FAR);
+	firstSteps.assign(CLUSTER_SIZE * CLUSTER_SIZE, GHOST_NONE);
+	queue.clear();
+	queue.push_back(tile);
+	distances[localIndex(tile)] = 0;
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int current = queue[head];
+		int x = current % tilesX;
+		int z = current / tilesX;
+		uint32_t distance = distances[localIndex(current)];
+		uint8_t open = grid->openNeighbours(x, z);
+		if (current == tile)
+		{
+			open &= static_cast<uint8_t>(~forbidden);
+		}
+
+		for (uint8_t direction = GHOST_UP; direction <= GHOST_RIGHT; direction++)
+		{
+			if ((open & JunctionGraph::openBit(direction)) == 0)
+			{
+				continue;
+			}
+
+			int nextX = x;
+			int nextZ = z;
+			switch (direction)
+			{
+			case GHOST_UP:		nextZ--; break;
+			case GHOST_DOWN:	nextZ++; break;
+			case GHOST_LEFT:	nextX = x == 0 ? tilesX - 1 : x - 1; break;
+			default:			nextX = x == tilesX - 1 ? 0 : x + 1; break;
+			}
+			if (nextX < left || nextX >= left + CLUSTER_SIZE || nextZ < top || nextZ >= top + CLUSTER_SIZE)
+			{
+				continue; // outside the cluster.
+			}
+
+			int next = nextZ * tilesX + nextX;
+			int index = localIndex(next);
+			if (distances[index] == FAR)
+			{
+				distances[index] = distance + 1;
+				firstSteps[index] = current == tile ? direction : firstSteps[localIndex(current)];
+				queue.push_back(next);
+			}
+		}
+	}
+}
+
+/**
+*   Lower bound of the steps between two tiles, the same as the one of PathPlanner. The walks
+*	inside a cluster and the steps across borders are never shorter, so the search over the
+*	nodes never has to open a node twice.
+*
+*   @param fromTile - Row major index.
+*   @param toTile   - Row major index.
+*
+*	@return int - steps.
+*/
+int ClusterGraph::heuristic(int fromTile, int toTile) const
+{
+	int dx = std::abs(fromTile % tilesX - toTile % tilesX);
+	int dz = std::abs(fromTile / tilesX - toTile / tilesX);
+	return std::min(dx, tilesX - dx) + dz;
+}
+
+/**
+*   Direction of the step between two neighbouring tiles.
+*
+*   @param fromTile - Row major index.
+*   @param toTile   - A neighbour of it, through the tunnel too.
+*
+*	@return uint8_t - a GhostDirection.
+*/
+uint8_t ClusterGraph::directionTo(int fromTile, int toTile) const
+{
+	if (toTile == fromTile - tilesX) { return GHOST_UP; }
+	if (toTile == fromTile + tilesX) { return GHOST_DOWN; }
+	return (fromTile % tilesX + 1) % tilesX == toTile % tilesX ? GHOST_RIGHT : GHOST_LEFT;
+}
+
+/**
+*   Searches a path. The start cluster is searched tile by tile for the way to each of its
+*	nodes, the target cluster for the way from each of its nodes to the target. A* over the
+*	nodes then joins the two, a target in the start cluster can also be reached directly.
+*
+*   @param pathRequest - Where from and where to, the heading is kept to on the first step.
+*   @param expanded    - Gets the number of tiles and nodes the search expanded added.
+*
+*	@return PathResult - the first step and the length of the path found.
+*/
+PathResult ClusterGraph::solve(const PathRequest& pathRequest, unsigned long long& expanded) const
+{
+	PathResult result = { pathRequest.ghost, pathRequest.fromTile, GHOST_NONE, -1 };
+	int tiles = tilesX * tilesZ;
+	int start = pathRequest.fromTile;
+	int target = pathRequest.targetTile;
+	if (start < 0 || target < 0 || start >= tiles || target >= tiles)
+	{
+		return result;
+	}
+	if (start == target)
+	{
+		result.length = 0;
+		return result;
+	}
+
+	ClusterScratch& search = scratch;
+	uint8_t forbidden = JunctionGraph::openBit(JunctionGraph::reverse(pathRequest.heading));
+	searchCluster(start, forbidden, search.startDistances, search.startSteps, search.queue);
+	expanded += search.queue.size();
+	searchCluster(target, 0, search.targetDistances, search.targetSteps, search.queue);
+	expanded += search.queue.size();
+
+	// one more slot than there are nodes: the target.
+	int goal = static_cast<int>(nodes.size());
+	if (search.stamps.size() < nodes.size() + 1)
+	{
+		search.stamps.assign(nodes.size() + 1, 0);
+		search.costs.resize(nodes.size() + 1);
+		search.firstSteps.resize(nodes.size() + 1);
+		search.generation = 0;
+	}
+	if (++search.generation == 0) // wrapped, old stamps could match again.
+	{
+		std::fill(search.stamps.begin(), search.stamps.end(), 0);
+		search.generation = 1;
+	}
+	uint32_t generation = search.generation;
+	std::vector<uint64_t>& open = search.open;
+	open.clear();
+
+	auto relax = [&](int node, uint32_t cost, uint8_t firstStep)
+	{
+		if (search.stamps[node] == generation && search.costs[node] <= cost)
+		{
+			return;
+		}
+		search.stamps[node] = generation;
+		search.costs[node] = cost;
+		search.firstSteps[node] = firstStep;
+		uint32_t estimate = node == goal ? 0 : static_cast<uint32_t>(heuristic(nodes[node].tile, target));
+		open.push_back(static_cast<uint64_t>(cost + estimate) << 32 | static_cast<uint32_t>(node));
+		std::push_heap(open.begin(), open.end(), std::greater<uint64_t>());
+	};
+
+	int startCluster = clusterOf(start);
+	int targetCluster = clusterOf(target);
+	if (startCluster == targetCluster && search.startDistances[localIndex(target)] != FAR)
+	{
+		relax(goal, search.startDistances[localIndex(target)], search.startSteps[localIndex(target)]);
+	}
+
+	for (int node = clusterNodes[startCluster]; node < clusterNodes[startCluster + 1]; node++)
+	{
+		uint32_t distance = search.startDistances[localIndex(nodes[node].tile)];
+		if (distance != FAR && distance > 0)
+		{
+			relax(node, distance, search.startSteps[localIndex(nodes[node].tile)]);
+		}
+		else if (distance == 0) // the start is a node, its steps across the border are first steps too.
+		{
+			for (int edge = nodes[node].edgeBegin; edge < nodes[node].edgeEnd; edge++)
+			{
+				const ClusterNode& across = nodes[edges[edge].to];
+				uint8_t direction = directionTo(start, across.tile);
+				if (across.cluster != startCluster && (JunctionGraph::openBit(direction) & forbidden) == 0)
+				{
+					relax(edges[edge].to, 1, direction);
+				}
+			}
+		}
+	}
+
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		uint64_t entry = open.back();
+		open.pop_back();
+
+		int node = static_cast<int>(entry & 0xffffffffu);
+		uint32_t cost = search.costs[node];
+		uint32_t estimate = node == goal ? 0 : static_cast<uint32_t>(heuristic(nodes[node].tile, target));
+		if ((entry >> 32) != cost + estimate)
+		{
+			continue; // a shorter way to the node was found after this entry was pushed.
+		}
+		if (node == goal)
+		{
+			result.direction = search.firstSteps[goal];
+			result.length = static_cast<int>(cost);
+			break;
+		}
+		expanded++;
+
+		uint8_t firstStep = search.firstSteps[node];
+		if (nodes[node].cluster == targetCluster)
+		{
+			uint32_t distance = search.targetDistances[localIndex(nodes[node].tile)];
+			if (distance != FAR)
+			{
+				relax(goal, cost + distance, firstStep);
+			}
+		}
+		for (int edge = nodes[node].edgeBegin; edge < nodes[node].edgeEnd; edge++)
+		{
+			relax(edges[edge].to, cost + edges[edge].cost, firstStep);
+		}
+	}
+	return result;
+}
@@ -0,0 +1,79 @@
+#include "CounterRandom.h"
+
+/**
+*  CounterRandom hashes a (seed, stream, counter) triple into a random number with the SplitMix64
+*  finalizer. It replaces seeding a std::mt19937 from the clock for every random choice, which
+*  was slow and made games impossible to reproduce.
+*
+*  @name CounterRandom.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Constructor for a random stream.
+*
+*   @param seed   - Seed of the world the stream belongs to.
+*   @param stream - Which entity in the world is drawing, every entity gets different numbers.
+*/
+CounterRandom::CounterRandom(uint64_t seed, uint64_t stream)
+	: seed(seed), stream(stream), counter(0)
+{
+
+}
+
+/**
+*   SplitMix64 finalizer, every input bit affects every output bit.
+*/
+static uint64_t mix(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/**
+*   The random number for one position in one stream.
+*
+*   @param seed    - Seed of the world.
+*   @param stream  - Entity in the world.
+*   @param counter - How many numbers the entity has drawn before.
+*
+*   @return uint64_t - 64 random bits.
+*/
+uint64_t CounterRandom::hash(uint64_t seed, uint64_t stream, uint64_t counter)
+{
+	return mix(mix(seed ^ (stream * 0x9E3779B97F4A7C15ull)) + counter * 0xD1B54A32D192ED03ull);
+}
+
+/**
+*   Maps a position in a stream to a number between 0 and highestNumber (both included).
+*
+*   @return int - the number, 0 if highestNumber is 0 or less.
+*/
+int CounterRandom::uniformInt(uint64_t seed, uint64_t stream, uint64_t counter, int highestNumber)
+{
+	if (highestNumber <= 0)
+	{
+		return 0;
+	}
+
+	// multiply-shift instead of modulo, no division and no bias worth mentioning for small ranges.
+	uint64_t bits = hash(seed, stream, counter) >> 32;
+	return static_cast<int>((bits * (static_cast<uint64_t>(highestNumber) + 1)) >> 32);
+}
+
+/**
+*   Next 64 random bits in the stream.
+*/
+uint64_t CounterRandom::next()
+{
+	return hash(seed, stream, counter++);
+}
+
+/**
+*   Next number between 0 and highestNumber (both included) in the stream.
+*/
+int CounterRandom::nextInt(int highestNumber)
+{
+	return uniformInt(seed, stream, counter++, highestNumber);
+}
@@ -0,0 +1,215 @@
+#include "DrawList.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+*  DrawList does the CPU side of rendering ahead of the OpenGL calls: visibility, model matrices
+*  and draw order. Every object writes to its own slots, so slices of objects can be built on
+*  different threads without locks, and the result is the same however it was split.
+*
+*  @name DrawList.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const float GHOST_RADIUS = 1.2f; // bounding sphere of the ghost model, bobbing included.
+
+/**
+*   Constructor for an empty draw list.
+*/
+DrawList::DrawList()
+	: culled(0)
+{
+	for (size_t& begin : passBegin)
+	{
+		begin = 0;
+	}
+}
+
+/**
+*   Builds the model matrix of a ghost. The ghost bobs up and down and is turned
+*	towards the direction it is moving.
+*
+*   @param position  - Where the ghost is drawn.
+*   @param direction - GhostDirection the ghost is moving in.
+*
+*	@return glm::mat4 - model matrix for the ghost.
+*/
+glm::mat4 DrawList::ghostModelMatrix(glm::vec3 position, uint8_t direction)
+{
+	float ghostY = position.y + glm::sin(position.x + position.z) * 0.2f; // bobbing effect on ghost.
+	glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(position.x, ghostY, position.z));
+
+	float angle = 0.0f;
+	if (direction == GHOST_UP) { angle = 180.0f; };
+	if (direction == GHOST_DOWN) { angle = 0.0f; }; // turning the ghosts.
+	if (direction == GHOST_LEFT) { angle = 270.0f; };
+	if (direction == GHOST_RIGHT) { angle = 90.0f; };
+
+	return glm::rotate(model, glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+/**
+*   Packs what the list is sorted by into one number: pass first, then mesh so state changes are
+*	grouped, then distance so nearer objects are drawn first, then entity to keep the order stable.
+*
+*   @param pass   - DrawPass of the item.
+*   @param mesh   - DrawMesh of the item.
+*   @param depth  - Distance from the viewer, negative values count as 0.
+*   @param entity - Index of the object.
+*
+*	@return uint64_t - the sort key.
+*/
+uint64_t DrawList::makeSortKey(uint8_t pass, uint8_t mesh, float depth, uint32_t entity)
+{
+	if (!(depth > 0.0f))
+	{
+		depth = 0.0f;
+	}
+
+	uint32_t depthBits;
+	std::memcpy(&depthBits, &depth, sizeof(depthBits)); // positive floats order the same as their bits.
+
+	return (static_cast<uint64_t>(pass) << 56) | (static_cast<uint64_t>(mesh) << 48)
+		| (static_cast<uint64_t>(depthBits) << 16) | (entity & 0xffff);
+}
+
+/**
+*   Gets the six planes of a view frustum (left, right, bottom, top, near, far) from a
+*	view-projection matrix. The normals point into the frustum.
+*
+*   @param viewProjection - Projection times view.
+*   @param planes         - Gets the six planes as (normal, distance).
+*/
+void DrawList::extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4* planes)
+{
+	glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+
+	for (int i = 0; i < 6; i++)
+	{
+		float length = glm::length(glm::vec3(planes[i]));
+		if (length > 0.0f)
+		{
+			planes[i] /= length;
+		}
+	}
+}
+
+/**
+*   Tests a bounding sphere against a frustum.
+*
+*   @param planes - The six planes from extractFrustumPlanes().
+*   @param center - Center of the sphere.
+*   @param radius - Radius of the sphere.
+*
+*	@return bool - false only if the sphere is completely outside.
+*/
+bool DrawList::sphereVisible(const glm::vec4* planes, glm::vec3 center, float radius)
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+*   Fills the scene and minimap slots of one ghost.
+*
+*   @param ghosts        - The ghosts.
+*   @param index         - Index of the ghost.
+*   @param scenePlanes   - Frustum of the main view.
+*   @param minimapPlanes - Frustum of the minimap.
+*   @param eye           - Position of the viewer.
+*   @param ghostCount    - Number of ghosts, the minimap slots start after the scene slots.
+*/
+void DrawList::buildGhost(const GhostStore& ghosts, uint32_t index, const glm::vec4* scenePlanes, const glm::vec4* minimapPlanes, glm::vec3 eye, size_t ghostCount)
+{
+	glm::vec3 center = ghosts.getRenderPosition(index);
+	glm::mat4 model = ghostModelMatrix(center, ghosts.getDirection(index));
+	float depth = glm::distance(eye, center);
+
+	DrawItem& scene = items[index];
+	scene.model = model;
+	scene.entity = index;
+	scene.pass = DRAW_PASS_SCENE;
+	scene.mesh = DRAW_MESH_GHOST;
+	scene.visible = sphereVisible(scenePlanes, center, GHOST_RADIUS);
+	scene.sortKey = makeSortKey(scene.pass, scene.mesh, depth, index);
+
+	DrawItem& minimap = items[ghostCount + index];
+	minimap = scene;
+	minimap.pass = DRAW_PASS_MINIMAP;
+	minimap.visible = sphereVisible(minimapPlanes, center, GHOST_RADIUS);
+	minimap.sortKey = makeSortKey(minimap.pass, minimap.mesh, depth, index);
+}
+
+/**
+*   Rebuilds the list from the ghosts: culls them against both views, calculates their model
+*	matrices and sorts the visible ones.
+*
+*   @param ghosts                - The ghosts of the game, positions already interpolated.
+*   @param sceneViewProjection   - Projection times view of the main view.
+*   @param minimapViewProjection - Projection times view of the minimap.
+*   @param eye                   - Position of the camera.
+*   @param jobSystem             - Splits the work when there are many ghosts, may be null.
+*/
+void DrawList::buildGhosts(const GhostStore& ghosts, const glm::mat4& sceneViewProjection,
+	const glm::mat4& minimapViewProjection, glm::vec3 eye, JobSystem* jobSystem)
+{
+	PROFILE_SCOPE("DrawList::buildGhosts");
+
+	glm::vec4 scenePlanes[6];
+	glm::vec4 minimapPlanes[6];
+	extractFrustumPlanes(sceneViewProjection, scenePlanes);
+	extractFrustumPlanes(minimapViewProjection, minimapPlanes);
+
+	size_t ghostCount = static_cast<size_t>(ghosts.size());
+	items.resize(ghostCount * DRAW_PASS_COUNT);
+
+	auto build = [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			buildGhost(ghosts, static_cast<uint32_t>(i), scenePlanes, minimapPlanes, eye, ghostCount);
+		}
+	};
+
+	if (jobSystem != nullptr && ghostCount >= PARALLEL_ITEMS)
+	{
+		jobSystem->parallelFor(static_cast<int>(ghostCount), build);
+	}
+	else
+	{
+		build(0, static_cast<int>(ghostCount));
+	}
+
+	size_t total = items.size();
+	items.erase(std::remove_if(items.begin(), items.end(), [](const DrawItem& item) { return !item.visible; }), items.end());
+	culled = total - items.size();
+
+	std::sort(items.begin(), items.end(), [](const DrawItem& a, const DrawItem& b) { return a.sortKey < b.sortKey; });
+
+	size_t item = 0;
+	for (int pass = 0; pass <= DRAW_PASS_COUNT; pass++)
+	{
+		while (item < items.size() && items[item].pass < pass)
+		{
+			item++;
+		}
+		passBegin[pass] = pass == DRAW_PASS_COUNT ? items.size() : item;
+	}
+}
@@ -0,0 +1,74 @@
+#include "FixedPoint.h"
+
+/**
+*  FixedPoint works out sines and cosines with integers only, see FixedPoint.h. The rest of it is
+*  inline in the header.
+*
+*  @name FixedPoint.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const int ROTATIONS = 23;
+
+// atan(2^-i) in 16.16 degrees, the angles CORDIC rotates by.
+static const int32_t rotationAngles[ROTATIONS] = {
+	2949120, 1740967, 919879, 466945, 234379, 117304, 58666, 29335, 14668, 7334, 3667, 1833,
+	917, 458, 229, 115, 57, 29, 14, 7, 4, 2, 1
+};
+
+static const int VECTOR_BITS = 30;				// fraction bits of the rotated vector.
+static const int32_t CORDIC_GAIN = 652032874;	// 1 / the length every rotation adds, in 2.30.
+
+/**
+*   Sine and cosine of an angle with CORDIC: a vector is rotated towards the angle by smaller and
+*	smaller steps of shifts and adds. Within a few units of the last bit of the exact values,
+*	and the same bits everywhere.
+*
+*   @param degrees - The angle, in degrees, any value.
+*   @param sine    - Gets the sine.
+*   @param cosine  - Gets the cosine.
+*/
+void FixedPoint::sinCos(int32_t degrees, int32_t& sine, int32_t& cosine)
+{
+	// CORDIC only reaches a bit over 90 degrees either way, the back half is turned around.
+	int32_t angle = wrapDegrees(degrees);
+	bool flipped = false;
+	if (angle > FULL_TURN / 4 * 3)
+	{
+		angle -= FULL_TURN;
+	}
+	else if (angle > FULL_TURN / 4)
+	{
+		angle -= FULL_TURN / 2;
+		flipped = true;
+	}
+
+	int32_t x = CORDIC_GAIN;
+	int32_t y = 0;
+	for (int i = 0; i < ROTATIONS; i++)
+	{
+		int32_t stepX = y >> i;
+		int32_t stepY = x >> i;
+		if (angle >= 0)
+		{
+			x -= stepX;
+			y += stepY;
+			angle -= rotationAngles[i];
+		}
+		else
+		{
+			x += stepX;
+			y -= stepY;
+			angle += rotationAngles[i];
+		}
+	}
+
+	const int shift = VECTOR_BITS - FRACTION_BITS;
+	cosine = (x + (1 << (shift - 1))) >> shift;
+	sine = (y + (1 << (shift - 1))) >> shift;
+	if (flipped)
+	{
+		cosine = -cosine;
+		sine = -sine;
+	}
+}
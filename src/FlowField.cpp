@@ -0,0 +1,169 @@
+#include "FlowField.h"
+
+/**
+*  FlowField holds the distance from every tile to the tile the player is in. Ghosts chasing the
+*  player step to the neighbour closest to it, so they follow the shortest way around the walls
+*  instead of guessing from where the player is.
+*
+*  @name FlowField.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const int stepZ[] = { 0, -1, 1, 0, 0 }; // indexed by GhostDirection.
+
+/**
+*   Constructor for a flow field. Nothing is searched until a target is set.
+*
+*   @param levelGrid - Walls of the level. Must outlive the field.
+*/
+FlowField::FlowField(const LevelGrid& levelGrid)
+	: grid(&levelGrid), tilesX(levelGrid.getTilesX()), tilesZ(levelGrid.getTilesZ()), targetTile(-1), searches(0),
+	distances(static_cast<size_t>(tilesX) * tilesZ, UNREACHABLE)
+{
+
+}
+
+/**
+*   Moves the target, the distances are only searched again when it is in another tile.
+*	Positions outside the level are moved to the nearest edge tile.
+*
+*   @param tileX - Target column.
+*   @param tileZ - Target row.
+*
+*	@return bool - true if the distances were searched again.
+*/
+bool FlowField::setTarget(int tileX, int tileZ)
+{
+	tileX = tileX < 0 ? 0 : tileX >= tilesX ? tilesX - 1 : tileX;
+	tileZ = tileZ < 0 ? 0 : tileZ >= tilesZ ? tilesZ - 1 : tileZ;
+
+	int tile = tileZ * tilesX + tileX;
+	if (tile == targetTile)
+	{
+		return false;
+	}
+	targetTile = tile;
+	search();
+	return true;
+}
+
+/**
+*   Column of the tile next to another one, walking off the left or right edge wraps around.
+*
+*   @param tileX     - Column of the tile.
+*   @param direction - A GhostDirection.
+*
+*	@return int - the column, the same for up and down.
+*/
+int FlowField::neighbourX(int tileX, uint8_t direction) const
+{
+	switch (direction)
+	{
+	case GHOST_LEFT:	return tileX == 0 ? tilesX - 1 : tileX - 1;
+	case GHOST_RIGHT:	return tileX == tilesX - 1 ? 0 : tileX + 1;
+	default:			return tileX;
+	}
+}
+
+/**
+*   Breadth first search out from the target, every open tile gets its number of steps
+*	from it. Runs in time linear in the number of tiles, however many ghosts read it.
+*/
+void FlowField::search()
+{
+	searches++;
+	std::fill(distances.begin(), distances.end(), UNREACHABLE);
+	if (grid->isWall(targetTile % tilesX, targetTile / tilesX))
+	{
+		return;
+	}
+
+	// reused between searches, one per thread. Holds the column and row of every tile, so
+	// nothing has to be divided to find them again.
+	static thread_local std::vector<int> queue;
+	queue.resize(distances.size() * 2);
+
+	size_t head = 0;
+	size_t tail = 0;
+	distances[targetTile] = 0;
+	queue[tail++] = targetTile % tilesX;
+	queue[tail++] = targetTile / tilesX;
+
+	while (head < tail)
+	{
+		int x = queue[head++];
+		int z = queue[head++];
+		uint32_t next = distances[z * tilesX + x] + 1;
+		uint8_t open = grid->openNeighbours(x, z);
+		for (uint8_t direction = GHOST_UP; direction <= GHOST_RIGHT; direction++)
+		{
+			if ((open & (1u << (direction - 1))) == 0)
+			{
+				continue;
+			}
+			int otherX = neighbourX(x, direction);
+			int otherZ = z + stepZ[direction];
+			uint32_t& distance = distances[otherZ * tilesX + otherX];
+			if (distance == UNREACHABLE)
+			{
+				distance = next;
+				queue[tail++] = otherX;
+				queue[tail++] = otherZ;
+			}
+		}
+	}
+}
+
+/**
+*   The way to go from a tile to get closer to the target. Ties go to the first of
+*	up, down, left and right.
+*
+*   @param tileX - Column of the tile.
+*   @param tileZ - Row of the tile.
+*
+*	@return uint8_t - a GhostDirection, GHOST_NONE on the target or where it can't be reached.
+*/
+uint8_t FlowField::bestDirection(int tileX, int tileZ) const
+{
+	if (tileX < 0 || tileZ < 0 || tileX >= tilesX || tileZ >= tilesZ)
+	{
+		return GHOST_NONE;
+	}
+
+	int tile = tileZ * tilesX + tileX;
+	uint32_t best = distances[tile];
+	uint8_t bestDirection = GHOST_NONE;
+	uint8_t open = grid->openNeighbours(tileX, tileZ);
+
+	for (uint8_t direction = GHOST_UP; direction <= GHOST_RIGHT; direction++)
+	{
+		if ((open & (1u << (direction - 1))) == 0)
+		{
+			continue;
+		}
+		int other = (tileZ + stepZ[direction]) * tilesX + neighbourX(tileX, direction);
+		if (distances[other] < best)
+		{
+			best = distances[other];
+			bestDirection = direction;
+		}
+	}
+	return bestDirection;
+}
+
+/**
+*   Steps from a tile to the target.
+*
+*   @param tileX - Column of the tile.
+*   @param tileZ - Row of the tile.
+*
+*	@return uint32_t - the distance, UNREACHABLE for walls, tiles outside the level and closed off tiles.
+*/
+uint32_t FlowField::getDistance(int tileX, int tileZ) const
+{
+	if (tileX < 0 || tileZ < 0 || tileX >= tilesX || tileZ >= tilesZ)
+	{
+		return UNREACHABLE;
+	}
+	return distances[static_cast<size_t>(tileZ) * tilesX + tileX];
+}
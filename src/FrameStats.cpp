@@ -0,0 +1,235 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+/**
+*  FrameStats keeps the numbers needed to talk about stutter instead of average FPS: percentiles
+*  of the frame time, the worst frame and how many frames went over the frame budget.
+*
+*  @name FrameStats.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Constructor for an empty histogram.
+*/
+FrameHistogram::FrameHistogram()
+	: counts(BUCKETS, 0), total(0), sumMs(0.0), maxMs(0.0f)
+{
+
+}
+
+/**
+*   Adds one frame time.
+*
+*   @param ms - Time in milliseconds.
+*/
+void FrameHistogram::add(float ms)
+{
+	if (ms < 0.0f)
+	{
+		ms = 0.0f;
+	}
+
+	int bucket = static_cast<int>(ms / BUCKET_MS);
+	counts[bucket < BUCKETS ? bucket : BUCKETS - 1]++;
+
+	total++;
+	sumMs += ms;
+	maxMs = std::max(maxMs, ms);
+}
+
+/**
+*   The time that p percent of all frames were at or below, accurate to one bucket.
+*
+*   @param p - Percentile between 0 and 100.
+*
+*   @return float - upper edge of the bucket in milliseconds, the maximum for the last bucket.
+*/
+float FrameHistogram::percentile(float p) const
+{
+	if (total == 0)
+	{
+		return 0.0f;
+	}
+
+	unsigned long long rank = static_cast<unsigned long long>(p / 100.0f * (total - 1)) + 1;
+	unsigned long long seen = 0;
+
+	for (int i = 0; i < BUCKETS; i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			return i == BUCKETS - 1 ? maxMs : std::min((i + 1) * BUCKET_MS, maxMs);
+		}
+	}
+	return maxMs;
+}
+
+/**
+*   Constructor for frame statistics.
+*
+*   @param budgetMs     - Frames slower than this count as hitches, one 60 Hz frame by default.
+*   @param recentFrames - How many of the last frames are kept for rolling numbers and the CSV.
+*/
+FrameStats::FrameStats(float budgetMs, size_t recentFrames)
+	: budgetMs(budgetMs), recent(recentFrames > 0 ? recentFrames : 1), sorted(recent.size()), frameCount(0),
+	hitches(0), severeHitches(0), totalTicks(0), totalDrawCalls(0)
+{
+
+}
+
+/**
+*   Adds the numbers of one frame.
+*
+*   @param sample - The frame.
+*/
+void FrameStats::addFrame(const FrameSample& sample)
+{
+	frameTimes.add(sample.frameMs);
+	cpuTimes.add(sample.cpuMs);
+	if (sample.gpuMs > 0.0f)
+	{
+		gpuTimes.add(sample.gpuMs);
+	}
+
+	if (sample.frameMs > budgetMs)
+	{
+		hitches++;
+	}
+	if (sample.frameMs > 2.0f * budgetMs)
+	{
+		severeHitches++;
+	}
+
+	totalTicks += sample.ticks;
+	totalDrawCalls += sample.drawCalls;
+
+	recent[frameCount % recent.size()] = sample;
+	frameCount++;
+}
+
+/**
+*   Percentile of the frame time over the last frames, computed exactly from the ring.
+*
+*   @param frames - How many of the last frames to look at.
+*   @param p      - Percentile between 0 and 100.
+*
+*   @return float - frame time in milliseconds.
+*/
+float FrameStats::rollingPercentile(size_t frames, float p) const
+{
+	size_t count = static_cast<size_t>(std::min<unsigned long long>(std::min(frames, recent.size()), frameCount));
+	if (count == 0)
+	{
+		return 0.0f;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		sorted[i] = recent[(frameCount - 1 - i) % recent.size()].frameMs;
+	}
+
+	size_t rank = static_cast<size_t>(p / 100.0f * (count - 1));
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + count);
+	return sorted[rank];
+}
+
+/**
+*   The slowest frame among the last frames.
+*
+*   @param frames - How many of the last frames to look at.
+*
+*   @return float - frame time in milliseconds.
+*/
+float FrameStats::rollingMax(size_t frames) const
+{
+	return rollingPercentile(frames, 100.0f);
+}
+
+/**
+*   Prints one line with the rolling numbers.
+*
+*   @param out    - Stream to print to.
+*   @param frames - How many of the last frames to look at.
+*/
+void FrameStats::printRolling(std::ostream& out, size_t frames) const
+{
+	char line[160];
+	std::snprintf(line, sizeof(line), "frame ms  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f  hitches %llu\n",
+		rollingPercentile(frames, 50.0f), rollingPercentile(frames, 95.0f), rollingPercentile(frames, 99.0f),
+		rollingMax(frames), hitches);
+	out << line;
+}
+
+/**
+*   Writes the most recent frames, one per row, oldest first.
+*
+*   @param path - File to write.
+*
+*   @return bool - false if the file could not be written.
+*/
+bool FrameStats::writeCsv(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Unable to write frame statistics " << path << '\n';
+		return false;
+	}
+
+	file << "frame,frame_ms,cpu_ms,gpu_ms,ticks,draw_calls\n";
+
+	unsigned long long first = frameCount > recent.size() ? frameCount - recent.size() : 0;
+	char line[128];
+	for (unsigned long long i = first; i < frameCount; i++)
+	{
+		const FrameSample& sample = recent[i % recent.size()];
+		std::snprintf(line, sizeof(line), "%llu,%.3f,%.3f,%.3f,%u,%u\n", i, sample.frameMs, sample.cpuMs, sample.gpuMs,
+			static_cast<unsigned int>(sample.ticks), static_cast<unsigned int>(sample.drawCalls));
+		file << line;
+	}
+	return static_cast<bool>(file);
+}
+
+/**
+*   Writes a summary of the whole session.
+*
+*   @param path - File to write.
+*
+*   @return bool - false if the file could not be written.
+*/
+bool FrameStats::writeJson(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Unable to write frame statistics " << path << '\n';
+		return false;
+	}
+
+	auto histogram = [](const FrameHistogram& h)
+	{
+		char text[256];
+		std::snprintf(text, sizeof(text), "{\"mean\":%.3f,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f,\"count\":%llu}",
+			h.getMean(), h.percentile(50.0f), h.percentile(95.0f), h.percentile(99.0f), h.getMax(), h.getCount());
+		return std::string(text);
+	};
+
+	file << "{\n"
+		<< "  \"label\": \"" << label << "\",\n"
+		<< "  \"frames\": " << frameCount << ",\n"
+		<< "  \"budget_ms\": " << budgetMs << ",\n"
+		<< "  \"hitches\": " << hitches << ",\n"
+		<< "  \"severe_hitches\": " << severeHitches << ",\n"
+		<< "  \"ticks\": " << totalTicks << ",\n"
+		<< "  \"draw_calls_per_frame\": " << (frameCount > 0 ? static_cast<double>(totalDrawCalls) / frameCount : 0.0) << ",\n"
+		<< "  \"frame_ms\": " << histogram(frameTimes) << ",\n"
+		<< "  \"cpu_ms\": " << histogram(cpuTimes) << ",\n"
+		<< "  \"gpu_ms\": " << histogram(gpuTimes) << "\n"
+		<< "}\n";
+	return static_cast<bool>(file);
+}
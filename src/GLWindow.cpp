@@ -17,20 +17,12 @@
 *
 */
 GLWindow::GLWindow() 
-	: bufferWidth(0), bufferHeight(0), initialPos(0),
-	lastPosX(0), lastPosY(0), mainWindow(nullptr)
+	: bufferWidth(0), bufferHeight(0), inputTick(0), mainWindow(nullptr)
 {
 
 	width = 800;
 	height = 600;
 
-	for (size_t i = 0; i < 1024; i++) {
-		keys[i] = 0;
-	}
-
-	changeX = 0.0f;
-	changeY = 0.0f; // VERY IMPORTANT
-
 }
 
 /**
@@ -40,17 +32,10 @@ GLWindow::GLWindow()
 *   @param     wHeight - Height size for window.
 */
 GLWindow::GLWindow(GLint wWidth, GLint wHeight)
+    : bufferWidth(0), bufferHeight(0), inputTick(0), mainWindow(nullptr)
 {
     width = wWidth;
     height = wHeight;
-
-    for (size_t i = 0; i < 1024; i++) 
-    {
-        keys[i] = 0;
-    }
-
-    changeX = 0.0f;
-    changeY = 0.0f; // VERY IMPORTANT
 }
 
 /**
@@ -114,27 +99,6 @@ int GLWindow::initialise()
 
 
 
-/**
-*   This function prints out the frames per second of the window context.
-*   Mostly used for development purposes.
-*/
-void GLWindow::updateFPS() 
-{
-    static float previousSeconds = glfwGetTime();
-    static int frameCount;
-    float currentSeconds = glfwGetTime();
-    float elapsedSeconds = currentSeconds - previousSeconds;
-    
-    if (elapsedSeconds < 0.25f) 
-    {
-        previousSeconds = currentSeconds;
-        float FPS = (float)frameCount / elapsedSeconds; // can not use dynamic or static cast for this.
-        std::cout << "FPS IS : " << 1000/(float)FPS << std::endl; // should lie between 1500-2000.
-        frameCount = 0;
-    }
-    frameCount++;
-}
-
 /**
 *   I/O handler for the keyboard.
 *
@@ -153,14 +117,16 @@ void GLWindow::inputHandler(GLFWwindow* window, int key, int code, int action, i
         glfwSetWindowShouldClose(window, GL_TRUE); // close on escape!
     }
 
-    if (key != 0 && key < 1024) // extended ascii character size.
-    { 
-        if (action == GLFW_PRESS) {
-            myWindow->keys[key] = true;
-        } else if (action == GLFW_RELEASE) {
-           myWindow->keys[key] = false;
-        }
+    if (myWindow->replay) // the recording plays the game, escape still works.
+    {
+        return;
+    }
+
+    if (myWindow->recorder)
+    {
+        myWindow->recorder->recordKey(myWindow->inputTick, key, action);
     }
+    myWindow->input.handleKey(key, action);
 }
 
 /**
@@ -181,18 +147,16 @@ void GLWindow::mouseHandler(GLFWwindow* window, double xPos, double yPos)
 {
     GLWindow* myWindow = static_cast<GLWindow*>(glfwGetWindowUserPointer(window)); // give access to window
 
-    if (myWindow->initialPos) 
+    if (myWindow->replay)
     {
-        myWindow->lastPosX = xPos;
-        myWindow->lastPosY = yPos;
-        myWindow->initialPos = false;
+        return;
     }
 
-    myWindow->changeX = xPos - myWindow->lastPosX;
-    myWindow->changeY = myWindow->lastPosY - yPos; // duplicate line like above would mean that everything is inverted, avoiding this.
-
-    myWindow->lastPosX = xPos;
-    myWindow->lastPosY = yPos;
+    if (myWindow->recorder)
+    {
+        myWindow->recorder->recordMouse(myWindow->inputTick, xPos, yPos);
+    }
+    myWindow->input.handleMouse(xPos, yPos);
 }
 
 /**
@@ -211,9 +175,7 @@ void GLWindow::callback()
 */
 GLfloat GLWindow::getChangeX() 
 {
-    GLfloat theChange = changeX;
-    changeX = 0.0f;
-    return theChange;
+    return input.getChangeX();
 }
 
 /**
@@ -223,9 +185,77 @@ GLfloat GLWindow::getChangeX()
 */
 GLfloat GLWindow::getChangeY() 
 {
-    GLfloat theChange = changeY;
-    changeY = 0.0f;
-    return theChange;
+    return input.getChangeY();
+}
+
+/**
+*   Starts writing all keyboard and mouse input to a recording.
+*
+*   @param     path     - File to record to.
+*   @param     seed     - Seed of the game that is played.
+*   @param     tickRate - Ticks per second of the game that is played.
+*   @param     modes    - InputMode flags of the game that is played.
+*
+*   @return bool - whether the recording could be created.
+*   @see InputRecorder
+*/
+bool GLWindow::startRecording(const std::string& path, uint64_t seed, uint32_t tickRate, uint32_t modes)
+{
+    recorder = std::make_unique<InputRecorder>();
+    if (!recorder->open(path, seed, tickRate, modes, {}))
+    {
+        recorder.reset();
+        return false;
+    }
+    return true;
+}
+
+/**
+*   Plays the input of a recording instead of the keyboard and mouse.
+*
+*   @param     path - Recording to replay.
+*
+*   @return bool - whether the recording could be read.
+*   @see InputReplay
+*/
+bool GLWindow::startReplay(const std::string& path)
+{
+    replay = std::make_unique<InputReplay>();
+    if (!replay->open(path))
+    {
+        replay.reset();
+        return false;
+    }
+    return true;
+}
+
+/**
+*   Called right before a simulation tick runs. When replaying, the input recorded for
+*   that tick is applied now.
+*
+*   @param     tick - The tick that is about to run.
+*/
+void GLWindow::beginTick(uint32_t tick)
+{
+    if (replay)
+    {
+        replay->applyTick(tick, input);
+    }
+}
+
+/**
+*   Tells the window which tick will consume the input that arrives from now on, and writes
+*   the input recorded so far. Called once a frame after the simulation has caught up.
+*
+*   @param     tick - The next tick the simulation will run.
+*/
+void GLWindow::setInputTick(uint32_t tick)
+{
+    inputTick = tick;
+    if (recorder)
+    {
+        recorder->flush();
+    }
 }
 
 /**
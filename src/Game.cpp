@@ -14,13 +14,34 @@
 /**
 *   Constructor game object. This works essentially as "game engine startup" mechanism.
 *
+*   @param ticksPerSecond - How many fixed simulation steps are run per second of game time.
 */
-Game::Game()
-	:projection(0), startingPos(0), levelArrayData(0), deltaTime(0), lastTime(0),
-	time(0), now(0), uniformModel(0), uniformView(0), uniformProjection(0),model(1.0f), 
-	pellets_pos(0), pelletProj(0), pelletView(0)
+Game::Game(int ticksPerSecond)
+	:projection(0), startingPos(0), deltaTime(0), lastTime(0),
+	now(0), accumulator(0), interpolation(0), uniformModel(0), uniformView(0), 
+	uniformProjection(0), model(1.0f), view(1.0f), minimapView(1.0f), pellets_pos(0), pelletProj(0), pelletView(0)
 {
 	numberOfGhosts = 4;
+	pipelined = false;
+	gameOver = false;
+	fixedPoint = false;
+	seed = std::chrono::system_clock::now().time_since_epoch().count(); // a new game every time, unless setSeed() is used.
+	setTickRate(ticksPerSecond);
+}
+
+/**
+*   Sets the rate the simulation is stepped at, independent of the frame rate.
+*
+*   @param ticksPerSecond - Fixed simulation steps per second, values below 1 are clamped to 1.
+*/
+void Game::setTickRate(int ticksPerSecond)
+{
+	if (ticksPerSecond < 1)
+	{
+		ticksPerSecond = 1;
+	}
+	this->ticksPerSecond = ticksPerSecond;
+	tickLength = 1.0f / ticksPerSecond;
 }
 
 /**
@@ -38,6 +59,7 @@ Game::~Game()
 */
 void Game::generateShaders()
 {
+	PROFILE_SCOPE("Game::generateShaders");
 	static const char* vShader = "assets/shaders/lights.vert";
 	static const char* fShader = "assets/shaders/lights.frag";
 
@@ -198,30 +220,34 @@ void Game::generateMinimapMVP()
 /**
 *   Generate the entire game. All objects, all needed functions.
 *
-*   @see - generateShaders(), generateLights(), generateTextures(), getLevelArray(), getBufferWidth(), getBufferHeight().
+*   @see - generateShaders(), generateLights(), generateTextures(), getGrid(), getBufferWidth(), getBufferHeight().
 */
 void Game::generateGame(std::shared_ptr<GLWindow>& mainWindow)
 {
+	PROFILE_SCOPE("Game::generateGame");
 	float offset = mainWindow->getBufferWidth() - mainWindow->getBufferHeight() + 40.0f;
 	
 	generateShaders();
 	generateLights();
 	 
-	map = std::make_unique<Map>(mainWindow);
+	jobSystem = std::make_unique<JobSystem>();
 
-	levelArrayData = map->getLevelArray();
+	map = std::make_unique<Map>(mainWindow, jobSystem.get());
 
-	for (int i = 0; i < numberOfGhosts; i++) 
-	{
-		auto ghost = std::make_unique<Ghost>(levelArrayData, i);
-		ghosts.push_back(std::move(ghost));
-	}
+	levelGrid = map->getGrid();
 
-	pellets = std::make_unique<Pellets>(levelArrayData, mainWindow);
+	simulation = std::make_unique<Simulation>(levelGrid, numberOfGhosts, seed);
+	simulation->setJobSystem(jobSystem.get());
+	simulation->setFixedPoint(fixedPoint);
 
 	startingPos = map->getStartingPosition();
 
-	camera = std::make_shared<Camera>(levelArrayData, startingPos, glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f, 4.0f, 0.03f);
+	camera = simulation->getCamera();
+
+	ghostRenderer = std::make_unique<GhostRenderer>();
+	drawList = std::make_unique<DrawList>();
+	pelletRenderer = std::make_unique<PelletRenderer>(simulation->getPellets());
+	minimapPacman = std::make_unique<MinimapPacman>();
 
 	projection = glm::perspective(glm::radians(45.0f), ((GLfloat)mainWindow->getBufferWidth() / mainWindow->getBufferHeight()), 0.1f, 1200.0f);
 	projectionMinimap = glm::perspective(glm::radians(45.0f), (((GLfloat)mainWindow->getBufferWidth() - offset) / mainWindow->getBufferHeight()), 0.1f, 2000.0f);
@@ -229,6 +255,18 @@ void Game::generateGame(std::shared_ptr<GLWindow>& mainWindow)
 	generateMinimap(mainWindow);
 	generateMVP();
 	generateMinimapMVP();
+	subscribeEvents(mainWindow);
+
+	if (pipelined) // the thread steps its own simulation, the one above only shows its snapshots.
+	{
+		auto stepped = std::make_unique<Simulation>(levelGrid, numberOfGhosts, seed);
+		stepped->setJobSystem(jobSystem.get());
+		stepped->setFixedPoint(fixedPoint);
+		simulationThread = std::make_unique<SimulationThread>(std::move(stepped), tickLength);
+		simulationThread->start();
+	}
+
+	lastTime = glfwGetTime(); // don't count the loading time as the first frame.
 }
 
 /**
@@ -243,7 +281,7 @@ void Game::updateLights()
 	shader->setPointLights(pointLights, 5);
 
 	shader->setSpotLights(spotLights, 1);
-	lowerLight = camera->getCameraPosition();
+	lowerLight = camera->getRenderPosition();
 	lowerLight.y -= 0.1f; // Offsets the flashlight
 	spotLights[0].setFlash(lowerLight, camera->getCameraDirection());
 }
@@ -260,7 +298,7 @@ void Game::updateMVP()
 	uniformProjection = shader->getProjectionLocation();
 	uniformView = shader->getViewLocation();
 	glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, glm::value_ptr(projection));
-	glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(camera->calculateViewMatrix()));
+	glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(view));
 	glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(model));
 }
 
@@ -276,14 +314,14 @@ void Game::updateMinimapMVP()
 	uniformProjection = shader->getProjectionLocation();
 	uniformView = shader->getViewLocation();
 	glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, glm::value_ptr(projectionMinimap));
-	glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(camera->calculateMinimapView()));
+	glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(minimapView));
 	glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(model));
 }
 
 /**
-*	
-*	Checks for the collision of the pellets within certain time intervals.
-*	
+*   Measures how much real time has passed since the previous frame.
+*	The frame time is clamped so a long stall (window drag, breakpoint) does not
+*	make the simulation try to catch up with hundreds of ticks at once.
 */
 void Game::updateTime()
 {
@@ -291,49 +329,47 @@ void Game::updateTime()
 	deltaTime = now - lastTime;
 	lastTime = now;
 
-	time += deltaTime;
-	if (time > 0.2)
+	if (deltaTime > 0.25f)
 	{
-		pellets->checkPelletsCollision(camera->getCameraPosition());
-		time = 0;
+		deltaTime = 0.25f;
 	}
 }
 
 /**
-*   Updating the minimap as long as the window is open.
+*   Updating the minimap as long as the window is open. This only draws, the
+*	simulation has already been stepped in updateSimulation().
 * 
-*   @see  bind(), enableDepth, clear(), useShader(), updateMinimapMVP(), updateTime(), 
-*		  updateLights(), drawMinimap(), getCameraPosition(), drawMinimapPacman(), unbind(), 
-*		  move(), disableDepth(), bindTBO(), drawArrays()
+*   @see  bind(), enableDepth, clear(), useShader(), updateMinimapMVP(), drawMinimap(),
+*		  drawMinimapPacman(), unbind(), disableDepth(), bindTBO(), drawArrays()
 * 
 */
 void Game::updateMinimap()
 {
-	frameBuffer->bind();
+	PROFILE_SCOPE("Game::updateMinimap");
+	{
+		GPU_PROFILE_SCOPE("minimap");
+		frameBuffer->bind();
 
-	renderer->enableDepth(); // enable depth testing (is disabled for rendering view quad)
-	renderer->clear(0.0f, 0.0f, 0.0f, 1.0f);
+		renderer->enableDepth(); // enable depth testing (is disabled for rendering view quad)
+		renderer->clear(0.0f, 0.0f, 0.0f, 1.0f);
 
-	minimapShader->useShader();
+		minimapShader->useShader();
 
-	updateMinimapMVP();
-	updateTime();
+		updateMinimapMVP();
 
-	map->drawMinimap(model, projectionMinimap, camera, minimapShader);
+		map->drawMinimap(model, projectionMinimap, camera, minimapShader);
 
-	for (int i = 0; i < numberOfGhosts; i++)
-	{
-		ghosts[i]->move(deltaTime, camera->getCameraPosition());
-		ghosts[i]->drawMinimap(camera, shader, model, projectionMinimap);
-	}
-	camera->drawMiniMapPacman(projectionMinimap, minimapShader);
+		ghostRenderer->draw(*drawList, DRAW_PASS_MINIMAP, shader, minimapView, projectionMinimap);
+		minimapPacman->draw(camera, projectionMinimap, minimapShader);
 
-	pelletMinimapShader->useShader();
+		pelletMinimapShader->useShader();
 
-	pellets->drawMinimap(camera, pelletMinimapShader, projectionMinimap);
+		pelletRenderer->drawMinimap(camera, pelletMinimapShader, projectionMinimap);
 
-	frameBuffer->unbind();
+		frameBuffer->unbind();
+	}
 
+	GPU_PROFILE_SCOPE("minimap composite");
 	renderer->disableDepth(); // disable depth test so view quad isn't discarded due to depth test.
 	
 	screenShader->useShader();
@@ -342,27 +378,34 @@ void Game::updateMinimap()
 }
 
 /**
-*   Updating the game as long as the window is open.
-*	Function handles all event updating.
+*   Advances the game by exactly one fixed tick. Input is consumed, the player and
+*	ghosts are moved and all collisions are resolved here, nothing is drawn. The events
+*	of the tick are kept until the end of the frame.
 *
-*   @param mainWindow - Current open window.
-*   @see   useShader(), updateMVP(), updateTime(), keyControls(), mouseControl(), updateLights(),
-*		   retrieveKeys(), toggleFlashLight(), clear(), enableDepth(), draw(), checkCameraCollision(),
-*		   closeWindow(), getViewLocation(), getProjectionLocation(), calculateViewMatrix(),
-*		   setDirectionalLight(), setSpotLights(), allPelletsEaten(), closeWindow(), updateMinimap().
+*   @param mainWindow - Current open window, used for input.
+*   @see   retrieveKeys(), toggleFlashLight(), Simulation::update(), dispatchEvents().
 */
-void Game::updateGame(std::shared_ptr<GLWindow>& mainWindow)
+void Game::updateSimulation(std::shared_ptr<GLWindow>& mainWindow)
 {
-	shader->useShader();
-	updateMVP();
+	PROFILE_SCOPE("Game::updateSimulation");
+	updateFlashLight(mainWindow);
 
-	updateTime();
-	camera->keyControls(mainWindow->retrieveKeys(), deltaTime);
-	camera->mouseControl(mainWindow->getChangeX(), mainWindow->getChangeY());
+	if (simulation->getStatus() != GameStatus::RUNNING)
+	{
+		return;
+	}
 
-	updateLights();
+	simulation->update(mainWindow->retrieveKeys(), mainWindow->getChangeX(), mainWindow->getChangeY(), tickLength);
+	events.append(simulation->getEvents());
+}
 
-	// Toggle the Flash light on and off with the L key.
+/**
+*   Toggles the flash light on and off with the F key.
+*
+*   @param mainWindow - Current open window, used for input.
+*/
+void Game::updateFlashLight(std::shared_ptr<GLWindow>& mainWindow)
+{
 	if (mainWindow->retrieveKeys()[GLFW_KEY_F])
 	{
 		spotLights[0].toggleFlashLight();
@@ -370,45 +413,183 @@ void Game::updateGame(std::shared_ptr<GLWindow>& mainWindow)
 		// Set it to false to only catch the button pressed, and not while it's pressed.
 		mainWindow->retrieveKeys()[GLFW_KEY_F] = false;
 	}
+}
 
-	renderer->clear(0.1f, 0.1f, 0.1f, 1.0f);
-	renderer->enableDepth();
-
-	map->draw(model, projection, camera, shader);
+/**
+*   Ends the game when a ghost catches the player or the level is cleared. A ghost is
+*	handled first, when both happen in the same tick the game is lost like before.
+*
+*   @param mainWindow - Current open window, closed when the game is over.
+*/
+void Game::subscribeEvents(std::shared_ptr<GLWindow>& mainWindow)
+{
+	std::shared_ptr<GLWindow> window = mainWindow;
 
-	for (int i = 0; i < numberOfGhosts; i++)
+	events.subscribe<GhostCollision>([this, window](const std::vector<GhostCollision>&)
 	{
-		ghosts[i]->move(deltaTime, camera->getCameraPosition());
-		ghosts[i]->draw(camera, shader, model, projection);
-		if (ghosts[i]->checkCameraCollision(camera)) // if collision with one of the ghosts
+		if (!gameOver)
 		{
+			gameOver = true;
 			std::cout << "\nCollided with ghost. Game over!";
-			mainWindow->closeWindow();
+			window->closeWindow();
+		}
+	});
+
+	events.subscribe<LevelCleared>([this, window](const std::vector<LevelCleared>&)
+	{
+		if (!gameOver)
+		{
+			gameOver = true;
+			std::cout << "\nYou ate all the pellets. Game win, good job!";
+			window->closeWindow();
 		}
+	});
+}
+
+/**
+*   Hands the events of every tick since the last frame to their handlers in one go.
+*
+*   @see subscribeEvents()
+*/
+void Game::dispatchEvents()
+{
+	PROFILE_SCOPE("Game::dispatchEvents");
+	events.dispatch();
+	events.clear();
+}
+
+/**
+*   Updates the game when the simulation runs on its own thread. Input is handed to the
+*	simulation thread, the newest snapshot is copied into the simulation that is drawn and
+*	interpolated by how long ago its tick was due, then the frame is drawn. Nothing here
+*	waits for a tick. The events of the ticks run since the last frame are dispatched here,
+*	on the render thread.
+*
+*   @param mainWindow - Current open window.
+*   @see   SimulationThread::setInput(), applySnapshot(), takeEvents(), renderGame().
+*/
+void Game::updatePipelined(std::shared_ptr<GLWindow>& mainWindow)
+{
+	PROFILE_SCOPE("Game::updatePipelined");
+	updateTime();
+	updateFlashLight(mainWindow);
+
+	simulationThread->setInput(mainWindow->retrieveKeys(), mainWindow->getChangeX(), mainWindow->getChangeY());
+
+	if (simulationThread->updateSnapshot())
+	{
+		simulation->applySnapshot(simulationThread->getSnapshot());
 	}
+	simulationThread->takeEvents(events);
+	dispatchEvents();
+
+	interpolation = static_cast<GLfloat>((simulationThread->now() - simulationThread->getSnapshot().tickTime) / tickLength);
+	interpolation = glm::clamp(interpolation, 0.0f, 1.0f);
+
+	renderGame();
+}
+
+/**
+*   Draws the current state of the game. Positions are interpolated between the
+*	last two simulation ticks so movement stays smooth at any frame rate. The ghost
+*	draw list for both views is built before the first OpenGL call of the frame.
+*
+*   @see   useShader(), updateMVP(), updateLights(), clear(), enableDepth(), draw(),
+*		   interpolate(), getViewLocation(), getProjectionLocation(), calculateViewMatrix(),
+*		   setDirectionalLight(), setSpotLights(), DrawList::buildGhosts(), updateMinimap().
+*/
+void Game::renderGame()
+{
+	PROFILE_SCOPE("Game::renderGame");
+	GpuProfiler::beginFrame();
 
-	pelletShader->useShader();
+	simulation->interpolate(interpolation);
+	pelletRenderer->update(simulation->getPellets());
 
-	uView = pelletShader->getViewLocation();
-	uProj = pelletShader->getProjectionLocation();
+	view = camera->calculateViewMatrix();
+	minimapView = camera->calculateMinimapView();
+	drawList->buildGhosts(simulation->getGhosts(), projection * view, projectionMinimap * minimapView,
+		camera->getRenderPosition(), jobSystem.get());
 
-	glUniformMatrix4fv(uProj, 1, GL_FALSE, glm::value_ptr(projection));
-	glUniformMatrix4fv(uView, 1, GL_FALSE, glm::value_ptr(camera->calculateViewMatrix()));
+	{
+		GPU_PROFILE_SCOPE("scene");
 
-	pellets->draw(pelletShader);
+		shader->useShader();
+		updateMVP();
+		updateLights();
 
-	pelletShader->setDirectionalLight(mapLight);
-	pelletShader->setDirectionalLight(pelletLight);
-	pelletShader->setSpotLights(spotLights, 1);
+		renderer->clear(0.1f, 0.1f, 0.1f, 1.0f);
+		renderer->enableDepth();
 
-	if (pellets->allPelletsEaten()) // if all pellets are eaten
-	{ 
-		std::cout << "\nYou ate all the pellets. Game win, good job!";
-		mainWindow->closeWindow();
+		map->draw(model, projection, camera, shader);
+
+		{
+			GPU_PROFILE_SCOPE("ghosts");
+			ghostRenderer->draw(*drawList, DRAW_PASS_SCENE, shader, view, projection);
+		}
+
+		GPU_PROFILE_SCOPE("pellets");
+		pelletShader->useShader();
+
+		uView = pelletShader->getViewLocation();
+		uProj = pelletShader->getProjectionLocation();
+
+		glUniformMatrix4fv(uProj, 1, GL_FALSE, glm::value_ptr(projection));
+		glUniformMatrix4fv(uView, 1, GL_FALSE, glm::value_ptr(view));
+
+		pelletRenderer->draw(pelletShader);
+
+		pelletShader->setDirectionalLight(mapLight);
+		pelletShader->setDirectionalLight(pelletLight);
+		pelletShader->setSpotLights(spotLights, 1);
 	}
 
 	updateMinimap();
 
 	glUseProgram(0);
+	GpuProfiler::endFrame();
 }
 
+/**
+*   Updating the game as long as the window is open. The frame time is fed into an
+*	accumulator and the simulation is stepped in fixed ticks until it has caught up,
+*	the remainder is used to interpolate the rendered positions. Input is tied to the
+*	tick that consumes it, so a recorded game replays the same at any frame rate.
+*	When pipelined, the simulation thread does the stepping instead.
+*
+*   @param mainWindow - Current open window.
+*   @see   updateTime(), updateSimulation(), updatePipelined(), renderGame(), beginTick(), setInputTick().
+*/
+void Game::updateGame(std::shared_ptr<GLWindow>& mainWindow)
+{
+	PROFILE_SCOPE("Game::updateGame");
+
+	// F9 writes the profile recorded so far, when started with --profile.
+	if (mainWindow->retrieveKeys()[GLFW_KEY_F9])
+	{
+		Profiler::save();
+		mainWindow->retrieveKeys()[GLFW_KEY_F9] = false;
+	}
+
+	if (simulationThread)
+	{
+		updatePipelined(mainWindow);
+		return;
+	}
+
+	updateTime();
+
+	accumulator += deltaTime;
+	while (accumulator >= tickLength)
+	{
+		mainWindow->beginTick(static_cast<uint32_t>(simulation->getTick()));
+		updateSimulation(mainWindow);
+		accumulator -= tickLength;
+	}
+	interpolation = accumulator / tickLength;
+	dispatchEvents();
+
+	mainWindow->setInputTick(static_cast<uint32_t>(simulation->getTick()));
+
+	renderGame();
+}
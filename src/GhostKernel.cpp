@@ -0,0 +1,302 @@
+#include "GhostKernel.h"
+
+#include <cmath>
+
+#include "FixedPoint.h"
+#include "FlowField.h"
+
+#if defined(PACMAN_X86_KERNELS) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+*  GhostKernel moves ghosts stored as flat arrays, see GhostKernel.h. This file has the scalar
+*  version, which also does the ghosts left over at the end of a range by the vector versions,
+*  and picks the version to run. The SSE4.1 and AVX2 versions are in their own files, built
+*  with those instruction sets, and only exist on x86.
+*
+*  @name GhostKernel.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static const float directionX[] = { 0.0f, 0.0f, 0.0f, -1.0f, 1.0f }; // indexed by GhostDirection.
+static const float directionZ[] = { 0.0f, -1.0f, 1.0f, 0.0f, 0.0f };
+
+static GhostKernel::Level activeLevel = GhostKernel::detect();
+
+/**
+*   Best version the CPU and the operating system support.
+*
+*   @return Level - AVX2, SSE41 or SCALAR. Always SCALAR on other CPUs than x86.
+*/
+GhostKernel::Level GhostKernel::detect()
+{
+#if defined(PACMAN_X86_KERNELS) && defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int highest = info[0];
+	__cpuid(info, 1);
+	bool sse41 = (info[2] & (1 << 19)) != 0;
+	bool avx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6; // OS saves the ymm registers.
+	if (avx && highest >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+		{
+			return AVX2;
+		}
+	}
+	return sse41 ? SSE41 : SCALAR;
+#elif defined(PACMAN_X86_KERNELS)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return AVX2;
+	}
+	return __builtin_cpu_supports("sse4.1") ? SSE41 : SCALAR;
+#else
+	return SCALAR;
+#endif
+}
+
+/**
+*   Forces a version, e.g. to compare them. Applies to every advance() after it returns, so it
+*	shouldn't be called while ghosts are moving.
+*
+*   @param level - The version to run.
+*
+*	@return bool - false if the CPU doesn't have it, the version is left as it was.
+*/
+bool GhostKernel::setLevel(Level level)
+{
+	if (level > detect())
+	{
+		return false;
+	}
+	activeLevel = level;
+	return true;
+}
+
+/**
+*   The version advance() runs.
+*
+*   @return Level - the level.
+*/
+GhostKernel::Level GhostKernel::getLevel()
+{
+	return activeLevel;
+}
+
+/**
+*   Name of a version for printing.
+*
+*   @param level - The version.
+*
+*	@return const char* - "scalar", "sse4.1" or "avx2".
+*/
+const char* GhostKernel::getName(Level level)
+{
+	switch (level)
+	{
+	case SSE41:	return "sse4.1";
+	case AVX2:	return "avx2";
+	default:	return "scalar";
+	}
+}
+
+/**
+*   Moves a range of ghosts one step with the version picked by detect() or setLevel().
+*
+*   @param lanes   - The arrays of the ghosts.
+*   @param begin   - First ghost to move.
+*   @param end     - One past the last ghost to move.
+*   @param step    - Distance and tunnel edges of the step.
+*   @param entered - Gets the index of every ghost that entered a new tile, in order. Must have
+*					 room for end - begin indices.
+*
+*	@return int - how many ghosts entered a new tile.
+*/
+int GhostKernel::advance(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered)
+{
+	switch (activeLevel)
+	{
+	case AVX2:	return advanceAvx2(lanes, begin, end, step, entered);
+	case SSE41:	return advanceSse41(lanes, begin, end, step, entered);
+	default:	return advanceScalar(lanes, begin, end, step, entered);
+	}
+}
+
+/**
+*   Moves one ghost, the reference the vector versions have to match bit for bit.
+*
+*   @param lanes    - The arrays of the ghosts.
+*   @param ghost    - Index of the ghost.
+*   @param distance - How far it moves.
+*   @param step     - Tunnel edges of the step.
+*
+*	@return bool - true if it entered a new tile.
+*/
+static inline bool advanceOne(const GhostLanes& lanes, int ghost, float distance, const GhostStep& step)
+{
+	uint8_t direction = lanes.directions[ghost];
+	float oldX = lanes.x[ghost];
+	float oldZ = lanes.z[ghost];
+	float x = oldX + directionX[direction] * distance;
+	float z = oldZ + directionZ[direction] * distance;
+
+	// the offset of 0.9 against the direction lets a ghost clear the corner before turning.
+	int tileX = static_cast<int>(std::floor((x + directionX[direction] * -0.9f) * 0.5f));
+	int tileZ = static_cast<int>(std::floor((z + directionZ[direction] * -0.9f) * 0.5f));
+
+	bool moved = tileX != lanes.tileX[ghost] || tileZ != lanes.tileZ[ghost];
+	lanes.tileX[ghost] = tileX;
+	lanes.tileZ[ghost] = tileZ;
+
+	bool wrapped = true;
+	if (x < step.wrapBelow) { x = step.wrapBelowTo; }
+	else if (x > step.wrapAbove) { x = step.wrapAboveTo; }
+	else { wrapped = false; }
+
+	lanes.x[ghost] = x;
+	lanes.z[ghost] = z;
+	if (lanes.previousX != nullptr)
+	{
+		lanes.previousX[ghost] = wrapped ? x : oldX; // don't interpolate across the whole map.
+		lanes.previousZ[ghost] = wrapped ? z : oldZ;
+	}
+	return moved;
+}
+
+/**
+*   One ghost at a time, also does the ghosts left over at the end of a range by the vector
+*	versions.
+*
+*	@see advance()
+*/
+int GhostKernel::advanceScalar(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered)
+{
+	int count = 0;
+	for (int ghost = begin; ghost < end; ghost++)
+	{
+		bool moved = advanceOne(lanes, ghost, step.distance, step);
+		entered[count] = ghost;
+		count += moved ? 1 : 0;
+	}
+	return count;
+}
+
+/**
+*   Moves listed ghosts, each its own distance, with the arithmetic of advanceScalar(). For
+*	ghosts that aren't next to each other, e.g. the ones due in a tick of GhostStore's bands.
+*
+*   @param lanes     - The arrays of the ghosts.
+*   @param ghosts    - Indices of the ghosts to move.
+*   @param distances - How far each of them moves, step.distance is not used.
+*   @param count     - Number of listed ghosts.
+*   @param step      - Tunnel edges of the step.
+*   @param entered   - Gets the index of every ghost that entered a new tile, in list order.
+*					   Must have room for count indices.
+*
+*	@return int - how many ghosts entered a new tile.
+*/
+int GhostKernel::advanceListed(const GhostLanes& lanes, const int* ghosts, const float* distances, int count, const GhostStep& step, int* entered)
+{
+	int enteredCount = 0;
+	for (int i = 0; i < count; i++)
+	{
+		bool moved = advanceOne(lanes, ghosts[i], distances[i], step);
+		entered[enteredCount] = ghosts[i];
+		enteredCount += moved ? 1 : 0;
+	}
+	return enteredCount;
+}
+
+/**
+*   Moves a range of fixed point ghosts one step with the version picked by detect() or
+*	setLevel(). Every version gives the same bits on every CPU.
+*
+*   @param lanes   - The arrays of the ghosts.
+*   @param begin   - First ghost to move.
+*   @param end     - One past the last ghost to move.
+*   @param step    - Distance and tunnel edges of the step, in 16.16.
+*   @param entered - Gets the index of every ghost that entered a new tile, in order. Must have
+*					 room for end - begin indices.
+*
+*	@return int - how many ghosts entered a new tile.
+*/
+int GhostKernel::advanceFixed(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered)
+{
+	switch (activeLevel)
+	{
+	case AVX2:	return advanceFixedAvx2(lanes, begin, end, step, entered);
+	case SSE41:	return advanceFixedSse41(lanes, begin, end, step, entered);
+	default:	return advanceFixedScalar(lanes, begin, end, step, entered);
+	}
+}
+
+/**
+*   One fixed point ghost at a time, also does the ghosts left over by the vector versions. The
+*	tile is the position less the corner offset in the direction, shifted down to whole tiles.
+*
+*	@see advanceFixed()
+*/
+int GhostKernel::advanceFixedScalar(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered)
+{
+	int count = 0;
+	for (int ghost = begin; ghost < end; ghost++)
+	{
+		uint8_t direction = lanes.directions[ghost];
+		int32_t stepX = static_cast<int32_t>(directionX[direction]);
+		int32_t stepZ = static_cast<int32_t>(directionZ[direction]);
+		int32_t oldX = lanes.x[ghost];
+		int32_t oldZ = lanes.z[ghost];
+		int32_t x = oldX + stepX * step.distance;
+		int32_t z = oldZ + stepZ * step.distance;
+
+		int tileX = FixedPoint::tile(x - stepX * FIXED_CORNER);
+		int tileZ = FixedPoint::tile(z - stepZ * FIXED_CORNER);
+
+		bool moved = tileX != lanes.tileX[ghost] || tileZ != lanes.tileZ[ghost];
+		lanes.tileX[ghost] = tileX;
+		lanes.tileZ[ghost] = tileZ;
+
+		bool wrapped = true;
+		if (x < step.wrapBelow) { x = step.wrapBelowTo; }
+		else if (x > step.wrapAbove) { x = step.wrapAboveTo; }
+		else { wrapped = false; }
+
+		lanes.x[ghost] = x;
+		lanes.z[ghost] = z;
+		if (lanes.previousX != nullptr)
+		{
+			lanes.previousX[ghost] = wrapped ? x : oldX; // don't interpolate across the whole map.
+			lanes.previousZ[ghost] = wrapped ? z : oldZ;
+		}
+
+		entered[count] = ghost;
+		count += moved ? 1 : 0;
+	}
+	return count;
+}
+
+#ifndef PACMAN_X86_KERNELS
+int GhostKernel::advanceSse41(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered)
+{
+	return advanceScalar(lanes, begin, end, step, entered);
+}
+
+int GhostKernel::advanceAvx2(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered)
+{
+	return advanceScalar(lanes, begin, end, step, entered);
+}
+
+int GhostKernel::advanceFixedSse41(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered)
+{
+	return advanceFixedScalar(lanes, begin, end, step, entered);
+}
+
+int GhostKernel::advanceFixedAvx2(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered)
+{
+	return advanceFixedScalar(lanes, begin, end, step, entered);
+}
+#endif
@@ -0,0 +1,151 @@
+#include "GhostKernel.h"
+#include "FixedPoint.h" // only its constants, see below.
+
+/**
+*  AVX2 versions of GhostKernel::advance() and advanceFixed(), 8 ghosts at a time. This file is built with AVX2 on,
+*  so it uses nothing inline from other headers: code built for AVX2 must not end up being
+*  shared with the rest of the program, which also runs on CPUs without it.
+*
+*  @name GhostKernelAvx2.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+#ifdef PACMAN_X86_KERNELS
+
+#include <immintrin.h>
+
+/**
+*   Same as advanceScalar(), the ghosts left over after the last 8 are done by it.
+*
+*	@see advance()
+*/
+int GhostKernel::advanceAvx2(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered)
+{
+	const __m256i up = _mm256_set1_epi32(1);	// GhostDirection values.
+	const __m256i down = _mm256_set1_epi32(2);
+	const __m256i left = _mm256_set1_epi32(3);
+	const __m256i right = _mm256_set1_epi32(4);
+	const __m256 distance = _mm256_set1_ps(step.distance);
+	const __m256 cornerOffset = _mm256_set1_ps(-0.9f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 wrapBelow = _mm256_set1_ps(step.wrapBelow);
+	const __m256 wrapAbove = _mm256_set1_ps(step.wrapAbove);
+	const __m256 wrapBelowTo = _mm256_set1_ps(step.wrapBelowTo);
+	const __m256 wrapAboveTo = _mm256_set1_ps(step.wrapAboveTo);
+
+	int count = 0;
+	int ghost = begin;
+	for (; ghost + 8 <= end; ghost += 8)
+	{
+		__m256i direction = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lanes.directions + ghost)));
+
+		// compares are -1 where true, so left - right is -1 going left and 1 going right.
+		__m256 directionX = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cmpeq_epi32(direction, left), _mm256_cmpeq_epi32(direction, right)));
+		__m256 directionZ = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_cmpeq_epi32(direction, up), _mm256_cmpeq_epi32(direction, down)));
+
+		__m256 oldX = _mm256_loadu_ps(lanes.x + ghost);
+		__m256 oldZ = _mm256_loadu_ps(lanes.z + ghost);
+		__m256 x = _mm256_add_ps(oldX, _mm256_mul_ps(directionX, distance));
+		__m256 z = _mm256_add_ps(oldZ, _mm256_mul_ps(directionZ, distance));
+
+		__m256i tileX = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_mul_ps(_mm256_add_ps(x, _mm256_mul_ps(directionX, cornerOffset)), half)));
+		__m256i tileZ = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_mul_ps(_mm256_add_ps(z, _mm256_mul_ps(directionZ, cornerOffset)), half)));
+
+		__m256i* lastX = reinterpret_cast<__m256i*>(lanes.tileX + ghost);
+		__m256i* lastZ = reinterpret_cast<__m256i*>(lanes.tileZ + ghost);
+		__m256i same = _mm256_and_si256(_mm256_cmpeq_epi32(tileX, _mm256_loadu_si256(lastX)), _mm256_cmpeq_epi32(tileZ, _mm256_loadu_si256(lastZ)));
+		_mm256_storeu_si256(lastX, tileX);
+		_mm256_storeu_si256(lastZ, tileZ);
+
+		__m256 below = _mm256_cmp_ps(x, wrapBelow, _CMP_LT_OQ);
+		__m256 above = _mm256_andnot_ps(below, _mm256_cmp_ps(x, wrapAbove, _CMP_GT_OQ));
+		x = _mm256_blendv_ps(x, wrapAboveTo, above);
+		x = _mm256_blendv_ps(x, wrapBelowTo, below);
+
+		_mm256_storeu_ps(lanes.x + ghost, x);
+		_mm256_storeu_ps(lanes.z + ghost, z);
+		if (lanes.previousX != nullptr)
+		{
+			__m256 wrapped = _mm256_or_ps(below, above);
+			_mm256_storeu_ps(lanes.previousX + ghost, _mm256_blendv_ps(oldX, x, wrapped));
+			_mm256_storeu_ps(lanes.previousZ + ghost, _mm256_blendv_ps(oldZ, z, wrapped));
+		}
+
+		int moved = ~_mm256_movemask_ps(_mm256_castsi256_ps(same)) & 0xff;
+		for (int lane = 0; lane < 8; lane++)
+		{
+			entered[count] = ghost + lane;
+			count += (moved >> lane) & 1;
+		}
+	}
+	return count + advanceScalar(lanes, ghost, end, step, entered + count);
+}
+
+/**
+*   Same as advanceFixedScalar(), the ghosts left over after the last 8 are done by it.
+*
+*	@see advanceFixed()
+*/
+int GhostKernel::advanceFixedAvx2(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered)
+{
+	const __m256i up = _mm256_set1_epi32(1);	// GhostDirection values.
+	const __m256i down = _mm256_set1_epi32(2);
+	const __m256i left = _mm256_set1_epi32(3);
+	const __m256i right = _mm256_set1_epi32(4);
+	const __m256i distance = _mm256_set1_epi32(step.distance);
+	const __m256i corner = _mm256_set1_epi32(FIXED_CORNER);
+	const __m256i wrapBelow = _mm256_set1_epi32(step.wrapBelow);
+	const __m256i wrapAbove = _mm256_set1_epi32(step.wrapAbove);
+	const __m256i wrapBelowTo = _mm256_set1_epi32(step.wrapBelowTo);
+	const __m256i wrapAboveTo = _mm256_set1_epi32(step.wrapAboveTo);
+
+	int count = 0;
+	int ghost = begin;
+	for (; ghost + 8 <= end; ghost += 8)
+	{
+		__m256i direction = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(lanes.directions + ghost)));
+		__m256i isUp = _mm256_cmpeq_epi32(direction, up);
+		__m256i isDown = _mm256_cmpeq_epi32(direction, down);
+		__m256i isLeft = _mm256_cmpeq_epi32(direction, left);
+		__m256i isRight = _mm256_cmpeq_epi32(direction, right);
+
+		// + where the direction is positive, - where it is negative, nothing where it is 0.
+		__m256i oldX = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.x + ghost));
+		__m256i oldZ = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes.z + ghost));
+		__m256i x = _mm256_sub_epi32(_mm256_add_epi32(oldX, _mm256_and_si256(distance, isRight)), _mm256_and_si256(distance, isLeft));
+		__m256i z = _mm256_sub_epi32(_mm256_add_epi32(oldZ, _mm256_and_si256(distance, isDown)), _mm256_and_si256(distance, isUp));
+
+		__m256i tileX = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(x, _mm256_and_si256(corner, isRight)), _mm256_and_si256(corner, isLeft)), FixedPoint::TILE_SHIFT);
+		__m256i tileZ = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(z, _mm256_and_si256(corner, isDown)), _mm256_and_si256(corner, isUp)), FixedPoint::TILE_SHIFT);
+
+		__m256i* lastX = reinterpret_cast<__m256i*>(lanes.tileX + ghost);
+		__m256i* lastZ = reinterpret_cast<__m256i*>(lanes.tileZ + ghost);
+		__m256i same = _mm256_and_si256(_mm256_cmpeq_epi32(tileX, _mm256_loadu_si256(lastX)), _mm256_cmpeq_epi32(tileZ, _mm256_loadu_si256(lastZ)));
+		_mm256_storeu_si256(lastX, tileX);
+		_mm256_storeu_si256(lastZ, tileZ);
+
+		__m256i below = _mm256_cmpgt_epi32(wrapBelow, x);
+		__m256i above = _mm256_andnot_si256(below, _mm256_cmpgt_epi32(x, wrapAbove));
+		x = _mm256_blendv_epi8(x, wrapAboveTo, above);
+		x = _mm256_blendv_epi8(x, wrapBelowTo, below);
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.x + ghost), x);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.z + ghost), z);
+		if (lanes.previousX != nullptr)
+		{
+			__m256i wrapped = _mm256_or_si256(below, above);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.previousX + ghost), _mm256_blendv_epi8(oldX, x, wrapped));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes.previousZ + ghost), _mm256_blendv_epi8(oldZ, z, wrapped));
+		}
+
+		int moved = ~_mm256_movemask_ps(_mm256_castsi256_ps(same)) & 0xff;
+		for (int lane = 0; lane < 8; lane++)
+		{
+			entered[count] = ghost + lane;
+			count += (moved >> lane) & 1;
+		}
+	}
+	return count + advanceFixedScalar(lanes, ghost, end, step, entered + count);
+}
+
+#endif
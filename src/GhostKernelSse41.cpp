@@ -0,0 +1,158 @@
+#include "GhostKernel.h"
+#include "FixedPoint.h" // only its constants, see below.
+
+#include <cstring>
+
+/**
+*  SSE4.1 versions of GhostKernel::advance() and advanceFixed(), 4 ghosts at a time, for CPUs
+*  without AVX2. Built with SSE4.1 on, like GhostKernelAvx2.cpp it uses nothing inline from
+*  other headers.
+*
+*  @name GhostKernelSse41.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+#ifdef PACMAN_X86_KERNELS
+
+#include <smmintrin.h>
+
+/**
+*   Same as advanceScalar(), the ghosts left over after the last 4 are done by it.
+*
+*	@see advance()
+*/
+int GhostKernel::advanceSse41(const GhostLanes& lanes, int begin, int end, const GhostStep& step, int* entered)
+{
+	const __m128i up = _mm_set1_epi32(1);	// GhostDirection values.
+	const __m128i down = _mm_set1_epi32(2);
+	const __m128i left = _mm_set1_epi32(3);
+	const __m128i right = _mm_set1_epi32(4);
+	const __m128 distance = _mm_set1_ps(step.distance);
+	const __m128 cornerOffset = _mm_set1_ps(-0.9f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 wrapBelow = _mm_set1_ps(step.wrapBelow);
+	const __m128 wrapAbove = _mm_set1_ps(step.wrapAbove);
+	const __m128 wrapBelowTo = _mm_set1_ps(step.wrapBelowTo);
+	const __m128 wrapAboveTo = _mm_set1_ps(step.wrapAboveTo);
+
+	int count = 0;
+	int ghost = begin;
+	for (; ghost + 4 <= end; ghost += 4)
+	{
+		int packed;
+		std::memcpy(&packed, lanes.directions + ghost, sizeof(packed));
+		__m128i direction = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+
+		// compares are -1 where true, so left - right is -1 going left and 1 going right.
+		__m128 directionX = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_cmpeq_epi32(direction, left), _mm_cmpeq_epi32(direction, right)));
+		__m128 directionZ = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_cmpeq_epi32(direction, up), _mm_cmpeq_epi32(direction, down)));
+
+		__m128 oldX = _mm_loadu_ps(lanes.x + ghost);
+		__m128 oldZ = _mm_loadu_ps(lanes.z + ghost);
+		__m128 x = _mm_add_ps(oldX, _mm_mul_ps(directionX, distance));
+		__m128 z = _mm_add_ps(oldZ, _mm_mul_ps(directionZ, distance));
+
+		__m128i tileX = _mm_cvttps_epi32(_mm_floor_ps(_mm_mul_ps(_mm_add_ps(x, _mm_mul_ps(directionX, cornerOffset)), half)));
+		__m128i tileZ = _mm_cvttps_epi32(_mm_floor_ps(_mm_mul_ps(_mm_add_ps(z, _mm_mul_ps(directionZ, cornerOffset)), half)));
+
+		__m128i* lastX = reinterpret_cast<__m128i*>(lanes.tileX + ghost);
+		__m128i* lastZ = reinterpret_cast<__m128i*>(lanes.tileZ + ghost);
+		__m128i same = _mm_and_si128(_mm_cmpeq_epi32(tileX, _mm_loadu_si128(lastX)), _mm_cmpeq_epi32(tileZ, _mm_loadu_si128(lastZ)));
+		_mm_storeu_si128(lastX, tileX);
+		_mm_storeu_si128(lastZ, tileZ);
+
+		__m128 below = _mm_cmplt_ps(x, wrapBelow);
+		__m128 above = _mm_andnot_ps(below, _mm_cmpgt_ps(x, wrapAbove));
+		x = _mm_blendv_ps(x, wrapAboveTo, above);
+		x = _mm_blendv_ps(x, wrapBelowTo, below);
+
+		_mm_storeu_ps(lanes.x + ghost, x);
+		_mm_storeu_ps(lanes.z + ghost, z);
+		if (lanes.previousX != nullptr)
+		{
+			__m128 wrapped = _mm_or_ps(below, above);
+			_mm_storeu_ps(lanes.previousX + ghost, _mm_blendv_ps(oldX, x, wrapped));
+			_mm_storeu_ps(lanes.previousZ + ghost, _mm_blendv_ps(oldZ, z, wrapped));
+		}
+
+		int moved = ~_mm_movemask_ps(_mm_castsi128_ps(same)) & 0xf;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			entered[count] = ghost + lane;
+			count += (moved >> lane) & 1;
+		}
+	}
+	return count + advanceScalar(lanes, ghost, end, step, entered + count);
+}
+
+/**
+*   Same as advanceFixedScalar(), the ghosts left over after the last 4 are done by it. The
+*	direction only picks whether the distance and the corner offset are added or taken off.
+*
+*	@see advanceFixed()
+*/
+int GhostKernel::advanceFixedSse41(const FixedLanes& lanes, int begin, int end, const FixedStep& step, int* entered)
+{
+	const __m128i up = _mm_set1_epi32(1);	// GhostDirection values.
+	const __m128i down = _mm_set1_epi32(2);
+	const __m128i left = _mm_set1_epi32(3);
+	const __m128i right = _mm_set1_epi32(4);
+	const __m128i distance = _mm_set1_epi32(step.distance);
+	const __m128i corner = _mm_set1_epi32(FIXED_CORNER);
+	const __m128i wrapBelow = _mm_set1_epi32(step.wrapBelow);
+	const __m128i wrapAbove = _mm_set1_epi32(step.wrapAbove);
+	const __m128i wrapBelowTo = _mm_set1_epi32(step.wrapBelowTo);
+	const __m128i wrapAboveTo = _mm_set1_epi32(step.wrapAboveTo);
+
+	int count = 0;
+	int ghost = begin;
+	for (; ghost + 4 <= end; ghost += 4)
+	{
+		int packed;
+		std::memcpy(&packed, lanes.directions + ghost, sizeof(packed));
+		__m128i direction = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+		__m128i isUp = _mm_cmpeq_epi32(direction, up);
+		__m128i isDown = _mm_cmpeq_epi32(direction, down);
+		__m128i isLeft = _mm_cmpeq_epi32(direction, left);
+		__m128i isRight = _mm_cmpeq_epi32(direction, right);
+
+		// + where the direction is positive, - where it is negative, nothing where it is 0.
+		__m128i oldX = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.x + ghost));
+		__m128i oldZ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes.z + ghost));
+		__m128i x = _mm_sub_epi32(_mm_add_epi32(oldX, _mm_and_si128(distance, isRight)), _mm_and_si128(distance, isLeft));
+		__m128i z = _mm_sub_epi32(_mm_add_epi32(oldZ, _mm_and_si128(distance, isDown)), _mm_and_si128(distance, isUp));
+
+		__m128i tileX = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(x, _mm_and_si128(corner, isRight)), _mm_and_si128(corner, isLeft)), FixedPoint::TILE_SHIFT);
+		__m128i tileZ = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(z, _mm_and_si128(corner, isDown)), _mm_and_si128(corner, isUp)), FixedPoint::TILE_SHIFT);
+
+		__m128i* lastX = reinterpret_cast<__m128i*>(lanes.tileX + ghost);
+		__m128i* lastZ = reinterpret_cast<__m128i*>(lanes.tileZ + ghost);
+		__m128i same = _mm_and_si128(_mm_cmpeq_epi32(tileX, _mm_loadu_si128(lastX)), _mm_cmpeq_epi32(tileZ, _mm_loadu_si128(lastZ)));
+		_mm_storeu_si128(lastX, tileX);
+		_mm_storeu_si128(lastZ, tileZ);
+
+		__m128i below = _mm_cmplt_epi32(x, wrapBelow);
+		__m128i above = _mm_andnot_si128(below, _mm_cmpgt_epi32(x, wrapAbove));
+		x = _mm_blendv_epi8(x, wrapAboveTo, above);
+		x = _mm_blendv_epi8(x, wrapBelowTo, below);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.x + ghost), x);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.z + ghost), z);
+		if (lanes.previousX != nullptr)
+		{
+			__m128i wrapped = _mm_or_si128(below, above);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.previousX + ghost), _mm_blendv_epi8(oldX, x, wrapped));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.previousZ + ghost), _mm_blendv_epi8(oldZ, z, wrapped));
+		}
+
+		int moved = ~_mm_movemask_ps(_mm_castsi128_ps(same)) & 0xf;
+		for (int lane = 0; lane < 4; lane++)
+		{
+			entered[count] = ghost + lane;
+			count += (moved >> lane) & 1;
+		}
+	}
+	return count + advanceFixedScalar(lanes, ghost, end, step, entered + count);
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "GhostRenderer.h"
+
+/**
+*  GhostRenderer draws the ghost model with Assimp for every ghost in the game. The ghosts
+*  themselves are just entries in a GhostStore, so one renderer (and one loaded model) is shared by all of them.
+*
+*  @name GhostRenderer.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Load the ghost model using the Model class and Assimp.
+*
+*	@see loadModel()
+*/
+GhostRenderer::GhostRenderer()
+	: uniformModel(0), uniformView(0), uniformProjection(0)
+{
+	PROFILE_SCOPE("GhostRenderer::GhostRenderer");
+	ghostModel = std::make_unique<Model>();
+	ghostModel->loadModel("assets/models/ghost.obj");
+}
+
+/**
+*   Destructor for the ghost renderer, all initialized as smart pointer.
+*/
+GhostRenderer::~GhostRenderer()
+{
+
+}
+
+/**
+*   Draws the ghosts of one pass of a draw list. The list is already culled and sorted and holds
+*	the model matrices, so the shader and the shared uniforms are only set once for the whole pass.
+*
+*   @param     drawList			  - The draw list built for this frame.
+*   @param     pass				  - DRAW_PASS_SCENE or DRAW_PASS_MINIMAP.
+*   @param     shader		      - Sends a shared pointer of the Shader from the Game class
+*   @param     view				  - View matrix of the pass.
+*   @param     projection		  - Projection matrix of the pass.
+*
+*	@see useShader(), getModelLocation(), getProjectionLocation(), getViewLocation(),
+*		 DrawList::buildGhosts(), renderElements()
+*/
+void GhostRenderer::draw(const DrawList& drawList, uint8_t pass, std::shared_ptr<Shader>& shader, const glm::mat4& view, const glm::mat4& projection)
+{
+	PROFILE_SCOPE("GhostRenderer::draw");
+	shader->useShader();
+
+	uniformModel = shader->getModelLocation();
+	uniformProjection = shader->getProjectionLocation();
+	uniformView = shader->getViewLocation();
+
+	glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, glm::value_ptr(projection));
+	glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(view));
+
+	for (const DrawItem* item = drawList.begin(pass); item != drawList.end(pass); item++)
+	{
+		glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(item->model));
+		ghostModel->renderElements();
+	}
+}
@@ -0,0 +1,1296 @@
+#include "GhostStore.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+*  GhostStore holds the state of every ghost of a game in flat arrays and moves them.
+*  Each ghost has its own AI that steers it: when it enters a junction, it takes the shortest way
+*  to the player from the shared flow field, with a chance that gets lower for every ghost,
+*  otherwise it picks a random open direction. In a corridor it follows the bends.
+*
+*  Drawing is done by GhostRenderer from a DrawList, nothing in here knows about OpenGL.
+*
+*  @name GhostStore.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Keeps a reference to the level, builds its junction graph and spawns the ghosts on random open
+*	tiles, moving in a random open direction. Ghosts don't spawn in the tunnel row the player
+*	starts in.
+*
+*   @param levelGrid      - The level, shared with the rest of the game.
+*   @param numberOfGhosts - How many ghosts to spawn.
+*   @param seed           - Seed of the game, ghost i draws from stream i of it.
+*/
+GhostStore::GhostStore(std::shared_ptr<const LevelGrid> levelGrid, int numberOfGhosts, uint64_t seed)
+	: tilesX(levelGrid->getTilesX()), tilesZ(levelGrid->getTilesZ()), seed(seed),
+	grid(std::move(levelGrid)), flowField(*grid), graph(*grid), planner(nullptr), targetTile(-1),
+	scheduled(false), travelled(0.0), lastTravelled(0.0), drainedSlot(0),
+	blocksX((tilesX + BLOCK_TILES - 1) / BLOCK_TILES), blocksZ((tilesZ + BLOCK_TILES - 1) / BLOCK_TILES),
+	playerPosition(0.0f), detailPlayer(0.0f), detailTick(0), detailSteps(DETAIL_TICKS, 0.0f),
+	detailClosing(DETAIL_TICKS, 0.0f), detailReset(0), fixedPoint(false)
+{
+	wrapAbove = wrapEdge(tilesX);
+	int32_t width = tilesX * 2 * FixedPoint::ONE;
+	fixedEdges = { 0, FixedPoint::ONE, width - FixedPoint::fromFloat(0.8f), width - FixedPoint::ONE, FixedPoint::ONE };
+
+	int startTileZ = grid->getStartTile() < 0 ? -1 : grid->getStartTile() / tilesX;
+	for (int z = 0; z < tilesZ; z++)
+	{
+		for (int x = 0; x < tilesX; x++)
+		{
+			if (grid->tile(x, z) == LevelGrid::OPEN && z != startTileZ)
+			{
+				spawnPositions.push_back(glm::vec3(x * 2 + 1, HEIGHT, z * 2 + 1));
+			}
+		}
+	}
+
+	positionX.resize(numberOfGhosts);
+	positionZ.resize(numberOfGhosts);
+	previousX.resize(numberOfGhosts);
+	previousZ.resize(numberOfGhosts);
+	renderPositions.resize(numberOfGhosts);
+	directions.assign(numberOfGhosts, GHOST_NONE); // no offset when looking for the start direction.
+	decisionTileX.assign(numberOfGhosts, -1);	 // no direction calculated in any tile yet.
+	decisionTileZ.assign(numberOfGhosts, -1);
+	randomCounters.assign(numberOfGhosts, 0);
+	planTiles.assign(numberOfGhosts, -1);
+	planDirections.assign(numberOfGhosts, GHOST_NONE);
+	segmentStarts.assign(numberOfGhosts, 0.0);
+	eventDistances.assign(numberOfGhosts, std::numeric_limits<double>::infinity());
+	ghostBlocks.assign(numberOfGhosts, -1);
+	blockSlots.assign(numberOfGhosts, 0);
+	ghostBands.assign(numberOfGhosts, 0);
+	lastSteps.assign(numberOfGhosts, 0);
+	fixedX.resize(numberOfGhosts);
+	fixedZ.resize(numberOfGhosts);
+	fixedPreviousX.resize(numberOfGhosts);
+	fixedPreviousZ.resize(numberOfGhosts);
+
+	for (int ghost = 0; ghost < numberOfGhosts; ghost++)
+	{
+		glm::vec3 spawn = spawnPositions[randomNumber(ghost, static_cast<int>(spawnPositions.size()) - 1)];
+		positionX[ghost] = spawn.x;
+		positionZ[ghost] = spawn.z;
+		previousX[ghost] = spawn.x;
+		previousZ[ghost] = spawn.z;
+		renderPositions[ghost] = spawn;
+		directions[ghost] = randomOpenDirection(ghost, graph.cell(tileIndexX(ghost), tileIndexZ(ghost)));
+	}
+	syncFixed();
+}
+
+/**
+*   The x a ghost teleports to the other side over. It used to be compared in double, this
+*	float is the same test for every float x.
+*
+*   @param tilesX - Width of the level in tiles.
+*
+*	@return float - the largest float not over tilesX * 2 - 0.8.
+*/
+float GhostStore::wrapEdge(int tilesX)
+{
+	double edge = tilesX * 2 - 0.8;
+	float wrap = static_cast<float>(edge);
+	if (wrap > edge)
+	{
+		wrap = std::nextafter(wrap, 0.0f);
+	}
+	return wrap;
+}
+
+/**
+*   Unit vector of a direction.
+*
+*   @param direction - A GhostDirection.
+*
+*	@return glm::vec3 - the direction in world space, zero for GHOST_NONE.
+*/
+glm::vec3 GhostStore::directionVector(uint8_t direction)
+{
+	switch (direction)
+	{
+	case GHOST_UP:		return glm::vec3(0.0f, 0.0f, -1.0f);
+	case GHOST_DOWN:	return glm::vec3(0.0f, 0.0f, 1.0f);
+	case GHOST_LEFT:	return glm::vec3(-1.0f, 0.0f, 0.0f);
+	case GHOST_RIGHT:	return glm::vec3(1.0f, 0.0f, 0.0f);
+	default:			return glm::vec3(0.0f, 0.0f, 0.0f);
+	}
+}
+
+/**
+*   Gets the level array X index of a ghost. The offset lets a ghost clear the corner before turning.
+*
+*   @param ghost - Index of the ghost.
+*
+*	@return int - tile column.
+*/
+int GhostStore::tileIndexX(int ghost) const
+{
+	float offset = 0;
+	if (directions[ghost] == GHOST_LEFT) { offset = 0.9f; }
+	else if (directions[ghost] == GHOST_RIGHT) { offset = -0.9f; }
+
+	return static_cast<int>(std::floor((positionX[ghost] + offset) / 2));
+}
+
+/**
+*   Gets the level array Z index of a ghost.
+*
+*   @param ghost - Index of the ghost.
+*
+*	@return int - tile row.
+*/
+int GhostStore::tileIndexZ(int ghost) const
+{
+	float offset = 0;
+	if (directions[ghost] == GHOST_UP) { offset = 0.9f; }
+	else if (directions[ghost] == GHOST_DOWN) { offset = -0.9f; } // offset for clearing corners
+
+	return static_cast<int>(std::floor((positionZ[ghost] + offset) / 2));
+}
+
+/**
+*   Random number between 0 and the argument value from the ghost's own stream.
+*
+*   @param ghost               - Index of the ghost.
+*   @param highestRandomNumber - The highest possible number.
+*
+*	@return int - the number.
+*/
+int GhostStore::randomNumber(int ghost, int highestRandomNumber)
+{
+	return CounterRandom::uniformInt(seed, static_cast<uint64_t>(ghost), randomCounters[ghost]++, highestRandomNumber);
+}
+
+/**
+*   Points the flow field at the tile the player is in. Has to be called before the ghosts
+*	of a tick move, the search only runs when the player has changed tile. With a planner
+*	the tile only becomes the target of the paths asked for.
+*
+*   @param pacmanPosition - Where the player is.
+*/
+void GhostStore::track(glm::vec3 pacmanPosition)
+{
+	playerPosition = pacmanPosition;
+	int tileX = static_cast<int>(std::floor(pacmanPosition.x / 2));
+	int tileZ = static_cast<int>(std::floor(pacmanPosition.z / 2));
+	if (planner != nullptr)
+	{
+		targetTile = grid->contains(tileX, tileZ) ? tileZ * tilesX + tileX : -1;
+		return;
+	}
+	flowField.setTarget(tileX, tileZ);
+}
+
+/**
+*   Random open direction of a tile. Nothing is drawn when there is only one way.
+*
+*   @param ghost - Index of the ghost, whose stream is drawn from.
+*   @param cell  - JunctionGraph::cell() of the tile.
+*
+*	@return uint8_t - a GhostDirection, GHOST_NONE if the tile is boxed in.
+*/
+uint8_t GhostStore::randomOpenDirection(int ghost, uint8_t cell)
+{
+	uint8_t placesToMove[4];
+	int places = 0;
+	for (uint8_t direction = GHOST_UP; direction <= GHOST_RIGHT; direction++)
+	{
+		if (cell & JunctionGraph::openBit(direction))
+		{
+			placesToMove[places++] = direction;
+		}
+	}
+	if (places <= 1)
+	{
+		return places == 0 ? static_cast<uint8_t>(GHOST_NONE) : placesToMove[0];
+	}
+	return placesToMove[randomNumber(ghost, places - 1)];
+}
+
+/**
+*   AI of a ghost at a node. A dead end sends it back. At a junction, with a chance of
+*	1/(index + 1) it takes the step that gets it closest to the player in the flow field.
+*	If it doesn't, or is already in the player's tile, it takes a random open direction.
+*	With a planner the chance was taken at the last node, a ghost that chases takes the
+*	planned step.
+*
+*   @param ghost - Index of the ghost.
+*   @param tileX - Column of the node.
+*   @param tileZ - Row of the node.
+*   @param cell  - JunctionGraph::cell() of the node.
+*
+*	@see planNextNode()
+*/
+void GhostStore::calculateAiDirection(int ghost, int tileX, int tileZ, uint8_t cell)
+{
+	uint8_t open = cell & ~JunctionGraph::NODE;
+	if ((open & (open - 1)) == 0) // dead end or boxed in, nothing to decide.
+	{
+		if (open != 0)
+		{
+			directions[ghost] = JunctionGraph::firstDirection(open);
+		}
+		if (planner != nullptr)
+		{
+			planNextNode(ghost, tileX, tileZ);
+		}
+		return;
+	}
+
+	if (planner != nullptr)
+	{
+		uint8_t planned = takePlan(ghost, tileZ * tilesX + tileX);
+		directions[ghost] = planned != GHOST_NONE ? planned : randomOpenDirection(ghost, open);
+		planNextNode(ghost, tileX, tileZ);
+		return;
+	}
+
+	uint8_t newDirection = GHOST_NONE;
+
+	int aiValue = ghost + 1;
+	if (randomNumber(ghost, aiValue - 1) == 0) // the chance that it will do an AI calculation is 1/aiValue
+	{
+		newDirection = flowField.bestDirection(tileX, tileZ);
+	}
+
+	if (newDirection == GHOST_NONE)
+	{
+		newDirection = randomOpenDirection(ghost, open);
+	}
+	directions[ghost] = newDirection;
+}
+
+/**
+*   The planned step of a ghost at a node, the plan is used up.
+*
+*   @param ghost - Index of the ghost.
+*   @param tile  - Row major index of the node.
+*
+*	@return uint8_t - a GhostDirection, GHOST_NONE without a path planned for this node.
+*/
+uint8_t GhostStore::takePlan(int ghost, int tile)
+{
+	uint8_t planned = planTiles[ghost] == tile && planDirections[ghost] != PLAN_PENDING ? planDirections[ghost] : static_cast<uint8_t>(GHOST_NONE);
+	planTiles[ghost] = -1;
+	return planned;
+}
+
+/**
+*   Decides at a node whether a ghost chases at the next node it comes to, with the same
+*	1/(index + 1) chance as without a planner, and asks for a path from there if it does.
+*
+*   @param ghost - Index of the ghost, directions[ghost] is the way it leaves the node in.
+*   @param tileX - Column of the node.
+*   @param tileZ - Row of the node.
+*/
+void GhostStore::planNextNode(int ghost, int tileX, int tileZ)
+{
+	if (randomNumber(ghost, ghost) == 0)
+	{
+		requestPlan(ghost, tileX, tileZ);
+	}
+}
+
+/**
+*   Asks the planner for a path to the player from the node at the other end of the corridor
+*	a ghost leaves a node by. The ghost arrives there facing away from the corridor, so the
+*	path may not start back into it.
+*
+*   @param ghost - Index of the ghost, directions[ghost] is the way it leaves the node in.
+*   @param tileX - Column of the node.
+*   @param tileZ - Row of the node.
+*/
+void GhostStore::requestPlan(int ghost, int tileX, int tileZ)
+{
+	int node = graph.findNode(tileX, tileZ);
+	uint8_t direction = directions[ghost];
+	if (node < 0 || direction == GHOST_NONE || targetTile < 0 || graph.getNodes()[node].edges[direction - 1] < 0)
+	{
+		return;
+	}
+
+	const JunctionEdge& edge = graph.getEdges()[graph.getNodes()[node].edges[direction - 1]];
+	bool forward = edge.from == node && edge.fromDirection == direction;
+	int nextNode = forward ? edge.to : edge.from;
+	uint8_t heading = JunctionGraph::reverse(forward ? edge.toDirection : edge.fromDirection);
+
+	planTiles[ghost] = graph.getNodes()[nextNode].tile;
+	planDirections[ghost] = PLAN_PENDING;
+	planner->request({ ghost, planTiles[ghost], targetTile, heading });
+}
+
+/**
+*   Moves a range of ghosts one tick. GhostKernel moves them all and teleports them from edge
+*	to edge, then the ghosts that entered a new tile look at the junction graph: at a node they
+*	decide where to go, in a corridor they follow the bend if there is one. Only reads the graph
+*	and the flow field, so ranges can move in parallel.
+*
+*   @param begin - First ghost to move.
+*   @param end   - One past the last ghost to move.
+*   @param dt    - Length of the tick in seconds, clamped like a frame time.
+*
+*	@see track(), calculateAiDirection()
+*/
+void GhostStore::move(int begin, int end, float dt)
+{
+	PROFILE_SCOPE("GhostStore::move");
+	float delta = dt;
+	if (delta > 0.03f)
+	{
+		delta = 0.02f;
+	}
+
+	static thread_local std::vector<int> entered; // reused between ticks, one per thread.
+	if (static_cast<int>(entered.size()) < end - begin)
+	{
+		entered.resize(end - begin);
+	}
+
+	int count;
+	if (fixedPoint)
+	{
+		FixedLanes lanes = { fixedX.data(), fixedZ.data(), fixedPreviousX.data(), fixedPreviousZ.data(), directions.data(),
+			decisionTileX.data(), decisionTileZ.data() };
+		FixedStep step = fixedEdges;
+		step.distance = FixedPoint::fromFloat(delta * 2.0f);
+		count = GhostKernel::advanceFixed(lanes, begin, end, step, entered.data());
+	}
+	else
+	{
+		GhostLanes lanes = { positionX.data(), positionZ.data(), previousX.data(), previousZ.data(), directions.data(),
+			decisionTileX.data(), decisionTileZ.data() };
+		GhostStep step = { delta * 2.0f, 1.0f, wrapAbove, tilesX * 2 - 1.0f, 1.0f };
+		count = GhostKernel::advance(lanes, begin, end, step, entered.data());
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		int ghost = entered[i];
+		enterTile(ghost, decisionTileX[ghost], decisionTileZ[ghost]);
+	}
+}
+
+/**
+*   What a ghost does when it enters a tile: at a node it decides where to go, in a corridor
+*	it follows the bend if there is one.
+*
+*   @param ghost - Index of the ghost.
+*   @param tileX - Column of the tile.
+*   @param tileZ - Row of the tile.
+*/
+void GhostStore::enterTile(int ghost, int tileX, int tileZ)
+{
+	uint8_t cell = graph.cell(tileX, tileZ);
+	if (cell & JunctionGraph::NODE)
+	{
+		calculateAiDirection(ghost, tileX, tileZ, cell);
+	}
+	else if (cell != 0) // corridor, the only way on is the one that isn't back.
+	{
+		uint8_t forward = cell & ~JunctionGraph::openBit(JunctionGraph::reverse(directions[ghost]));
+		if ((forward & JunctionGraph::openBit(directions[ghost])) == 0)
+		{
+			directions[ghost] = JunctionGraph::firstDirection(forward);
+		}
+	}
+}
+
+/**
+*   Checks if any ghost in a range has caught the player.
+*
+*   @param begin          - First ghost to check.
+*   @param end            - One past the last ghost to check.
+*   @param playerPosition - Where the player is.
+*
+*	@return int - the first ghost that is close enough to the player, -1 if none is.
+*/
+int GhostStore::catches(int begin, int end, glm::vec3 playerPosition) const
+{
+	for (int ghost = begin; ghost < end; ghost++)
+	{
+		if (closeEnough(positionX[ghost], positionZ[ghost], playerPosition))
+		{
+			return ghost;
+		}
+	}
+	return -1;
+}
+
+/**
+*   Blends the positions of the last two ticks for rendering.
+*
+*   @param alpha - How far into the next tick the frame is, between 0 and 1.
+*/
+void GhostStore::interpolate(float alpha)
+{
+	if (scheduled || !detailBands.empty() || fixedPoint) // the positions are worked out, only for the ghosts that are drawn.
+	{
+		for (int ghost = 0; ghost < size(); ghost++)
+		{
+			renderPositions[ghost] = glm::mix(getPreviousPosition(ghost), getPosition(ghost), alpha);
+		}
+		return;
+	}
+	for (size_t ghost = 0; ghost < positionX.size(); ghost++)
+	{
+		renderPositions[ghost] = glm::vec3(glm::mix(previousX[ghost], positionX[ghost], alpha), HEIGHT,
+			glm::mix(previousZ[ghost], positionZ[ghost], alpha));
+	}
+}
+
+/**
+*   Places a ghost without running its AI, e.g. to show a snapshot of another game. Ghosts
+*	stay at HEIGHT, the y of the positions is not used.
+*
+*   @param ghost            - Index of the ghost.
+*   @param position         - Position at the end of the last tick.
+*   @param previousPosition - Position at the start of the last tick.
+*   @param direction        - Direction the ghost is moving in.
+*/
+void GhostStore::setPose(int ghost, glm::vec3 position, glm::vec3 previousPosition, uint8_t direction)
+{
+	positionX[ghost] = position.x;
+	positionZ[ghost] = position.z;
+	previousX[ghost] = previousPosition.x;
+	previousZ[ghost] = previousPosition.z;
+	directions[ghost] = direction;
+	lastSteps[ghost] = detailTick;
+	fixedX[ghost] = FixedPoint::fromFloat(position.x);
+	fixedZ[ghost] = FixedPoint::fromFloat(position.z);
+	fixedPreviousX[ghost] = FixedPoint::fromFloat(previousPosition.x);
+	fixedPreviousZ[ghost] = FixedPoint::fromFloat(previousPosition.z);
+	if (scheduled) // a new straight line starts here.
+	{
+		segmentStarts[ghost] = travelled;
+		scheduleNext(ghost);
+	}
+}
+
+/**
+*   Switches between moving every ghost every tick and moving them by events, see GhostStore.h.
+*	Scheduled ghosts go on from where they are, ghosts that haven't decided in a tile yet do so
+*	in the next tick. Switching back puts the worked out positions into the arrays again.
+*	Scheduling turns fixed point off, events are worked out in float.
+*
+*   @param enabled - true to schedule the ghosts.
+*
+*	@see advanceScheduled(), catchesNear()
+*/
+void GhostStore::setScheduled(bool enabled)
+{
+	if (enabled == scheduled)
+	{
+		return;
+	}
+
+	if (!enabled)
+	{
+		for (int ghost = 0; ghost < size(); ghost++)
+		{
+			glm::vec3 position = getPosition(ghost);
+			glm::vec3 previousPosition = getPreviousPosition(ghost);
+			positionX[ghost] = position.x;
+			positionZ[ghost] = position.z;
+			previousX[ghost] = previousPosition.x;
+			previousZ[ghost] = previousPosition.z;
+		}
+		scheduled = false;
+		wheel.clear();
+		blockGhosts.clear();
+		return;
+	}
+
+	setFixedPoint(false);
+	scheduled = true;
+	travelled = 0.0;
+	lastTravelled = 0.0;
+	for (int ghost = 0; ghost < size(); ghost++)
+	{
+		segmentStarts[ghost] = 0.0;
+		eventDistances[ghost] = decisionTileX[ghost] < 0 ? 0.0 : -1.0; // -1 is worked out by rebuildSchedule().
+	}
+	rebuildSchedule();
+}
+
+/**
+*   Fills the timing wheel and the blocks from the state of the ghosts. A ghost with a negative
+*	event distance gets its next event worked out, one with 0 is due in the next tick.
+*/
+void GhostStore::rebuildSchedule()
+{
+	wheel.assign(WHEEL_SLOTS, std::vector<std::pair<double, int>>());
+	blockGhosts.assign(static_cast<size_t>(blocksX) * blocksZ, std::vector<int>());
+	std::fill(ghostBlocks.begin(), ghostBlocks.end(), -1);
+	drainedSlot = static_cast<long long>(std::floor(travelled / SLOT_DISTANCE));
+
+	for (int ghost = 0; ghost < size(); ghost++)
+	{
+		if (decisionTileX[ghost] >= 0)
+		{
+			placeInBlock(ghost, decisionTileX[ghost], decisionTileZ[ghost]);
+		}
+		else
+		{
+			glm::vec3 position = getPosition(ghost);
+			placeInBlock(ghost, static_cast<int>(std::floor(position.x / 2)), static_cast<int>(std::floor(position.z / 2)));
+		}
+
+		if (eventDistances[ghost] < 0.0)
+		{
+			scheduleNext(ghost);
+		}
+		else if (eventDistances[ghost] != std::numeric_limits<double>::infinity())
+		{
+			double due = std::max(eventDistances[ghost], std::nextafter(travelled, std::numeric_limits<double>::infinity()));
+			eventDistances[ghost] = due;
+			wheel[static_cast<size_t>(static_cast<long long>(std::floor(due / SLOT_DISTANCE)) & (WHEEL_SLOTS - 1))].push_back({ due, ghost });
+		}
+	}
+}
+
+/**
+*   Where a scheduled ghost is: in a straight line from where it last turned.
+*
+*   @param ghost    - Index of the ghost.
+*   @param distance - travelled at the moment asked about, not before segmentStarts[ghost].
+*
+*	@return glm::vec3 - the position.
+*/
+glm::vec3 GhostStore::positionAt(int ghost, double distance) const
+{
+	glm::vec3 velocity = directionVector(directions[ghost]);
+	double moved = distance - segmentStarts[ghost];
+	return glm::vec3(static_cast<float>(positionX[ghost] + velocity.x * moved), HEIGHT, static_cast<float>(positionZ[ghost] + velocity.z * moved));
+}
+
+/**
+*   Moves every scheduled ghost one tick: they all go the same distance further, and the ghosts
+*	that reach the tile of their next event in it run their AI. Must not run in parallel.
+*
+*   @param dt - Length of the tick in seconds, clamped like in move().
+*
+*	@return int - how many ghosts had an event.
+*
+*	@see setScheduled(), runEvent()
+*/
+int GhostStore::advanceScheduled(float dt)
+{
+	PROFILE_SCOPE("GhostStore::advanceScheduled");
+	float delta = dt;
+	if (delta > 0.03f)
+	{
+		delta = 0.02f;
+	}
+	lastTravelled = travelled;
+	travelled += delta * 2.0f;
+
+	// every slot up to the one travelled is in is due, of that one only what isn't ahead.
+	long long currentSlot = static_cast<long long>(std::floor(travelled / SLOT_DISTANCE));
+	dueGhosts.clear();
+	for (long long slot = drainedSlot; slot <= currentSlot; slot++)
+	{
+		std::vector<std::pair<double, int>>& events = wheel[static_cast<size_t>(slot & (WHEEL_SLOTS - 1))];
+		size_t kept = 0;
+		for (const std::pair<double, int>& event : events)
+		{
+			if (eventDistances[event.second] != event.first)
+			{
+				continue; // rescheduled since.
+			}
+			if (event.first <= travelled)
+			{
+				dueGhosts.push_back(event.second);
+			}
+			else
+			{
+				events[kept++] = event;
+			}
+		}
+		events.resize(kept);
+	}
+	drainedSlot = currentSlot;
+
+	int count = 0;
+	for (int ghost : dueGhosts)
+	{
+		if (eventDistances[ghost] <= travelled) // listed twice when rescheduled to the same distance.
+		{
+			runEvent(ghost);
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+*   A scheduled ghost at its event: it wraps at the edges and runs the AI of the tile it is in
+*	like move() does. When it turns or wraps a new straight line starts where it is. Then it
+*	goes into the block of its tile and the next event is scheduled.
+*
+*   @param ghost - Index of the ghost.
+*/
+void GhostStore::runEvent(int ghost)
+{
+	uint8_t direction = directions[ghost];
+	glm::vec3 position = positionAt(ghost, travelled);
+	glm::vec3 previousPosition = positionAt(ghost, lastTravelled);
+
+	bool wrapped = true;
+	if (position.x < 1.0f) { position.x = tilesX * 2 - 1.0f; }
+	else if (position.x > wrapAbove) { position.x = 1.0f; }
+	else { wrapped = false; }
+
+	// the same tile as GhostKernel finds, the offset lets a ghost clear the corner before turning.
+	glm::vec3 velocity = directionVector(direction);
+	int tileX = static_cast<int>(std::floor((position.x + velocity.x * -0.9f) * 0.5f));
+	int tileZ = static_cast<int>(std::floor((position.z + velocity.z * -0.9f) * 0.5f));
+	if (tileX != decisionTileX[ghost] || tileZ != decisionTileZ[ghost])
+	{
+		decisionTileX[ghost] = tileX;
+		decisionTileZ[ghost] = tileZ;
+		enterTile(ghost, tileX, tileZ);
+	}
+
+	if (wrapped || directions[ghost] != direction)
+	{
+		positionX[ghost] = position.x;
+		positionZ[ghost] = position.z;
+		previousX[ghost] = wrapped ? position.x : previousPosition.x; // don't interpolate across the whole map.
+		previousZ[ghost] = wrapped ? position.z : previousPosition.z;
+		segmentStarts[ghost] = travelled;
+	}
+
+	placeInBlock(ghost, decisionTileX[ghost], decisionTileZ[ghost]);
+	scheduleNext(ghost);
+}
+
+/**
+*   Works out when a scheduled ghost gets to its next event and puts it in the timing wheel.
+*	The tiles ahead are walked until one where the ghost may turn, the first one of another
+*	block or the edge it wraps at. Never due before the next tick.
+*
+*   @param ghost - Index of the ghost, decisionTileX/Z is the tile it is in.
+*/
+void GhostStore::scheduleNext(int ghost)
+{
+	uint8_t direction = directions[ghost];
+	if (direction == GHOST_NONE)
+	{
+		eventDistances[ghost] = std::numeric_limits<double>::infinity(); // boxed in, never moves again.
+		return;
+	}
+
+	glm::vec3 velocity = directionVector(direction);
+	int stepX = static_cast<int>(velocity.x);
+	int stepZ = static_cast<int>(velocity.z);
+	double start = stepX != 0 ? positionX[ghost] : positionZ[ghost];
+	int block = ghostBlocks[ghost];
+	uint8_t ahead = JunctionGraph::openBit(direction);
+
+	int tileX = decisionTileX[ghost];
+	int tileZ = decisionTileZ[ghost];
+	double distance = 0.0;
+	while (true)
+	{
+		tileX += stepX;
+		tileZ += stepZ;
+		if (tileX < 0 || tileX >= tilesX) // the ghost wraps before it gets there.
+		{
+			distance = stepX > 0 ? wrapAbove - start : start - 1.0;
+			break;
+		}
+
+		uint8_t cell = graph.cell(tileX, tileZ);
+		bool turns = (cell & JunctionGraph::NODE) != 0 || (cell != 0 && (cell & ahead) == 0);
+		if (turns || tileZ < 0 || tileZ >= tilesZ || (tileZ / BLOCK_TILES) * blocksX + tileX / BLOCK_TILES != block)
+		{
+			// the tile is entered at 0.9 past its near edge, see runEvent().
+			int k = stepX != 0 ? tileX : tileZ;
+			int step = stepX != 0 ? stepX : stepZ;
+			distance = step > 0 ? (k * 2 + 0.9) - start : start - (k * 2 + 1.1);
+			break;
+		}
+	}
+
+	double due = std::max(segmentStarts[ghost] + distance, std::nextafter(travelled, std::numeric_limits<double>::infinity()));
+	eventDistances[ghost] = due;
+	wheel[static_cast<size_t>(static_cast<long long>(std::floor(due / SLOT_DISTANCE)) & (WHEEL_SLOTS - 1))].push_back({ due, ghost });
+}
+
+/**
+*   Moves a scheduled ghost into the bucket of the block a tile is in.
+*
+*   @param ghost - Index of the ghost.
+*   @param tileX - Column of the tile.
+*   @param tileZ - Row of the tile.
+*/
+void GhostStore::placeInBlock(int ghost, int tileX, int tileZ)
+{
+	int blockX = std::min(std::max(tileX, 0), tilesX - 1) / BLOCK_TILES;
+	int blockZ = std::min(std::max(tileZ, 0), tilesZ - 1) / BLOCK_TILES;
+	int block = blockZ * blocksX + blockX;
+	int old = ghostBlocks[ghost];
+	if (block == old)
+	{
+		return;
+	}
+
+	if (old >= 0) // the last ghost of the old block takes its place.
+	{
+		std::vector<int>& ghosts = blockGhosts[old];
+		int moved = ghosts.back();
+		ghosts[blockSlots[ghost]] = moved;
+		blockSlots[moved] = blockSlots[ghost];
+		ghosts.pop_back();
+	}
+	blockSlots[ghost] = static_cast<int>(blockGhosts[block].size());
+	blockGhosts[block].push_back(ghost);
+	ghostBlocks[ghost] = block;
+}
+
+/**
+*   catches() for scheduled ghosts, only the blocks around the player are looked at. A ghost
+*	is at most a tile from the tile of its last event, or two in the tick its event is late.
+*
+*   @param playerPosition - Where the player is.
+*
+*	@return int - the lowest index of a ghost close enough to the player, -1 if none is.
+*/
+int GhostStore::catchesNear(glm::vec3 playerPosition) const
+{
+	const int reach = 3; // tiles, the catch distance is less than one.
+	int tileX = static_cast<int>(std::floor(playerPosition.x / 2));
+	int tileZ = static_cast<int>(std::floor(playerPosition.z / 2));
+	int firstX = std::max(tileX - reach, 0) / BLOCK_TILES;
+	int lastX = std::min(tileX + reach, tilesX - 1) / BLOCK_TILES;
+	int firstZ = std::max(tileZ - reach, 0) / BLOCK_TILES;
+	int lastZ = std::min(tileZ + reach, tilesZ - 1) / BLOCK_TILES;
+
+	int caught = -1;
+	for (int blockZ = firstZ; blockZ <= lastZ; blockZ++)
+	{
+		for (int blockX = firstX; blockX <= lastX; blockX++)
+		{
+			for (int ghost : blockGhosts[static_cast<size_t>(blockZ) * blocksX + blockX])
+			{
+				if (caught >= 0 && ghost > caught)
+				{
+					continue;
+				}
+				glm::vec3 position = positionAt(ghost, travelled);
+				if (closeEnough(position.x, position.z, playerPosition))
+				{
+					caught = ghost;
+				}
+			}
+		}
+	}
+	return caught;
+}
+
+/**
+*   Moves the ghosts far from the player less often, see GhostStore.h. A ghost is in the last
+*	band whose tiles it is away from the player's tile, in X or in Z, and in none if it is
+*	nearer than the first. Bands need at least 3 tiles and are moved every 1 to
+*	MAX_DETAIL_INTERVAL ticks. Every ghost is moved and put in its band in the next tick.
+*	Turning the bands off moves every ghost the rest of its way, so they all are where they
+*	would be. Not used while the ghosts are scheduled. Bands turn fixed point off, the
+*	ghosts that are due are moved in float.
+*
+*   @param bands - Distances and intervals, in any order. Empty moves every ghost every tick.
+*
+*	@see moveDetailed(), catchesDetailed()
+*/
+void GhostStore::setDetailBands(std::vector<DetailBand> bands)
+{
+	for (DetailBand& band : bands)
+	{
+		band.tiles = std::max(band.tiles, 3);
+		band.interval = std::min(std::max(band.interval, 1), MAX_DETAIL_INTERVAL);
+	}
+	std::sort(bands.begin(), bands.end(), [](const DetailBand& a, const DetailBand& b) { return a.tiles < b.tiles; });
+
+	if (bands.empty())
+	{
+		if (!detailBands.empty())
+		{
+			dueGhosts.clear();
+			for (int ghost = 0; ghost < size(); ghost++)
+			{
+				if (lastSteps[ghost] != detailTick)
+				{
+					dueGhosts.push_back(ghost);
+				}
+			}
+			moveDue();
+		}
+		detailBands.clear();
+		bandSlots.clear();
+		return;
+	}
+
+	setFixedPoint(false);
+	if (detailBands.empty())
+	{
+		std::fill(lastSteps.begin(), lastSteps.end(), detailTick);
+	}
+	detailBands = bands;
+	detailReset = 1;
+	rebuildBands();
+}
+
+/**
+*   Fills the lists of ghosts due in each tick from the band of every ghost.
+*/
+void GhostStore::rebuildBands()
+{
+	bandSlots.assign(detailBands.size() + 1, std::vector<std::vector<int>>());
+	bandSlots[0].resize(1);
+	for (size_t band = 0; band < detailBands.size(); band++)
+	{
+		bandSlots[band + 1].resize(detailBands[band].interval);
+	}
+	for (int ghost = 0; ghost < size(); ghost++)
+	{
+		placeInBand(ghost, std::min(static_cast<int>(ghostBands[ghost]), static_cast<int>(detailBands.size())));
+	}
+}
+
+/**
+*   Puts a ghost in a band, always in the same list of it. Each list of a band has the ghosts
+*	of one range of indices, so a band is spread evenly over its ticks and the ghosts of a tick
+*	are mostly next to each other in memory.
+*
+*   @param ghost - Index of the ghost.
+*   @param band  - 0 for the ghosts near the player, b + 1 for detailBands[b].
+*/
+void GhostStore::placeInBand(int ghost, int band)
+{
+	ghostBands[ghost] = static_cast<uint8_t>(band);
+	std::vector<std::vector<int>>& slots = bandSlots[band];
+	slots[static_cast<size_t>(ghost) * slots.size() / positionX.size()].push_back(ghost);
+}
+
+/**
+*   Moves the ghosts in dueGhosts the distance of every tick since each was last moved, in one
+*	step of GhostKernel, and runs the AI of those that got into a new tile. A ghost that got
+*	into it before the last of those ticks is put back to the end of the tick it got in, like
+*	a ghost moved every tick would be when it turns, and moved the rest of the way in the
+*	direction it takes there. Otherwise a ghost that turns would go on off the middle of the
+*	corridor, by up to the distance of MAX_DETAIL_INTERVAL ticks.
+*/
+void GhostStore::moveDue()
+{
+	static thread_local std::vector<float> distances; // reused between ticks.
+	static thread_local std::vector<int> entered;
+	int count = static_cast<int>(dueGhosts.size());
+	distances.resize(count);
+	entered.resize(count);
+
+	// the distance of the last ticks, newest first, for any ghost that was moved that many ticks ago.
+	float sinceTicks[DETAIL_TICKS] = { 0.0f };
+	for (int ticks = 1; ticks < DETAIL_TICKS; ticks++)
+	{
+		sinceTicks[ticks] = sinceTicks[ticks - 1] + detailSteps[(detailTick - (ticks - 1)) % DETAIL_TICKS];
+	}
+	for (int i = 0; i < count; i++)
+	{
+		int ghost = dueGhosts[i];
+		distances[i] = sinceTicks[detailTick - lastSteps[ghost]]; // never more than MAX_DETAIL_INTERVAL ticks.
+		lastSteps[ghost] = detailTick;
+	}
+
+	GhostLanes lanes = { positionX.data(), positionZ.data(), previousX.data(), previousZ.data(), directions.data(),
+		decisionTileX.data(), decisionTileZ.data() };
+	GhostStep step = { 0.0f, 1.0f, wrapAbove, tilesX * 2 - 1.0f, 1.0f };
+	int enteredCount = GhostKernel::advanceListed(lanes, dueGhosts.data(), distances.data(), count, step, entered.data());
+	int listed = 0;
+	for (int i = 0; i < enteredCount; i++)
+	{
+		int ghost = entered[i];
+		while (dueGhosts[listed] != ghost) // entered is in list order.
+		{
+			listed++;
+		}
+
+		// how far the ghost went past where it got into the tile, with the offsets of tileIndexX/Z(),
+		// and whether it was in another tile at the start of the step.
+		glm::vec3 heading = directionVector(directions[ghost]);
+		float past = 0.0f;
+		bool crossed = false;
+		if (heading.x > 0.0f)
+		{
+			past = positionX[ghost] - (decisionTileX[ghost] * 2 + 0.9f);
+			crossed = static_cast<int>(std::floor((previousX[ghost] - 0.9f) / 2)) != decisionTileX[ghost];
+		}
+		else if (heading.x < 0.0f)
+		{
+			past = (decisionTileX[ghost] * 2 + 1.1f) - positionX[ghost];
+			crossed = static_cast<int>(std::floor((previousX[ghost] + 0.9f) / 2)) != decisionTileX[ghost];
+		}
+		else if (heading.z > 0.0f)
+		{
+			past = positionZ[ghost] - (decisionTileZ[ghost] * 2 + 0.9f);
+			crossed = static_cast<int>(std::floor((previousZ[ghost] - 0.9f) / 2)) != decisionTileZ[ghost];
+		}
+		else if (heading.z < 0.0f)
+		{
+			past = (decisionTileZ[ghost] * 2 + 1.1f) - positionZ[ghost];
+			crossed = static_cast<int>(std::floor((previousZ[ghost] + 0.9f) / 2)) != decisionTileZ[ghost];
+		}
+
+		// distance of the ticks after the one it got into the tile in, none for a ghost that came
+		// out of the tunnel or had no tile yet.
+		float after = 0.0f;
+		bool wrapped = previousX[ghost] == positionX[ghost] && previousZ[ghost] == positionZ[ghost];
+		if (crossed && !wrapped)
+		{
+			for (int ticks = 1; ticks < DETAIL_TICKS && sinceTicks[ticks] < past && sinceTicks[ticks] < distances[listed]; ticks++)
+			{
+				after = sinceTicks[ticks];
+			}
+		}
+		if (after == 0.0f)
+		{
+			enterTile(ghost, decisionTileX[ghost], decisionTileZ[ghost]);
+		}
+		else
+		{
+			positionX[ghost] -= heading.x * after;
+			positionZ[ghost] -= heading.z * after;
+			enterTile(ghost, decisionTileX[ghost], decisionTileZ[ghost]);
+
+			float startX = previousX[ghost];
+			float startZ = previousZ[ghost];
+			int again;
+			if (GhostKernel::advanceListed(lanes, &ghost, &after, 1, step, &again) > 0)
+			{
+				enterTile(ghost, decisionTileX[ghost], decisionTileZ[ghost]);
+			}
+			if (previousX[ghost] != positionX[ghost] || previousZ[ghost] != positionZ[ghost]) // not through the tunnel.
+			{
+				previousX[ghost] = startX; // drawn from where it was at the start of the step.
+				previousZ[ghost] = startZ;
+			}
+		}
+	}
+}
+
+/**
+*   Moves the ghosts of one tick with bands: the ghosts near the player and the ghosts of each
+*	band that are due in it. Each of them is put in the band of where it is now.
+*
+*	A ghost in a band is more than 2 * (tiles - 1) away from the player, or 2 less through the
+*	tunnel, where it comes out 2 nearer than it went in. Each tick the two can get no closer
+*	than the player moved and a ghost moves, kept for the last ticks in detailClosing. When
+*	that adds up to the catch distance less than what a band has to spare over the ticks of
+*	its interval, e.g. when the player goes through the tunnel, every ghost is moved in this
+*	tick. So no ghost outside band 0 can be close enough to catch the player. Must not run in
+*	parallel.
+*
+*   @param dt - Length of the tick in seconds, clamped like in move().
+*
+*	@return int - how many ghosts were moved.
+*
+*	@see setDetailBands(), catchesDetailed()
+*/
+int GhostStore::moveDetailed(float dt)
+{
+	PROFILE_SCOPE("GhostStore::moveDetailed");
+	float delta = dt;
+	if (delta > 0.03f)
+	{
+		delta = 0.02f;
+	}
+
+	detailTick++;
+	size_t ring = static_cast<size_t>(detailTick % DETAIL_TICKS);
+	detailSteps[ring] = delta * 2.0f;
+	detailClosing[ring] = glm::length(playerPosition - detailPlayer) + delta * 2.0f;
+	detailPlayer = playerPosition;
+
+	bool everyGhost = detailReset != 0;
+	for (const DetailBand& band : detailBands)
+	{
+		float closing = 0.0f;
+		for (int tick = 0; tick < band.interval; tick++)
+		{
+			closing += detailClosing[(detailTick - tick) % DETAIL_TICKS];
+		}
+		if (closing >= 2.0f * (band.tiles - 2) - CATCH_DISTANCE)
+		{
+			everyGhost = true;
+		}
+	}
+
+	dueGhosts.clear();
+	if (everyGhost)
+	{
+		for (std::vector<std::vector<int>>& slots : bandSlots)
+		{
+			for (std::vector<int>& ghosts : slots)
+			{
+				ghosts.clear();
+			}
+		}
+		for (int ghost = 0; ghost < size(); ghost++)
+		{
+			dueGhosts.push_back(ghost);
+		}
+		std::fill(detailClosing.begin(), detailClosing.end(), 0.0f); // nobody was put in a band before this tick.
+		detailReset = 0;
+	}
+	else
+	{
+		for (std::vector<std::vector<int>>& slots : bandSlots)
+		{
+			std::vector<int>& ghosts = slots[detailTick % slots.size()];
+			dueGhosts.insert(dueGhosts.end(), ghosts.begin(), ghosts.end());
+			ghosts.clear();
+		}
+	}
+
+	moveDue();
+
+	// the band of where each is now, the distance in X is the shorter way, through the tunnel or not.
+	int playerTileX = static_cast<int>(std::floor(playerPosition.x / 2));
+	int playerTileZ = static_cast<int>(std::floor(playerPosition.z / 2));
+	int bands = static_cast<int>(detailBands.size());
+	for (int ghost : dueGhosts)
+	{
+		int distanceX = std::abs(static_cast<int>(positionX[ghost] * 0.5f) - playerTileX); // ghosts are never below 0, truncating floors.
+		int distanceZ = std::abs(static_cast<int>(positionZ[ghost] * 0.5f) - playerTileZ);
+		int distance = std::max(std::min(distanceX, std::abs(tilesX - distanceX)), distanceZ);
+		int band = 0;
+		while (band < bands && distance >= detailBands[band].tiles)
+		{
+			band++;
+		}
+		placeInBand(ghost, band);
+	}
+	return static_cast<int>(dueGhosts.size());
+}
+
+/**
+*   catches() with bands, only the ghosts near the player are looked at, moveDetailed() keeps
+*	every other ghost too far away.
+*
+*   @param playerPosition - Where the player is.
+*
+*	@return int - the lowest index of a ghost close enough to the player, -1 if none is.
+*/
+int GhostStore::catchesDetailed(glm::vec3 playerPosition) const
+{
+	int caught = -1;
+	for (int ghost : bandSlots[0][0])
+	{
+		if ((caught < 0 || ghost < caught) && closeEnough(positionX[ghost], positionZ[ghost], playerPosition))
+		{
+			caught = ghost;
+		}
+	}
+	return caught;
+}
+
+/**
+*   Switches between moving the ghosts on float and on 16.16 fixed point positions, see
+*	GhostStore.h. Each starts from the positions the other left. Fixed point turns the
+*	scheduling and the bands off, they only move ghosts in float.
+*
+*   @param enabled - true to move the ghosts in fixed point.
+*
+*	@see move(), catchesFixed()
+*/
+void GhostStore::setFixedPoint(bool enabled)
+{
+	if (enabled == fixedPoint)
+	{
+		return;
+	}
+
+	if (enabled)
+	{
+		setScheduled(false);
+		setDetailBands({});
+		syncFixed();
+	}
+	else
+	{
+		for (int ghost = 0; ghost < size(); ghost++)
+		{
+			positionX[ghost] = FixedPoint::toFloat(fixedX[ghost]);
+			positionZ[ghost] = FixedPoint::toFloat(fixedZ[ghost]);
+			previousX[ghost] = FixedPoint::toFloat(fixedPreviousX[ghost]);
+			previousZ[ghost] = FixedPoint::toFloat(fixedPreviousZ[ghost]);
+		}
+	}
+	fixedPoint = enabled;
+}
+
+/**
+*   Sets the fixed point positions of every ghost from its float positions, after the ghosts
+*	were moved in float.
+*/
+void GhostStore::syncFixed()
+{
+	for (int ghost = 0; ghost < size(); ghost++)
+	{
+		fixedX[ghost] = FixedPoint::fromFloat(positionX[ghost]);
+		fixedZ[ghost] = FixedPoint::fromFloat(positionZ[ghost]);
+		fixedPreviousX[ghost] = FixedPoint::fromFloat(previousX[ghost]);
+		fixedPreviousZ[ghost] = FixedPoint::fromFloat(previousZ[ghost]);
+	}
+}
+
+/**
+*   catches() on the fixed point positions, the distance is compared squared in integers.
+*
+*   @param begin   - First ghost to check.
+*   @param end     - One past the last ghost to check.
+*   @param playerX - X of the player in 16.16.
+*   @param playerZ - Z of the player in 16.16.
+*
+*	@return int - the first ghost that is close enough to the player, -1 if none is.
+*/
+int GhostStore::catchesFixed(int begin, int end, int32_t playerX, int32_t playerZ) const
+{
+	const int64_t reach = FIXED_CATCH_DISTANCE;
+	for (int ghost = begin; ghost < end; ghost++)
+	{
+		int64_t dx = static_cast<int64_t>(playerX) - fixedX[ghost];
+		int64_t dz = static_cast<int64_t>(playerZ) - fixedZ[ghost];
+		if (dx > -reach && dx < reach && dz > -reach && dz < reach && dx * dx + dz * dz < reach * reach)
+		{
+			return ghost;
+		}
+	}
+	return -1;
+}
+
+/**
+*   Lets the ghosts plan their paths to the player with a planner instead of following the
+*	flow field. Plans made before are dropped.
+*
+*   @param pathPlanner - Planner the paths are asked from, null goes back to the flow field.
+*/
+void GhostStore::setPlanner(PathPlanner* pathPlanner)
+{
+	planner = pathPlanner;
+	std::fill(planTiles.begin(), planTiles.end(), -1);
+}
+
+/**
+*   Hands the paths the planner found to the ghosts that asked for them. Results for a node
+*	the ghost no longer plans for are ignored.
+*
+*   @param results - PathPlanner::collect() of the tick before.
+*/
+void GhostStore::applyPlans(const std::vector<PathResult>& results)
+{
+	for (const PathResult& result : results)
+	{
+		if (planTiles[result.ghost] == result.fromTile && planDirections[result.ghost] == PLAN_PENDING)
+		{
+			planDirections[result.ghost] = result.direction;
+		}
+	}
+}
+
+/**
+*   Asks again for every path still pending, e.g. after restoreState(). The ghosts are still on
+*	the node they asked from, they haven't moved since, and track() must have been called with
+*	the player position of that tick.
+*/
+void GhostStore::requestPendingPlans()
+{
+	if (planner == nullptr)
+	{
+		return;
+	}
+	for (int ghost = 0; ghost < size(); ghost++)
+	{
+		if (planTiles[ghost] >= 0 && planDirections[ghost] == PLAN_PENDING)
+		{
+			requestPlan(ghost, decisionTileX[ghost], decisionTileZ[ghost]);
+		}
+	}
+}
+
+/**
+*   Writes everything that changes while the ghosts move: positions, directions, the tile of the
+*	last decision, the planned steps and the position in the random stream. The level and the spawn tiles are not
+*	written, they never change. The distances of the event schedule, the bands of the ghosts and
+*	the fixed point positions are always written, they are only used by a store that is
+*	scheduled like the one that saved them, has the same bands or moves in fixed point. The
+*	float positions of a store in fixed point are those it had when it went into it.
+*
+*   @param writer - Buffer of the game state.
+*/
+void GhostStore::saveState(StateWriter& writer) const
+{
+	writer.writeArray(positionX);
+	writer.writeArray(positionZ);
+	writer.writeArray(previousX);
+	writer.writeArray(previousZ);
+	writer.writeArray(directions);
+	writer.writeArray(decisionTileX);
+	writer.writeArray(decisionTileZ);
+	writer.writeArray(planTiles);
+	writer.writeArray(planDirections);
+	writer.writeArray(randomCounters);
+	writer.write(travelled);
+	writer.write(lastTravelled);
+	writer.writeArray(segmentStarts);
+	writer.writeArray(eventDistances);
+	writer.write(detailTick);
+	writer.write(detailPlayer);
+	writer.write(detailReset);
+	writer.writeArray(detailSteps);
+	writer.writeArray(detailClosing);
+	writer.writeArray(ghostBands);
+	writer.writeArray(lastSteps);
+	writer.writeArray(fixedX);
+	writer.writeArray(fixedZ);
+	writer.writeArray(fixedPreviousX);
+	writer.writeArray(fixedPreviousZ);
+}
+
+/**
+*   Reads what saveState() wrote, for the same number of ghosts. The ghosts are drawn where
+*	they were at the end of the saved tick until the next interpolate(). A scheduled store
+*	puts the ghosts back in its timing wheel and blocks, a store with bands in its bands.
+*
+*   @param reader - Buffer of the game state.
+*
+*	@return bool - false if the buffer ended early.
+*/
+bool GhostStore::restoreState(StateReader& reader)
+{
+	bool read = reader.readArray(positionX) && reader.readArray(positionZ) && reader.readArray(previousX)
+		&& reader.readArray(previousZ) && reader.readArray(directions) && reader.readArray(decisionTileX)
+		&& reader.readArray(decisionTileZ) && reader.readArray(planTiles) && reader.readArray(planDirections)
+		&& reader.readArray(randomCounters) && reader.read(travelled) && reader.read(lastTravelled)
+		&& reader.readArray(segmentStarts) && reader.readArray(eventDistances) && reader.read(detailTick)
+		&& reader.read(detailPlayer) && reader.read(detailReset) && reader.readArray(detailSteps)
+		&& reader.readArray(detailClosing) && reader.readArray(ghostBands) && reader.readArray(lastSteps)
+		&& reader.readArray(fixedX) && reader.readArray(fixedZ) && reader.readArray(fixedPreviousX)
+		&& reader.readArray(fixedPreviousZ);
+	if (scheduled)
+	{
+		rebuildSchedule();
+	}
+	if (!detailBands.empty())
+	{
+		rebuildBands();
+	}
+	for (size_t ghost = 0; ghost < positionX.size(); ghost++)
+	{
+		renderPositions[ghost] = getPosition(static_cast<int>(ghost));
+	}
+	return read;
+}
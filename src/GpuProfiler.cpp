@@ -0,0 +1,234 @@
+#include "GpuProfiler.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+*  GpuProfiler measures how long the GPU spends on each render pass with timer queries.
+*  Every frame has its own set of queries in a ring of FRAMES_IN_FLIGHT, a set is only read
+*  when the ring comes back around to it.
+*
+*  @name GpuProfiler.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+GpuProfiler::Frame GpuProfiler::frames[GpuProfiler::FRAMES_IN_FLIGHT];
+int GpuProfiler::frameIndex = 0;
+bool GpuProfiler::active = false;
+int GpuProfiler::framePass = -1;
+ProfileBuffer* GpuProfiler::lane = nullptr;
+std::vector<GpuProfiler::PassStats> GpuProfiler::stats;
+double GpuProfiler::lastFrameMs = 0.0;
+unsigned long long GpuProfiler::droppedFrames = 0;
+
+/**
+*   Creates the queries. Needs a current OpenGL context, does nothing if the context has no
+*	timer queries.
+*/
+void GpuProfiler::initialise()
+{
+	if (active || !(GLEW_VERSION_3_3 || GLEW_ARB_timer_query))
+	{
+		return;
+	}
+
+	for (auto& frame : frames)
+	{
+		glGenQueries(MAX_PASSES * 2, frame.queries);
+		frame.passCount = 0;
+		frame.clockOffset = 0;
+		frame.pending = false;
+	}
+
+	if (lane == nullptr)
+	{
+		lane = Profiler::createLane("GPU");
+	}
+	active = true;
+}
+
+/**
+*   Deletes the queries, has to be called before the context is destroyed.
+*/
+void GpuProfiler::shutdown()
+{
+	if (!active)
+	{
+		return;
+	}
+
+	for (auto& frame : frames)
+	{
+		glDeleteQueries(MAX_PASSES * 2, frame.queries);
+	}
+	active = false;
+}
+
+/**
+*   Starts the queries of a new frame. The set of queries it reuses is read back first, it was
+*	issued FRAMES_IN_FLIGHT frames ago.
+*/
+void GpuProfiler::beginFrame()
+{
+	if (!active)
+	{
+		return;
+	}
+
+	Frame& frame = frames[frameIndex];
+	if (frame.pending)
+	{
+		collect(frame);
+	}
+
+	GLint64 gpuNow = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+	frame.clockOffset = static_cast<int64_t>(Profiler::now()) - gpuNow;
+	frame.passCount = 0;
+	frame.pending = true;
+
+	framePass = beginPass("GPU frame");
+}
+
+/**
+*   Ends the queries of the current frame.
+*/
+void GpuProfiler::endFrame()
+{
+	if (!active)
+	{
+		return;
+	}
+
+	endPass(framePass);
+	framePass = -1;
+	frameIndex = (frameIndex + 1) % FRAMES_IN_FLIGHT;
+}
+
+/**
+*   Puts a timestamp query at the start of a pass.
+*
+*   @param name - Name of the pass, has to outlive the profiler.
+*
+*   @return int - the pass to give to endPass(), -1 if it is not timed.
+*/
+int GpuProfiler::beginPass(const char* name)
+{
+	Frame& frame = frames[frameIndex];
+	if (!frame.pending || frame.passCount == MAX_PASSES)
+	{
+		return -1;
+	}
+
+	int pass = frame.passCount++;
+	frame.names[pass] = name;
+	glQueryCounter(frame.queries[pass * 2], GL_TIMESTAMP);
+	return pass;
+}
+
+/**
+*   Puts a timestamp query at the end of a pass.
+*
+*   @param pass - What beginPass() returned.
+*/
+void GpuProfiler::endPass(int pass)
+{
+	if (pass < 0 || !active)
+	{
+		return;
+	}
+	glQueryCounter(frames[frameIndex].queries[pass * 2 + 1], GL_TIMESTAMP);
+}
+
+/**
+*   Reads the results of a frame. If the GPU is somehow still not done with it the frame is
+*	dropped rather than waited for.
+*
+*   @param frame - Frame to read.
+*/
+void GpuProfiler::collect(Frame& frame)
+{
+	frame.pending = false;
+	if (frame.passCount == 0)
+	{
+		return;
+	}
+
+	GLint available = 0;
+	glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available); // the frame pass ends last.
+	if (!available)
+	{
+		droppedFrames++;
+		return;
+	}
+
+	for (int pass = 0; pass < frame.passCount; pass++)
+	{
+		GLuint64 start = 0;
+		GLuint64 end = 0;
+		glGetQueryObjectui64v(frame.queries[pass * 2], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(frame.queries[pass * 2 + 1], GL_QUERY_RESULT, &end);
+		if (end < start)
+		{
+			end = start;
+		}
+
+		double ms = (end - start) / 1000000.0;
+		addStats(frame.names[pass], ms);
+		if (pass == 0)
+		{
+			lastFrameMs = ms;
+		}
+
+		if (Profiler::isEnabled())
+		{
+			Profiler::record(*lane, frame.names[pass], start + frame.clockOffset, end + frame.clockOffset);
+		}
+	}
+}
+
+/**
+*   Adds the time of one pass to its averages.
+*
+*   @param name - Name of the pass.
+*   @param ms   - GPU time of the pass in milliseconds.
+*/
+void GpuProfiler::addStats(const char* name, double ms)
+{
+	for (auto& pass : stats)
+	{
+		if (std::strcmp(pass.name, name) == 0)
+		{
+			pass.lastMs = ms;
+			pass.totalMs += ms;
+			pass.frames++;
+			return;
+		}
+	}
+	stats.push_back({ name, ms, ms, 1 });
+}
+
+/**
+*   Prints the average GPU time of every pass.
+*
+*   @param out - Stream to print to.
+*/
+void GpuProfiler::writeSummary(std::ostream& out)
+{
+	if (stats.empty())
+	{
+		return;
+	}
+
+	char line[128];
+	out << "\nGPU pass               avg ms    last ms   frames\n";
+	for (auto& pass : stats)
+	{
+		std::snprintf(line, sizeof(line), "%-20s %8.3f   %8.3f   %llu\n", pass.name, pass.totalMs / pass.frames, pass.lastMs, pass.frames);
+		out << line;
+	}
+	if (droppedFrames > 0)
+	{
+		out << "frames not ready in time: " << droppedFrames << '\n';
+	}
+}
@@ -0,0 +1,241 @@
+#include "InputRecording.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+*  InputRecorder writes the input of a play session to a binary file, InputReplay reads it back.
+*  A session recorded on one build can be replayed on the next, so frame time comparisons are
+*  made on exactly the same game.
+*
+*  @name InputRecording.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Constructor for a recorder, nothing is written until open() is called.
+*/
+InputRecorder::InputRecorder()
+{
+
+}
+
+/**
+*   Writes whatever is left and closes the file.
+*/
+InputRecorder::~InputRecorder()
+{
+	flush();
+}
+
+/**
+*   Creates the recording file and writes the header.
+*
+*   @param path     - Where to write the recording, an existing file is replaced.
+*   @param seed     - Seed of the Simulation that is recorded.
+*   @param tickRate - Ticks per second of the Simulation.
+*   @param modes    - InputMode flags of the Simulation.
+*   @param bands    - Distance bands of the Simulation, at most INPUT_MAX_BANDS.
+*
+*   @return bool - false if the file could not be created or there are too many bands.
+*/
+bool InputRecorder::open(const std::string& path, uint64_t seed, uint32_t tickRate, uint32_t modes, const std::vector<InputBand>& bands)
+{
+	if (bands.size() > INPUT_MAX_BANDS)
+	{
+		std::cerr << "An input recording holds at most " << INPUT_MAX_BANDS << " distance bands." << '\n';
+		return false;
+	}
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Unable to create input recording " << path << '\n';
+		return false;
+	}
+
+	InputFileHeader header = { INPUT_FILE_MAGIC, INPUT_FILE_VERSION, seed, tickRate, sizeof(InputEvent), modes,
+		static_cast<uint32_t>(bands.size()), {} };
+	std::copy(bands.begin(), bands.end(), header.bands);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.flush();
+	return true;
+}
+
+/**
+*   Records a key event.
+*
+*   @param tick   - Simulation tick that will see the event.
+*   @param key    - Key code.
+*   @param action - INPUT_PRESS, INPUT_RELEASE or INPUT_REPEAT.
+*/
+void InputRecorder::recordKey(uint32_t tick, int key, int action)
+{
+	InputEvent event = { tick, INPUT_EVENT_KEY, static_cast<uint8_t>(action), static_cast<int16_t>(key), 0.0, 0.0 };
+	pending.push_back(event);
+}
+
+/**
+*   Records the mouse moving.
+*
+*   @param tick - Simulation tick that will see the event.
+*   @param xPos - Cursor position in x direction.
+*   @param yPos - Cursor position in y direction.
+*/
+void InputRecorder::recordMouse(uint32_t tick, double xPos, double yPos)
+{
+	InputEvent event = { tick, INPUT_EVENT_MOUSE, 0, 0, xPos, yPos };
+	pending.push_back(event);
+}
+
+/**
+*   Appends the events recorded since the last flush to the file. Called once a frame so a crash
+*	loses at most one frame of input.
+*/
+void InputRecorder::flush()
+{
+	if (!file.is_open() || pending.empty())
+	{
+		return;
+	}
+
+	file.write(reinterpret_cast<const char*>(pending.data()), pending.size() * sizeof(InputEvent));
+	file.flush();
+	pending.clear();
+}
+
+/**
+*   Constructor for a replay, nothing is read until open() is called.
+*/
+InputReplay::InputReplay()
+	: data(nullptr), size(0), mapping(nullptr), header(), events(nullptr), eventCount(0), nextEvent(0)
+{
+
+}
+
+/**
+*   Unmaps the recording.
+*/
+InputReplay::~InputReplay()
+{
+	close();
+}
+
+/**
+*   Releases the mapped or loaded file.
+*/
+void InputReplay::close()
+{
+#if !defined(_WIN32)
+	if (mapping != nullptr)
+	{
+		munmap(mapping, size);
+	}
+#endif
+	mapping = nullptr;
+	buffer.clear();
+	data = nullptr;
+	size = 0;
+	events = nullptr;
+	eventCount = 0;
+	nextEvent = 0;
+}
+
+/**
+*   Maps a recording into memory (or reads it, where mapping isn't available) and checks the header.
+*	A partly written last event, e.g. from a crash, is ignored.
+*
+*   @param path - The recording to replay.
+*
+*   @return bool - false if the file could not be read or is not a recording.
+*/
+bool InputReplay::open(const std::string& path)
+{
+	close();
+
+#if defined(_WIN32)
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+	{
+		std::cerr << "Unable to open input recording " << path << '\n';
+		return false;
+	}
+	buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	data = buffer.data();
+	size = buffer.size();
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		std::cerr << "Unable to open input recording " << path << '\n';
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		size = static_cast<size_t>(info.st_size);
+		mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			mapping = nullptr;
+			size = 0;
+		}
+	}
+	::close(fd);
+	data = static_cast<const unsigned char*>(mapping);
+#endif
+
+	if (data == nullptr || size < sizeof(InputFileHeader))
+	{
+		std::cerr << "Input recording " << path << " is empty." << '\n';
+		close();
+		return false;
+	}
+
+	header = *reinterpret_cast<const InputFileHeader*>(data);
+	if (header.magic != INPUT_FILE_MAGIC || header.version != INPUT_FILE_VERSION || header.eventSize != sizeof(InputEvent)
+		|| header.bandCount > INPUT_MAX_BANDS)
+	{
+		std::cerr << path << " is not an input recording this build can read." << '\n';
+		close();
+		return false;
+	}
+
+	events = reinterpret_cast<const InputEvent*>(data + sizeof(InputFileHeader));
+	eventCount = (size - sizeof(InputFileHeader)) / sizeof(InputEvent);
+	nextEvent = 0;
+	return true;
+}
+
+/**
+*   Feeds every event recorded for this tick (or earlier) into the input state, through the same
+*	handlers GLWindow uses for live input.
+*
+*   @param tick  - Simulation tick that is about to run.
+*   @param input - The input state the tick reads.
+*/
+void InputReplay::applyTick(uint32_t tick, InputState& input)
+{
+	while (nextEvent < eventCount && events[nextEvent].tick <= tick)
+	{
+		const InputEvent& event = events[nextEvent];
+		if (event.type == INPUT_EVENT_KEY)
+		{
+			input.handleKey(event.key, event.action);
+		}
+		else if (event.type == INPUT_EVENT_MOUSE)
+		{
+			input.handleMouse(event.xPos, event.yPos);
+		}
+		nextEvent++;
+	}
+}
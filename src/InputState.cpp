@@ -0,0 +1,86 @@
+#include "InputState.h"
+
+/**
+*  InputState holds which keys are down and how far the mouse moved since it was last read.
+*  It used to live inside GLWindow, it is separate so recorded input can be replayed through
+*  exactly the same code, with or without a window.
+*
+*  @name InputState.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Constructor for the input state, no keys down and no mouse movement.
+*/
+InputState::InputState()
+	: changeX(0.0f), changeY(0.0f), lastPosX(0.0f), lastPosY(0.0f), initialPos(true)
+{
+	for (int i = 0; i < 1024; i++)
+	{
+		keys[i] = false;
+	}
+}
+
+/**
+*   Handles a key event.
+*
+*   @param     key    - What key is currently pressed.
+*   @param     action - released or pressed
+*/
+void InputState::handleKey(int key, int action)
+{
+	if (key > 0 && key < 1024) // extended ascii character size.
+	{
+		if (action == INPUT_PRESS) {
+			keys[key] = true;
+		} else if (action == INPUT_RELEASE) {
+			keys[key] = false;
+		}
+	}
+}
+
+/**
+*   Handles the mouse moving to a new position.
+*
+*   @param     xPos   - mouse position in x direction
+*   @param     yPos   - mouse position in y direction
+*/
+void InputState::handleMouse(double xPos, double yPos)
+{
+	if (initialPos)
+	{
+		lastPosX = xPos;
+		lastPosY = yPos;
+		initialPos = false;
+	}
+
+	changeX = xPos - lastPosX;
+	changeY = lastPosY - yPos; // duplicate line like above would mean that everything is inverted, avoiding this.
+
+	lastPosX = xPos;
+	lastPosY = yPos;
+}
+
+/**
+*   Retrieve change in X for mouse.
+*
+*   @return float - value of the change.
+*/
+float InputState::getChangeX()
+{
+	float theChange = changeX;
+	changeX = 0.0f;
+	return theChange;
+}
+
+/**
+*   Retrieve change in Y for mouse.
+*
+*   @return float - value of the change.
+*/
+float InputState::getChangeY()
+{
+	float theChange = changeY;
+	changeY = 0.0f;
+	return theChange;
+}
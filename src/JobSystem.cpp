@@ -0,0 +1,319 @@
+#include "JobSystem.h"
+
+#include <string>
+
+/**
+*  JobSystem runs jobs on a fixed set of worker threads. Each worker owns a queue and steals from
+*  the other queues when its own is empty, so uneven work still keeps every core busy.
+*
+*  @name JobSystem.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+static thread_local const JobSystem* currentSystem = nullptr;
+static thread_local int currentWorker = -1;
+
+/**
+*   Starts the worker threads.
+*
+*   @param numberOfThreads - Threads that run jobs, including a thread that waits for them. 0 uses every core.
+*/
+JobSystem::JobSystem(int numberOfThreads)
+	: queuedJobs(0), stopping(false)
+{
+	if (numberOfThreads <= 0)
+	{
+		numberOfThreads = static_cast<int>(std::thread::hardware_concurrency());
+		if (numberOfThreads <= 0)
+		{
+			numberOfThreads = 1;
+		}
+	}
+
+	for (int i = 0; i < numberOfThreads; i++)
+	{
+		queues.push_back(std::make_unique<WorkerQueue>());
+	}
+
+	for (int i = 0; i < numberOfThreads - 1; i++)
+	{
+		workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+}
+
+/**
+*   Finishes the queued jobs and joins the worker threads.
+*/
+JobSystem::~JobSystem()
+{
+	stopping.store(true);
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeUp.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+/**
+*   The queue the calling thread pushes new jobs to, its own for workers, the shared one for everyone else.
+*
+*   @return int - index in queues.
+*/
+int JobSystem::currentQueue() const
+{
+	if (currentSystem == this)
+	{
+		return currentWorker;
+	}
+	return static_cast<int>(queues.size()) - 1;
+}
+
+/**
+*   Runs jobs until the system is destroyed, sleeps while there is nothing to do.
+*
+*   @param workerIndex - The queue this worker owns.
+*/
+void JobSystem::workerLoop(int workerIndex)
+{
+	currentSystem = this;
+	currentWorker = workerIndex;
+	PROFILE_THREAD_NAME("job worker " + std::to_string(workerIndex + 1));
+
+	while (true)
+	{
+		JobHandle job = findJob(workerIndex);
+		if (job)
+		{
+			runJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wakeUp.wait(lock, [this] { return stopping.load() || queuedJobs.load() > 0; });
+		if (stopping.load() && queuedJobs.load() == 0)
+		{
+			return;
+		}
+	}
+}
+
+/**
+*   Puts a job whose dependencies are done in the queue of the calling thread and wakes a worker.
+*
+*   @param job - Job to queue.
+*/
+void JobSystem::enqueue(const JobHandle& job)
+{
+	WorkerQueue& queue = *queues[currentQueue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+	queuedJobs.fetch_add(1);
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex); // a worker can't be between checking and sleeping now.
+	}
+	wakeUp.notify_one();
+}
+
+/**
+*   Takes the newest job of the given queue, or steals the oldest job of another queue.
+*
+*   @param queueIndex - Queue of the calling thread.
+*
+*   @return JobHandle - a job to run, empty if every queue is empty.
+*/
+JobHandle JobSystem::findJob(int queueIndex)
+{
+	if (queuedJobs.load() == 0)
+	{
+		return nullptr;
+	}
+
+	{
+		WorkerQueue& own = *queues[queueIndex];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty())
+		{
+			JobHandle job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			queuedJobs.fetch_sub(1);
+			return job;
+		}
+	}
+
+	int count = static_cast<int>(queues.size());
+	for (int i = 1; i < count; i++)
+	{
+		WorkerQueue& victim = *queues[(queueIndex + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty())
+		{
+			JobHandle job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			queuedJobs.fetch_sub(1);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+/**
+*   Runs a job and queues the jobs that were only waiting for it.
+*
+*   @param job - Job to run.
+*/
+void JobSystem::runJob(const JobHandle& job)
+{
+	job->function();
+	job->function = nullptr; // release whatever the job captured.
+
+	std::vector<JobHandle> ready;
+	{
+		std::lock_guard<std::mutex> lock(job->continuationsMutex);
+		job->finished.store(true, std::memory_order_release);
+		ready.swap(job->continuations);
+	}
+
+	for (auto& continuation : ready)
+	{
+		if (continuation->unfinishedDependencies.fetch_sub(1) == 1)
+		{
+			enqueue(continuation);
+		}
+	}
+}
+
+/**
+*   Adds a job. It runs once all of its dependencies have finished.
+*
+*   @param function     - The work.
+*   @param dependencies - Jobs that have to finish first, empty handles are ignored.
+*
+*   @return JobHandle - handle to wait for or to depend on.
+*/
+JobHandle JobSystem::submit(std::function<void()> function, std::initializer_list<JobHandle> dependencies)
+{
+	return submit(std::move(function), std::vector<JobHandle>(dependencies));
+}
+
+/**
+*   Adds a job. It runs once all of its dependencies have finished.
+*
+*   @param function     - The work.
+*   @param dependencies - Jobs that have to finish first, empty handles are ignored.
+*
+*   @return JobHandle - handle to wait for or to depend on.
+*/
+JobHandle JobSystem::submit(std::function<void()> function, const std::vector<JobHandle>& dependencies)
+{
+	JobHandle job = std::make_shared<Job>(std::move(function)); // starts with one dependency, this function.
+
+	for (auto& dependency : dependencies)
+	{
+		if (!dependency)
+		{
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(dependency->continuationsMutex);
+		if (!dependency->finished.load(std::memory_order_acquire))
+		{
+			job->unfinishedDependencies.fetch_add(1);
+			dependency->continuations.push_back(job);
+		}
+	}
+
+	if (job->unfinishedDependencies.fetch_sub(1) == 1)
+	{
+		enqueue(job);
+	}
+	return job;
+}
+
+/**
+*   Waits for a job to finish, running other jobs meanwhile.
+*
+*   @param job - Job to wait for.
+*/
+void JobSystem::wait(const JobHandle& job)
+{
+	if (!job)
+	{
+		return;
+	}
+
+	while (!job->isFinished())
+	{
+		JobHandle other = findJob(currentQueue());
+		if (other)
+		{
+			runJob(other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/**
+*   Waits for all the jobs to finish.
+*
+*   @param jobs - Jobs to wait for.
+*/
+void JobSystem::wait(const std::vector<JobHandle>& jobs)
+{
+	for (auto& job : jobs)
+	{
+		wait(job);
+	}
+}
+
+/**
+*   Splits [0, count) into jobs and waits for all of them. More jobs than threads are made so
+*	threads that finish early can steal the rest.
+*
+*   @param count         - Size of the range.
+*   @param function      - Called with the begin and end (exclusive) of a slice.
+*   @param jobsPerThread - How many slices to make per thread.
+*/
+void JobSystem::parallelFor(int count, const std::function<void(int, int)>& function, int jobsPerThread)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	if (getNumberOfThreads() == 1)
+	{
+		function(0, count);
+		return;
+	}
+
+	int slices = getNumberOfThreads() * (jobsPerThread > 0 ? jobsPerThread : 1);
+	if (slices > count)
+	{
+		slices = count;
+	}
+	if (slices == 1)
+	{
+		function(0, count);
+		return;
+	}
+
+	std::vector<JobHandle> jobs;
+	jobs.reserve(slices);
+	for (int i = 0; i < slices; i++)
+	{
+		int begin = static_cast<int>(static_cast<long long>(count) * i / slices);
+		int end = static_cast<int>(static_cast<long long>(count) * (i + 1) / slices);
+		jobs.push_back(submit([&function, begin, end] { function(begin, end); }));
+	}
+	wait(jobs);
+}
@@ -0,0 +1,140 @@
+#include "JunctionGraph.h"
+
+/**
+*  JunctionGraph turns the tiles of a level into junctions, dead ends and the corridors between
+*  them. It is built once per level and only read after that, so it is shared by every ghost and
+*  every world playing on the level.
+*
+*  @name JunctionGraph.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Builds the cells, then walks every corridor out of every node once.
+*
+*   @param grid - Walls of the level, the open neighbours of a tile are its cell bits.
+*/
+JunctionGraph::JunctionGraph(const LevelGrid& grid)
+	: tilesX(grid.getTilesX()), tilesZ(grid.getTilesZ()), cells(static_cast<size_t>(tilesX) * tilesZ, 0)
+{
+	for (int tile = 0; tile < static_cast<int>(cells.size()); tile++)
+	{
+		int x = tile % tilesX;
+		int z = tile / tilesX;
+		if (grid.isWall(x, z))
+		{
+			continue;
+		}
+
+		uint8_t open = grid.openNeighbours(x, z); // same bits as openBit().
+		int exits = 0;
+		for (uint8_t bits = open; bits != 0; bits &= bits - 1)
+		{
+			exits++;
+		}
+
+		if (exits != 2) // junction or dead end, a corridor has exactly two ways.
+		{
+			open |= NODE;
+			nodes.push_back({ tile, { -1, -1, -1, -1 } });
+		}
+		cells[tile] = open;
+	}
+
+	for (int node = 0; node < static_cast<int>(nodes.size()); node++)
+	{
+		for (uint8_t direction = GHOST_UP; direction <= GHOST_RIGHT; direction++)
+		{
+			if ((cells[nodes[node].tile] & openBit(direction)) && nodes[node].edges[direction - 1] < 0)
+			{
+				walkCorridor(node, direction);
+			}
+		}
+	}
+}
+
+/**
+*   The tile next to another one, walking off the left or right edge wraps around like the
+*	tunnel, the same as FlowField.
+*
+*   @param tile      - Index of the tile.
+*   @param direction - A GhostDirection.
+*
+*	@return int - index of the neighbour, -1 above the first or below the last row.
+*/
+int JunctionGraph::neighbour(int tile, uint8_t direction) const
+{
+	int x = tile % tilesX;
+	int z = tile / tilesX;
+
+	switch (direction)
+	{
+	case GHOST_UP:		z--; break;
+	case GHOST_DOWN:	z++; break;
+	case GHOST_LEFT:	x = x == 0 ? tilesX - 1 : x - 1; break;
+	case GHOST_RIGHT:	x = x == tilesX - 1 ? 0 : x + 1; break;
+	default:			return -1;
+	}
+
+	if (z < 0 || z >= tilesZ)
+	{
+		return -1;
+	}
+	return z * tilesX + x;
+}
+
+/**
+*   Follows a corridor from a node until the next node and stores it as an edge of both.
+*
+*   @param node      - Index of the node to start at.
+*   @param direction - Way out of the node, must be open.
+*/
+void JunctionGraph::walkCorridor(int node, uint8_t direction)
+{
+	JunctionEdge edge;
+	edge.from = node;
+	edge.fromDirection = direction;
+	edge.runBegin = static_cast<int>(runs.size());
+
+	int tile = neighbour(nodes[node].tile, direction);
+	int length = 1;
+	while ((cells[tile] & NODE) == 0)
+	{
+		runs.push_back(tile);
+		direction = firstDirection(cells[tile] & ~openBit(reverse(direction))); // the one way that isn't back.
+		tile = neighbour(tile, direction);
+		length++;
+	}
+
+	edge.to = static_cast<int>(std::lower_bound(nodes.begin(), nodes.end(), tile,
+		[](const JunctionNode& other, int value) { return other.tile < value; }) - nodes.begin());
+	edge.toDirection = reverse(direction);
+	edge.length = length;
+	edge.runEnd = static_cast<int>(runs.size());
+
+	int index = static_cast<int>(edges.size());
+	edges.push_back(edge);
+	nodes[node].edges[edge.fromDirection - 1] = index;
+	nodes[edge.to].edges[edge.toDirection - 1] = index;
+}
+
+/**
+*   Finds the node on a tile.
+*
+*   @param tileX - Column.
+*   @param tileZ - Row.
+*
+*	@return int - index in getNodes(), -1 if the tile is not a node.
+*/
+int JunctionGraph::findNode(int tileX, int tileZ) const
+{
+	if ((cell(tileX, tileZ) & NODE) == 0)
+	{
+		return -1;
+	}
+
+	int tile = tileZ * tilesX + tileX;
+	auto found = std::lower_bound(nodes.begin(), nodes.end(), tile,
+		[](const JunctionNode& node, int value) { return node.tile < value; });
+	return static_cast<int>(found - nodes.begin());
+}
@@ -0,0 +1,81 @@
+#include "LevelGrid.h"
+
+/**
+*  LevelGrid holds the tiles of a level once for every system and game that plays on it, and packs
+*  the walls into bits for the movement and collision code, which only ever asks whether a tile
+*  or its neighbours are walls.
+*
+*  @name LevelGrid.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Copies the tiles of a level into one flat array and packs its walls. Every bit starts as a
+*	wall, so the padding rows and the bits after the end of a row are walls, then the open tiles
+*	and guards are cleared.
+*
+*   @param levelArray - Vector with 1's and 0's that make up the map, 1 is a wall, 2 the player start.
+*   @param layout     - ROWS or BLOCKS, see LevelGrid.h.
+*/
+LevelGrid::LevelGrid(const std::vector<std::vector<int>>& levelArray, Layout layout)
+	: tilesX(static_cast<int>(levelArray[0].size())), tilesZ(static_cast<int>(levelArray.size())), layout(layout), startTile(-1)
+{
+	tiles.reserve(static_cast<size_t>(tilesX) * tilesZ);
+	for (const std::vector<int>& row : levelArray)
+	{
+		for (int value : row)
+		{
+			if (value == START && startTile < 0)
+			{
+				startTile = static_cast<int>(tiles.size());
+			}
+			tiles.push_back(static_cast<uint8_t>(value));
+		}
+	}
+
+	// the guards make a row tilesX + 2 bits long. One more byte than that, so the byte after
+	// the one a tile is in can always be read.
+	size_t groups = static_cast<size_t>(tilesX >> 3) + 2;
+
+	if (layout == BLOCKS)
+	{
+		zShift = 3;
+		zMask = 7;
+		groupStride = 8;
+	}
+	else
+	{
+		zShift = 0;
+		zMask = 0;
+		groupStride = 1;
+	}
+	rowStride = groups * groupStride;
+
+	int rows = ((tilesZ + zMask) >> zShift) + 2;
+	bits.assign(static_cast<size_t>(rows) * rowStride, 0xff);
+
+	for (int z = 0; z < tilesZ; z++)
+	{
+		for (int bit = 0; bit < tilesX + 2; bit++)
+		{
+			int x = bit == 0 ? tilesX - 1 : bit == tilesX + 1 ? 0 : bit - 1; // the guards copy the other edge.
+			if (tile(x, z) != WALL)
+			{
+				bits[byteIndex(bit, z)] &= static_cast<uint8_t>(~(1u << (bit & 7)));
+			}
+		}
+	}
+}
+
+/**
+*   Byte a bit of a row is in.
+*
+*   @param bit   - Bit in the row, the column + 1.
+*   @param tileZ - Row, -1 to tilesZ.
+*
+*	@return size_t - index in bits.
+*/
+size_t LevelGrid::byteIndex(int bit, int tileZ) const
+{
+	return static_cast<size_t>((tileZ >> zShift) + 1) * rowStride + (tileZ & zMask) + (bit >> 3) * groupStride;
+}
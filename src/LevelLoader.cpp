@@ -53,16 +53,31 @@ void LevelLoader::loadLevel(std::string levelPath)
 		levelArray[y][x] = n;
 		x++;
 	}
+
+	grid = std::make_shared<const LevelGrid>(levelArray);
 }
 
 /**
 *   Getter for diverse use throughout the engine.
+*
+*   @return const std::vector<std::vector<int>>& - the level as it was read, not a copy.
 */
-std::vector<std::vector<int>> LevelLoader::getLevel()
+const std::vector<std::vector<int>>& LevelLoader::getLevel()
 {
 	return levelArray;
 }
 
+/**
+*   The level as a LevelGrid, built once by loadLevel(). Every game and the map share this grid
+*	instead of keeping copies of the level.
+*
+*   @return std::shared_ptr<const LevelGrid> - the grid, null before a level is loaded.
+*/
+std::shared_ptr<const LevelGrid> LevelLoader::getGrid()
+{
+	return grid;
+}
+
 /**
 *   Getter for value of tiles in X direction.
 *
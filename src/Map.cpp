@@ -16,30 +16,54 @@
 *	generates the texture objects for wall and floor.
 *
 *   @param mainWindow - Window to generate to.
+*   @param jobSystem  - Decodes the textures in parallel while the map is built, may be null.
 * 
-*	@see   generateMap(), generateFloor(), getTexture(), loadTextureA().
+*	@see   generateMap(), generateFloor(), getTexture(), decodeTexture(), uploadTextureA().
 */
-Map::Map(std::shared_ptr<GLWindow>& mainWindow)
+Map::Map(std::shared_ptr<GLWindow>& mainWindow, JobSystem* jobSystem)
 	: wallPos(0), floorPos(0)
 {
-	generateMap("assets/levels/level0", mainWindow);
-	generateFloor(tilesX*2, tilesZ*2);
+	PROFILE_SCOPE("Map::Map");
 
 	wallMat = std::make_unique<Material>();
 	wallMat->getTexture("assets/textures/wall_tex.png");
-	wallMat->loadTextureA();
 
 	floorMat = std::make_unique<Material>();
 	floorMat->getTexture("assets/textures/floor_tex.png");
-	floorMat->loadTextureA();
 
 	minimapFloorMat = std::make_unique<Material>();
 	minimapFloorMat->getTexture("assets/textures/plain_floor.png");
-	minimapFloorMat->loadTextureA();
 
 	minimapWallMat = std::make_unique<Material>();
 	minimapWallMat->getTexture("assets/textures/plain_walls.png");
-	minimapWallMat->loadTextureA();
+
+	Material* materials[] = { wallMat.get(), floorMat.get(), minimapFloorMat.get(), minimapWallMat.get() };
+	std::vector<JobHandle> decodeJobs;
+
+	for (Material* material : materials)
+	{
+		if (jobSystem != nullptr)
+		{
+			decodeJobs.push_back(jobSystem->submit([material] { material->decodeTexture(); }));
+		}
+		else
+		{
+			material->decodeTexture();
+		}
+	}
+
+	generateMap("assets/levels/level0", mainWindow);
+	generateFloor(tilesX*2, tilesZ*2);
+
+	if (jobSystem != nullptr)
+	{
+		jobSystem->wait(decodeJobs);
+	}
+
+	for (Material* material : materials) // OpenGL calls stay on this thread.
+	{
+		material->uploadTextureA();
+	}
 }
 
 /**
@@ -123,27 +147,26 @@ void Map::generateMap(std::string levelPath, std::shared_ptr<GLWindow>& mainWind
 	LevelLoader levelLoader;
 	levelLoader.loadLevel(levelPath);
 
-	levelArray = levelLoader.getLevel();
-	tilesX = levelLoader.getTilesX();
-	tilesZ = levelLoader.getTilesY();
+	grid = levelLoader.getGrid();
+	tilesX = grid->getTilesX();
+	tilesZ = grid->getTilesZ();
 
 	int numberOfWalls = 0;
 	
-	//To avoid that the calculation will overflow the original (smaller) type before conversion 
-	//to the result (larger) type we can either cast to double or use unsigned long int
-	for (unsigned long int z = 0; z < tilesZ; z++)
+	// rows -1 and tilesZ are walls in the grid, so the rows above and below can always be asked about.
+	for (int z = 0; z < tilesZ; z++)
 	{
-		for (unsigned long int x = 0; x < tilesX; x++)
+		for (int x = 0; x < tilesX; x++)
 		{
-			if (levelArray[z][x] == 0 || levelArray[z][x] == 2)
+			if (!grid->isWall(x, z))
 			{
-				if (levelArray[z - 1][x] == 1)
+				if (grid->isWall(x, z - 1))
 				{
 					generateWall(Wall::UP, x, z, numberOfWalls);
 					numberOfWalls++;
 				}
 			
-				if (levelArray[z + 1][x] == 1)
+				if (grid->isWall(x, z + 1))
 				{
 					generateWall(Wall::DOWN, x, z, numberOfWalls);
 					numberOfWalls++;
@@ -151,30 +174,30 @@ void Map::generateMap(std::string levelPath, std::shared_ptr<GLWindow>& mainWind
 
 				if (x > 0) 
 				{
-					if (levelArray[z][x - 1] == 1)
+					if (grid->isWall(x - 1, z))
 					{
 						generateWall(Wall::LEFT, x, z, numberOfWalls);
 						numberOfWalls++;
 					}
 				}
 				
-				if (x < 27) 
+				if (x < tilesX - 1) 
 				{
-					if (levelArray[z][x + 1] == 1)
+					if (grid->isWall(x + 1, z))
 					{
 						generateWall(Wall::RIGHT, x, z, numberOfWalls);
 						numberOfWalls++;
 					}
 				}
 			}
-
-			if (levelArray[z][x] == 2) // player starting position
-			{
-				startingPlayerPos = glm::vec3(x*2+1, 1.0f, z*2+1);
-			}
 		}
 	}
 
+	if (grid->getStartTile() >= 0) // player starting position
+	{
+		startingPlayerPos = glm::vec3(grid->getStartTile() % tilesX * 2 + 1, 1.0f, grid->getStartTile() / tilesX * 2 + 1);
+	}
+
 	shader->calculateAverageNormals(indices, indices.size(), vertices, vertices.size(), 8, 5);
 
 	mapVAO = std::make_shared<VertexArray>();
@@ -233,13 +256,13 @@ void Map::generateFloor(int x, int y)
 }
 
 /**
-*   Utility getter for the map data.
+*   Utility getter for the map data, the grid is shared, not copied.
 *
-*   @return vector - contains map tiles.
+*   @return std::shared_ptr<const LevelGrid> - the level the map was built from.
 */
-std::vector<std::vector<int>> Map::getLevelArray()
+std::shared_ptr<const LevelGrid> Map::getGrid() const
 {
-	return levelArray;
+	return grid;
 }
 
 /**
@@ -265,6 +288,7 @@ glm::vec3 Map::getStartingPosition()
 */
 void Map::draw(glm::mat4 model, glm::mat4 projection, std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& shader)
 {
+	PROFILE_SCOPE("Map::draw");
 	shader->useShader();
 
 	uniformModel = shader->getModelLocation();
@@ -275,10 +299,14 @@ void Map::draw(glm::mat4 model, glm::mat4 projection, std::shared_ptr<Camera>& c
 	glUniformMatrix4fv(uniformView, 1, GL_FALSE, glm::value_ptr(camera->calculateViewMatrix()));
 	glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(model));
 
-	model = glm::translate(model, glm::vec3(wallPos));
-	wallMat->useTexture();
-	mapRenderer->drawElements(mapVAO, mapIBO);
+	{
+		GPU_PROFILE_SCOPE("walls");
+		model = glm::translate(model, glm::vec3(wallPos));
+		wallMat->useTexture();
+		mapRenderer->drawElements(mapVAO, mapIBO);
+	}
 
+	GPU_PROFILE_SCOPE("floor");
 	model = glm::translate(model, glm::vec3(floorPos));
 	floorMat->useTexture();
 	mapRenderer->drawElements(floorVAO, floorIBO);
@@ -297,6 +325,7 @@ void Map::draw(glm::mat4 model, glm::mat4 projection, std::shared_ptr<Camera>& c
 */
 void Map::drawMinimap(glm::mat4 model, glm::mat4 projection, std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& shader)
 {
+	PROFILE_SCOPE("Map::drawMinimap");
 	shader->useShader();
 
 	uniformModel = shader->getModelLocation();
@@ -15,6 +15,7 @@ Material::Material()
 {
 	specularIntensity = 0.0f;
 	shininess = 0.0f;
+	texData = nullptr;
 }
 
 /**
@@ -42,6 +43,7 @@ void Material::getTexture(const char* fileLoc)
 
 bool Material::loadTexture()
 {
+	PROFILE_SCOPE("Material::loadTexture");
 	stbi_set_flip_vertically_on_load(1); // Comment this to not flip texture - will be beneficial most of the time
 	unsigned char* texData = stbi_load(fileLocation, &width, &height, &bitDepth, 0);
 	if (!texData)
@@ -70,13 +72,41 @@ bool Material::loadTexture()
 
 bool Material::loadTextureA()
 {
+	PROFILE_SCOPE("Material::loadTextureA");
+	return decodeTexture() && uploadTextureA();
+}
+
+/**
+*	Reads and decodes the texture file. Makes no OpenGL calls, so it can run on any thread,
+*	uploadTextureA() has to be called on the OpenGL thread afterwards.
+*
+*	@return bool - false if the file could not be read.
+*/
+bool Material::decodeTexture()
+{
+	PROFILE_SCOPE("Material::decodeTexture");
 	//stbi_set_flip_vertically_on_load(1); // Comment this to not flip texture - will be beneficial most of the time
-	unsigned char* texData = stbi_load(fileLocation, &width, &height, &bitDepth, 0);
+	texData = stbi_load(fileLocation, &width, &height, &bitDepth, 0);
 	if (!texData)
 	{
 		std::cout << "Failed to find texture at location: " << fileLocation << std::endl;
 		return false;
 	}
+	return true;
+}
+
+/**
+*	Uploads the pixels decoded by decodeTexture() as an RGBA texture.
+*
+*	@return bool - false if nothing was decoded.
+*/
+bool Material::uploadTextureA()
+{
+	PROFILE_SCOPE("Material::uploadTextureA");
+	if (!texData)
+	{
+		return false;
+	}
 
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_2D, textureID);
@@ -92,6 +122,7 @@ bool Material::loadTextureA()
 	glBindTexture(GL_TEXTURE_2D, 0);
 
 	stbi_image_free(texData);
+	texData = nullptr;
 
 	return true;
 }
@@ -104,6 +135,11 @@ void Material::useTexture()
 
 void Material::clearTexture()
 {
+	if (texData)
+	{
+		stbi_image_free(texData);
+		texData = nullptr;
+	}
 	glDeleteTextures(1, &textureID);
 	textureID = 0;
 	width = 0;
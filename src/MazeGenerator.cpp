@@ -0,0 +1,107 @@
+#include "MazeGenerator.h"
+
+/**
+*  MazeGenerator builds levels for scaling tests, from the size of level0 up to thousands of
+*  tiles on each side. Corridors are one tile wide with a wall tile between them, like level0,
+*  so the ghost AI and the wall collision work on them unchanged.
+*
+*  @name MazeGenerator.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Constructor for a maze generator.
+*
+*   @param seed - Seed every generated level is drawn from.
+*/
+MazeGenerator::MazeGenerator(uint64_t seed)
+	: tilesX(0), tilesY(0), seed(seed)
+{
+
+}
+
+/**
+*   Generates a new level. A maze is carved between the odd tiles with a depth first search,
+*	which gives one path between any two tiles, then walls between two corridors are knocked
+*	out with the given chance to make loops. The player starts in the middle.
+*
+*   @param sizeX      - Tiles in X, at least 5.
+*   @param sizeY      - Tiles in Y (Z in the world), at least 5.
+*   @param loopChance - Chance of removing a wall between two corridors, 0 gives a perfect maze.
+*/
+void MazeGenerator::generate(int sizeX, int sizeY, float loopChance)
+{
+	tilesX = sizeX < 5 ? 5 : sizeX;
+	tilesY = sizeY < 5 ? 5 : sizeY;
+	levelArray.assign(tilesY, std::vector<int>(tilesX, 1));
+
+	CounterRandom random(seed, (static_cast<uint64_t>(tilesX) << 32) | static_cast<uint64_t>(tilesY)); // every size has its own stream.
+
+	int cellsX = (tilesX - 1) / 2; // cell (cx, cy) is tile (2 * cx + 1, 2 * cy + 1).
+	int cellsY = (tilesY - 1) / 2;
+
+	std::vector<uint8_t> visited(static_cast<size_t>(cellsX) * cellsY, 0);
+	std::vector<int> stack;
+
+	const int stepX[4] = { 0, 0, -1, 1 };
+	const int stepY[4] = { -1, 1, 0, 0 };
+
+	visited[0] = 1;
+	levelArray[1][1] = 0;
+	stack.push_back(0);
+
+	while (!stack.empty())
+	{
+		int cell = stack.back();
+		int cx = cell % cellsX;
+		int cy = cell / cellsX;
+
+		int next[4];
+		int options = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			int nx = cx + stepX[i];
+			int ny = cy + stepY[i];
+			if (nx >= 0 && ny >= 0 && nx < cellsX && ny < cellsY && !visited[ny * cellsX + nx])
+			{
+				next[options++] = i;
+			}
+		}
+
+		if (options == 0)
+		{
+			stack.pop_back();
+			continue;
+		}
+
+		int step = next[random.nextInt(options - 1)];
+		int nx = cx + stepX[step];
+		int ny = cy + stepY[step];
+
+		levelArray[2 * cy + 1 + stepY[step]][2 * cx + 1 + stepX[step]] = 0; // the wall between the two cells.
+		levelArray[2 * ny + 1][2 * nx + 1] = 0;
+		visited[ny * cellsX + nx] = 1;
+		stack.push_back(ny * cellsX + nx);
+	}
+
+	int threshold = static_cast<int>(loopChance * 10000.0f);
+	for (int y = 1; y < tilesY - 1; y++)
+	{
+		for (int x = 1; x < tilesX - 1; x++)
+		{
+			if (levelArray[y][x] != 1)
+			{
+				continue;
+			}
+
+			bool betweenX = x % 2 == 0 && y % 2 == 1 && levelArray[y][x - 1] == 0 && levelArray[y][x + 1] == 0;
+			bool betweenY = x % 2 == 1 && y % 2 == 0 && levelArray[y - 1][x] == 0 && levelArray[y + 1][x] == 0;
+			if ((betweenX || betweenY) && random.nextInt(9999) < threshold)
+			{
+				levelArray[y][x] = 0;
+			}
+		}
+	}
+
+	levelArray[2 * (cellsY / 2) + 1][2 * (cellsX / 2) + 1] = 2;
+}
@@ -0,0 +1,87 @@
+#include "MinimapPacman.h"
+
+/**
+*  The Pacman marker drawn on the minimap. This used to live inside the Camera class, it is
+*  split out so the camera (the player) has no OpenGL state and can run without a window.
+*
+*  @name MinimapPacman.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Constructor for the minimap marker. Builds the quad and loads the Pacman texture.
+*
+*	@see addBuffer(), getTexture(), loadTextureA()
+*/
+MinimapPacman::MinimapPacman()
+	: uniformModel(0), uniformProjection(0)
+{
+	std::vector<GLuint> indices =
+	{
+		0, 1, 2,
+		1, 3, 2,
+	};
+
+	std::vector<GLfloat> vertices =
+	{
+		//x        y       z          u     v
+		0.0f,    0.0f,    2.0f,      0.0f,  0.0f,	  // 0
+		2.0f,    0.0f,    2.0f,      1.0f,  0.0f,	  // 1
+		0.0f,    0.0f,    0.0f,      0.0f,  1.0f,	  // 2
+		2.0f,    0.0f,    0.0f,      1.0f,  1.0f      // 3
+	};
+
+	miniMapPacmanVAO = std::make_shared<VertexArray>();
+	miniMapPacmanVAO->bind();
+
+	miniMapPacmanVBO = std::make_unique<VertexBuffer>(&vertices[0], vertices.size() * sizeof(GLfloat));
+	miniMapPacmanVBO->bind();
+
+	miniMapPacmanVBLayout = std::make_unique<VertexBufferLayout>();
+	miniMapPacmanVBLayout->Push<float>(3);
+	miniMapPacmanVBLayout->Push<float>(2);
+
+	miniMapPacmanVAO->addBuffer(*miniMapPacmanVBO, *miniMapPacmanVBLayout);
+	miniMapPacmanIBO = std::make_shared<IndexBuffer>(&indices[0], indices.size());
+
+	miniMapPacmanMat = std::make_shared<Material>();
+	miniMapPacmanMat->getTexture("assets/textures/pacman_minimap.png");
+	miniMapPacmanMat->loadTextureA();
+
+	miniMapPacmanRenderer = std::make_shared<Renderer>();
+}
+
+/**
+*   Destructor for the minimap marker, everything is initialized as smart pointers.
+*/
+MinimapPacman::~MinimapPacman()
+{
+
+}
+
+/**
+*   Draws the minimap Pacman where the camera is. Takes in the projection and shader from the Game class.
+*
+*	@param camera		-	The camera (player) to place the marker on.
+*	@param projection	-	The projection matrix from the Game class.
+*	@param shader		-	The shader object from the Game class.
+*
+*	@see useShader(), useTexture(), drawElements().
+*/
+void MinimapPacman::draw(std::shared_ptr<Camera>& camera, glm::mat4 projection, std::shared_ptr<Shader>& shader)
+{
+	shader->useShader();
+
+	uniformModel = shader->getModelLocation();
+	uniformProjection = shader->getProjectionLocation();
+
+	glm::mat4 model(1.0f);
+	glm::vec3 pacmanMiniMapPosition = camera->getRenderPosition() + glm::vec3(-1.0f, 2.0f, -1.0f);
+	model = glm::translate(model, glm::vec3(pacmanMiniMapPosition));
+
+	glUniformMatrix4fv(uniformProjection, 1, GL_FALSE, glm::value_ptr(projection));
+	glUniformMatrix4fv(uniformModel, 1, GL_FALSE, glm::value_ptr(model));
+
+	miniMapPacmanMat->useTexture();
+	miniMapPacmanRenderer->drawElements(miniMapPacmanVAO, miniMapPacmanIBO);
+}
@@ -27,6 +27,7 @@ Model::Model()
 */
 void Model::loadModel(const std::string& fileName)
 {
+	PROFILE_SCOPE("Model::loadModel");
 	Assimp::Importer importer;
 	const aiScene* scene = importer.ReadFile(fileName, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenSmoothNormals | aiProcess_JoinIdenticalVertices);
 
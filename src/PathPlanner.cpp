@@ -0,0 +1,317 @@
+#include "PathPlanner.h"
+
+#include "ClusterGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+/**
+*  PathPlanner searches the paths ghosts ask for with A* on worker threads and hands the
+*  results to the next tick, so searching a huge level never holds up the tick that asked.
+*
+*  @name PathPlanner.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+namespace
+{
+	/* Search state of one thread, sized for the biggest level it has searched. A tile belongs
+	   to the current search when its stamp is the search's generation, so nothing has to be
+	   cleared between searches. */
+	struct SearchScratch
+	{
+		std::vector<uint32_t> stamps;
+		std::vector<uint32_t> costs;		// steps from the start.
+		std::vector<uint8_t> firstSteps;	// GhostDirection of the first step on the way to the tile.
+		std::vector<uint64_t> open;			// f << 32 | tile, a min heap.
+		uint32_t generation = 0;
+	};
+
+	thread_local SearchScratch scratch;
+}
+
+/**
+*   Planner for a level. Big levels get their ClusterGraph built here, with the JobSystem if
+*	there is one.
+*
+*   @param levelGrid - The level, shared with the rest of the game.
+*   @param jobSystem - Searches the paths, null searches them in collect() instead.
+*/
+PathPlanner::PathPlanner(std::shared_ptr<const LevelGrid> levelGrid, JobSystem* jobSystem)
+	: grid(std::move(levelGrid)), jobSystem(jobSystem), solved(true), expandedTiles(0), solvedPaths(0)
+{
+	if (static_cast<long long>(grid->getTilesX()) * grid->getTilesZ() >= HIERARCHY_TILES)
+	{
+		clusters = std::make_unique<ClusterGraph>(*grid, jobSystem);
+	}
+}
+
+/**
+*   Waits for the searches that are still running, they use the planner.
+*/
+PathPlanner::~PathPlanner()
+{
+	cancel();
+}
+
+/**
+*   Asks for a path, it comes back from collect() after the next dispatch(). Can be called
+*	from several threads at once, e.g. by ghosts moving in parallel jobs.
+*
+*   @param pathRequest - Where from, where to and who asks.
+*/
+void PathPlanner::request(const PathRequest& pathRequest)
+{
+	std::lock_guard<std::mutex> lock(requestMutex);
+	requests.push_back(pathRequest);
+}
+
+/**
+*   Starts searching everything requested since the last dispatch(). The requests are sorted by
+*	ghost first, the order they came in depends on how the threads ran. Results that weren't
+*	collected yet are dropped.
+*
+*	@see collect()
+*/
+void PathPlanner::dispatch()
+{
+	PROFILE_SCOPE("PathPlanner::dispatch");
+	cancel();
+	{
+		std::lock_guard<std::mutex> lock(requestMutex);
+		batch.swap(requests);
+	}
+	std::sort(batch.begin(), batch.end(), [](const PathRequest& a, const PathRequest& b)
+	{
+		return a.ghost != b.ghost ? a.ghost < b.ghost : a.fromTile < b.fromTile;
+	});
+	results.resize(batch.size());
+	solved = batch.empty();
+
+	if (jobSystem == nullptr)
+	{
+		return; // searched by collect().
+	}
+	for (int begin = 0; begin < static_cast<int>(batch.size()); begin += REQUESTS_PER_JOB)
+	{
+		int end = std::min(begin + REQUESTS_PER_JOB, static_cast<int>(batch.size()));
+		jobs.push_back(jobSystem->submit([this, begin, end] { solveRange(begin, end); }));
+	}
+}
+
+/**
+*   Results of the last dispatch(), in the order of the sorted requests. Waits for searches
+*	that haven't finished, without a JobSystem they are searched now.
+*
+*	@return const std::vector<PathResult>& - one result per request, valid until the next dispatch().
+*/
+const std::vector<PathResult>& PathPlanner::collect()
+{
+	PROFILE_SCOPE("PathPlanner::collect");
+	if (!jobs.empty())
+	{
+		jobSystem->wait(jobs);
+		jobs.clear();
+	}
+	else if (!solved)
+	{
+		solveRange(0, static_cast<int>(batch.size()));
+	}
+	solved = true;
+
+	solvedPaths += batch.size();
+	batch.clear();
+	return results;
+}
+
+/**
+*   Drops the dispatched batch and its results, after waiting for the searches that run.
+*	Requests that weren't dispatched yet are kept.
+*/
+void PathPlanner::cancel()
+{
+	if (!jobs.empty())
+	{
+		jobSystem->wait(jobs);
+		jobs.clear();
+	}
+	batch.clear();
+	results.clear();
+	solved = true;
+}
+
+/**
+*   Changes where the searches run, after the ones that are running have finished.
+*
+*   @param jobs - The new JobSystem, null searches in collect().
+*/
+void PathPlanner::setJobSystem(JobSystem* jobs)
+{
+	if (!this->jobs.empty())
+	{
+		jobSystem->wait(this->jobs);
+		this->jobs.clear();
+		solved = true; // collect() must not search them again.
+	}
+	jobSystem = jobs;
+}
+
+/**
+*   Searches a range of the batch, each thread with its own scratch space.
+*
+*   @param begin - First request.
+*   @param end   - One past the last request.
+*/
+void PathPlanner::solveRange(int begin, int end)
+{
+	PROFILE_SCOPE("PathPlanner::solve");
+	unsigned long long expanded = 0;
+	for (int i = begin; i < end; i++)
+	{
+		results[i] = solve(batch[i], expanded);
+	}
+	expandedTiles.fetch_add(expanded, std::memory_order_relaxed);
+}
+
+/**
+*   Lower bound of the steps between two tiles: the distance in rows plus the distance in
+*	columns, the shorter way around through the tunnel if that is shorter. Never more than
+*	the real distance, and changes by at most 1 per step, so A* never has to open a tile twice.
+*
+*   @param fromTile - Row major index.
+*   @param toTile   - Row major index.
+*
+*	@return int - steps.
+*/
+int PathPlanner::heuristic(int fromTile, int toTile) const
+{
+	int tilesX = grid->getTilesX();
+	int dx = std::abs(fromTile % tilesX - toTile % tilesX);
+	int dz = std::abs(fromTile / tilesX - toTile / tilesX);
+	return std::min(dx, tilesX - dx) + dz;
+}
+
+/**
+*   Searches one path, on the ClusterGraph if the level has one, else tile by tile.
+*
+*   @param pathRequest - Where from and where to.
+*   @param expanded    - Gets the number of tiles and nodes the search expanded added.
+*
+*	@return PathResult - the first step and the length of the path.
+*
+*	@see searchTiles(), ClusterGraph::solve()
+*/
+PathResult PathPlanner::solve(const PathRequest& pathRequest, unsigned long long& expanded) const
+{
+	return clusters != nullptr ? clusters->solve(pathRequest, expanded) : searchTiles(pathRequest, expanded);
+}
+
+/**
+*   Searches one path with A* over the tiles. Ties are broken by the lower tile index, the
+*	result is the same on every thread.
+*
+*   @param pathRequest - Where from and where to.
+*   @param expanded    - Gets the number of tiles the search expanded added.
+*
+*	@return PathResult - the first step and the length of a shortest path.
+*/
+PathResult PathPlanner::searchTiles(const PathRequest& pathRequest, unsigned long long& expanded) const
+{
+	PathResult result = { pathRequest.ghost, pathRequest.fromTile, GHOST_NONE, -1 };
+	int tilesX = grid->getTilesX();
+	size_t tiles = static_cast<size_t>(tilesX) * grid->getTilesZ();
+	int start = pathRequest.fromTile;
+	int target = pathRequest.targetTile;
+	if (start < 0 || target < 0 || static_cast<size_t>(start) >= tiles || static_cast<size_t>(target) >= tiles)
+	{
+		return result;
+	}
+	if (start == target)
+	{
+		result.length = 0;
+		return result;
+	}
+
+	SearchScratch& search = scratch;
+	if (search.stamps.size() < tiles)
+	{
+		search.stamps.assign(tiles, 0);
+		search.costs.resize(tiles);
+		search.firstSteps.resize(tiles);
+		search.generation = 0;
+	}
+	if (++search.generation == 0) // wrapped, old stamps could match again.
+	{
+		std::fill(search.stamps.begin(), search.stamps.end(), 0);
+		search.generation = 1;
+	}
+	uint32_t generation = search.generation;
+	std::vector<uint64_t>& open = search.open;
+	open.clear();
+
+	uint8_t forbidden = JunctionGraph::openBit(JunctionGraph::reverse(pathRequest.heading));
+
+	search.stamps[start] = generation;
+	search.costs[start] = 0;
+	search.firstSteps[start] = GHOST_NONE;
+	open.push_back(static_cast<uint64_t>(heuristic(start, target)) << 32 | static_cast<uint32_t>(start));
+
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		uint64_t entry = open.back();
+		open.pop_back();
+
+		int tile = static_cast<int>(entry & 0xffffffffu);
+		uint32_t cost = search.costs[tile];
+		if ((entry >> 32) != cost + static_cast<uint32_t>(heuristic(tile, target)))
+		{
+			continue; // a shorter way to the tile was found after this entry was pushed.
+		}
+		if (tile == target)
+		{
+			result.direction = search.firstSteps[tile];
+			result.length = static_cast<int>(cost);
+			break;
+		}
+		expanded++;
+
+		int x = tile % tilesX;
+		int z = tile / tilesX;
+		uint8_t openBits = grid->openNeighbours(x, z);
+		if (tile == start)
+		{
+			openBits &= static_cast<uint8_t>(~forbidden);
+		}
+
+		for (uint8_t direction = GHOST_UP; direction <= GHOST_RIGHT; direction++)
+		{
+			if ((openBits & JunctionGraph::openBit(direction)) == 0)
+			{
+				continue;
+			}
+
+			int next;
+			switch (direction)
+			{
+			case GHOST_UP:		next = tile - tilesX; break;
+			case GHOST_DOWN:	next = tile + tilesX; break;
+			case GHOST_LEFT:	next = x == 0 ? tile + tilesX - 1 : tile - 1; break;
+			default:			next = x == tilesX - 1 ? tile - tilesX + 1 : tile + 1; break;
+			}
+
+			uint32_t nextCost = cost + 1;
+			if (search.stamps[next] == generation && search.costs[next] <= nextCost)
+			{
+				continue;
+			}
+			search.stamps[next] = generation;
+			search.costs[next] = nextCost;
+			search.firstSteps[next] = tile == start ? direction : search.firstSteps[tile];
+			open.push_back(static_cast<uint64_t>(nextCost + heuristic(next, target)) << 32 | static_cast<uint32_t>(next));
+			std::push_heap(open.begin(), open.end(), std::greater<uint64_t>());
+		}
+	}
+	return result;
+}
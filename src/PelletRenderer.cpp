@@ -0,0 +1,118 @@
+#include "PelletRenderer.h"
+
+/**
+*	The PelletRenderer draws the pellets with instancing. The model is loaded once, and the
+*	instance buffer is only re-uploaded when the Pellets object reports that pellets were eaten.
+*
+*  @name PelletRenderer.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Loads the pellet .obj and uploads one model matrix per pellet.
+*
+*   @param pellets - The pellets that should be drawn.
+*
+*	@see loadModel(), getVertexArray(), addBufferDivisor()
+*/
+PelletRenderer::PelletRenderer(const Pellets& pellets)
+	: numInstances(0), uploadedVersion(pellets.getVersion()),
+	uniformSpecularIntensity(0), uniformShininess(0), uView(0), uProj(0)
+{
+	pelletModel = std::make_unique<Model>();
+	pelletModel->loadModel("assets/models/pellet.obj");
+
+	buildMatrices(pellets);
+
+	instancedVAO = pelletModel->getVertexArray();
+	instancedVAO->bind();
+
+	instancedVBO = std::make_shared<VertexBuffer>(modelMatrices.data(), modelMatrices.size() * sizeof(glm::mat4));
+	instancedVBO->bind();
+
+	instancedVAO->addBufferDivisor();
+
+	instancedVAO->unbind();
+
+	pelletSpec = std::make_unique<Material>();
+	pelletSpec->getSpecular(2.0f, 128);
+}
+
+/**
+*   Rebuilds the model matrix for every pellet that is left.
+*
+*   @param pellets - The pellets that should be drawn.
+*/
+void PelletRenderer::buildMatrices(const Pellets& pellets)
+{
+	const std::vector<glm::vec3>& positions = pellets.getPelletPositions();
+
+	modelMatrices.resize(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		modelMatrices[i] = glm::translate(glm::mat4(1.0f), positions[i]);
+	}
+	numInstances = positions.size();
+}
+
+/**
+*   Re-uploads the instance buffer if pellets have been eaten since the last upload.
+*
+*   @param pellets - The pellets that should be drawn.
+*
+*	@see changeData()
+*/
+void PelletRenderer::update(const Pellets& pellets)
+{
+	PROFILE_SCOPE("PelletRenderer::update");
+	if (pellets.getVersion() == uploadedVersion)
+	{
+		return;
+	}
+
+	buildMatrices(pellets);
+	if (numInstances > 0)
+	{
+		instancedVAO->changeData(instancedVBO, modelMatrices.data(), modelMatrices.size() * sizeof(glm::mat4));
+		instancedVAO->unbind();
+	}
+	uploadedVersion = pellets.getVersion();
+}
+
+/**
+*   Draw all the models in positions all across the 0's of the map.
+*
+*   @param pelletShader - Sends in the pellet shader used in the Game class.
+*
+*	@see useMaterial(), renderInstanced()
+*/
+void PelletRenderer::draw(std::shared_ptr<Shader>& pelletShader)
+{
+	PROFILE_SCOPE("PelletRenderer::draw");
+	uniformSpecularIntensity = pelletShader->getSpecularIntensityLocation();
+	uniformShininess = pelletShader->getShininessLocation();
+
+	pelletSpec->useMaterial(uniformSpecularIntensity, uniformShininess);
+	pelletModel->renderInstanced(numInstances);
+}
+
+/**
+*   Draw all the models in positions all across the 0's of the map.
+*
+*   @param camera	    - Sends in the camera to calculate the view matrix for the minimap.
+*   @param pelletShader - Sends in the pellet shader used in the Game class.
+*   @param projection   - Sends in the projection generated in the Game class
+*
+*	@see calculateMinimapView(), renderInstanced()
+*/
+void PelletRenderer::drawMinimap(std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& pelletShader, glm::mat4 projection)
+{
+	PROFILE_SCOPE("PelletRenderer::drawMinimap");
+	uView = pelletShader->getViewLocation();
+	glUniformMatrix4fv(uView, 1, GL_FALSE, glm::value_ptr(camera->calculateMinimapView()));
+
+	uProj = pelletShader->getProjectionLocation();
+	glUniformMatrix4fv(uProj, 1, GL_FALSE, glm::value_ptr(projection));
+
+	pelletModel->renderInstanced(numInstances);
+}
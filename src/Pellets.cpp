@@ -1,177 +1,202 @@
 #include "Pellets.h"
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 /**
-*	The Pellets class generates, draws, and adds collision to the pellets in our application.
+*	The Pellets class places the pellets and handles the collision between them and the player.
+*	Drawing is done by PelletRenderer, this class has no OpenGL state.
 *
-*  @name PLACEHOLDER.cpp
-*  @author(s) Elvis Arifagic, J�rgen Eriksen, Salvador Bascunan.
+*  @name Pellets.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
 */
 
 
 /**
 *   Places the pellets around on the valid grid places.
 *
-*   @param levelArrayData - Legal tile data to place pellets on
-*   @param mainWindow     - Which window to place them on.
-* 
-*	@see generatePellets()
-* 
+*   @param grid - The level, a pellet is placed on every open tile.
 */
-Pellets::Pellets(std::vector<std::vector<int>> levelArrayData, std::shared_ptr<GLWindow>& mainWindow)
+Pellets::Pellets(const LevelGrid& grid)
 {
-	levelArray = levelArrayData;
-
-	x = 2.0f;
-	z = 17.0f;
+	tilesZ = grid.getTilesZ();
+	tilesX = grid.getTilesX();
 
-	int tilesZ = levelArray.size();
-	int tilesX = levelArray[0].size();
-
-	numPellets = 0; //Used for tracking
-	numPelletsEaten = 0; //Used for tracking
+	version = 0;
 
 	for (int z = 0; z < tilesZ; z++) 
 	{
 		for (int x = 0; x < tilesX; x++) 
 		{
-			if (levelArray[z][x] == 0)
+			if (grid.tile(x, z) == LevelGrid::OPEN)
 			{
 				glm::vec3 pos(x * 2 + 1, 0.5f, z * 2 + 1);
 				pelletsPositions.push_back(pos);
-
-				numPellets++;
 			}
 		}
 	}
-
-	generatePellets();
-
-	pelletSpec = std::make_unique<Material>();
-	pelletSpec->getSpecular(2.0f, 128);
+	totalPellets = static_cast<int>(pelletsPositions.size());
 }
 
 /**
-*   Generate the .obj for usage with pellets.
-* 
-*	@see loadModel(), getVertexArray()
-* 
+*   Check the collision between the camera and the pellets.
+*	If there is collision, remove the pellet so it is no longer drawn and queue a PelletEaten.
+*
+*   @param playerPosition - relevant camera position on map.
+*   @param events         - Bus of the tick the pellets are eaten in.
 */
-void Pellets::generatePellets()
+void Pellets::checkPelletsCollision(glm::vec3 playerPosition, EventBus& events)
 {
-	pelletModel = std::make_unique<Model>();
-	pelletModel->loadModel("assets/models/pellet.obj");
-
-	modelMatrices = new glm::mat4[numPellets];
-
-	for (unsigned int i = 0; i < numPellets; i++)
+	PROFILE_SCOPE("Pellets::checkPelletsCollision");
+	for (unsigned int i = 0; i < pelletsPositions.size(); i++)
 	{
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, pelletsPositions[i]);
-		modelMatrices[i] = model;
+		if (glm::distance(pelletsPositions[i], playerPosition) < 0.7f)
+		{
+			int tileX = static_cast<int>(pelletsPositions[i].x) / 2;
+			int tileZ = static_cast<int>(pelletsPositions[i].z) / 2;
+			pelletsPositions.erase(pelletsPositions.begin() + i);
+			version++;
+			events.emit(PelletEaten{ 0, tileX, tileZ, getNumPellets() });
+		}
 	}
-
-	instancedVAO = std::make_shared<VertexArray>();
-	instancedVAO = pelletModel->getVertexArray();
-	instancedVAO->bind();
-
-	instancedVBO = std::make_shared<VertexBuffer>(&modelMatrices[0], numPellets * sizeof(glm::mat4));
-	instancedVBO->bind();
-
-	instancedVAO->addBufferDivisor();
-
-	instancedVAO->unbind();
 }
 
 /**
-*   Check the collision between the camera and the camera.
-*	If there is collision, remove all the pellets, and the position,
-*	then re-generate all the pellets minus the removed position.
+*   checkPelletsCollision() for a player in 16.16 fixed point: the distance is compared squared
+*	in integers, so the same pellets are eaten on every machine.
 *
-*   @param playerPosition - relevant camera position on map.
-* 
-*	@see generatePellets()
-* 
+*   @param playerX - X of the player in 16.16.
+*   @param playerY - Y of the player in 16.16.
+*   @param playerZ - Z of the player in 16.16.
+*   @param events  - Bus of the tick the pellets are eaten in.
 */
-void Pellets::checkPelletsCollision(glm::vec3 playerPosition)
+void Pellets::checkPelletsCollisionFixed(int32_t playerX, int32_t playerY, int32_t playerZ, EventBus& events)
 {
+	PROFILE_SCOPE("Pellets::checkPelletsCollisionFixed");
+	const int64_t reach = FixedPoint::fromFloat(0.7f);
 	for (unsigned int i = 0; i < pelletsPositions.size(); i++)
 	{
-		if (distance(pelletsPositions[i], playerPosition) < 0.7f)
+		int64_t dx = static_cast<int64_t>(playerX) - FixedPoint::fromFloat(pelletsPositions[i].x);
+		if (dx <= -reach || dx >= reach) // most pellets are out in x already.
+		{
+			continue;
+		}
+		int64_t dz = static_cast<int64_t>(playerZ) - FixedPoint::fromFloat(pelletsPositions[i].z);
+		if (dz <= -reach || dz >= reach)
+		{
+			continue;
+		}
+		int64_t dy = static_cast<int64_t>(playerY) - FixedPoint::fromFloat(pelletsPositions[i].y);
+		if (dx * dx + dy * dy + dz * dz < reach * reach)
 		{
+			int tileX = static_cast<int>(pelletsPositions[i].x) / 2;
+			int tileZ = static_cast<int>(pelletsPositions[i].z) / 2;
 			pelletsPositions.erase(pelletsPositions.begin() + i);
-			numPellets--;
-			numPelletsEaten++;
-			generatePellets();
+			version++;
+			events.emit(PelletEaten{ 0, tileX, tileZ, getNumPellets() });
 		}
 	}
 }
 
 /**
-*   Utility function for checking whether all pellets are eaten by the player.
+*   Replaces the pellets that are left, e.g. with the pellets of a snapshot of another simulation.
 *
-*   @return bool - False if there is still pellets on the map.
+*   @param positions  - The pellets that are left.
+*   @param newVersion - Version of the pellets, see getVersion().
 */
-bool Pellets::allPelletsEaten() 
+void Pellets::setPositions(const std::vector<glm::vec3>& positions, unsigned int newVersion)
 {
-	if (numPellets == 0) 
-	{
-		return true;
-	}
-	return false;
+	pelletsPositions = positions;
+	version = newVersion;
 }
 
 /**
-*   A function that calculates the distance between two vectors.
+*   Index of the lowest set bit.
+*
+*   @param word - Not 0.
 *
-*   @param vec_1 -
-*   @param vec_2 -
+*	@return int - between 0 and 63.
 */
-float distance(glm::vec3 vec_1, glm::vec3 vec_2)
+static int countTrailingZeros(uint64_t word)
 {
-	return sqrt(pow(vec_1.x - vec_2.x, 2) + pow(vec_1.z - vec_2.z, 2));
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(word);
+#endif
 }
 
 /**
-*   Draw all the models in positions all across the 0's of the map.
+*   Writes which pellets are left as one bit per tile of the level, in the row order the
+*	pellets are stored in.
 *
-*   @param camera	    - Sends in the camera to calculate the view matrix.
-*   @param pelletShader - Sends in the pellet shader used in the Game class.
-*   @param projection   - Sends in the projection generated in the Game class
-* 
-*	@see calculateViewMatrix(), setMat4(), renderInstanced()
-* 
+*   @param writer - Buffer of the game state.
 */
-void Pellets::draw(std::shared_ptr<Shader>& pelletShader)
+void Pellets::saveState(StateWriter& writer) const
 {
-	uniformSpecularIntensity = pelletShader->getSpecularIntensityLocation();
-	uniformShininess = pelletShader->getShininessLocation();
-
-	pelletSpec->useMaterial(uniformSpecularIntensity, uniformShininess);
-	pelletModel->renderInstanced(numPellets);
+	uint64_t word = 0;
+	int wordStart = 0; // first tile of the current word.
+	for (const glm::vec3& pellet : pelletsPositions)
+	{
+		int tile = (static_cast<int>(pellet.z) / 2) * tilesX + static_cast<int>(pellet.x) / 2;
+		while (tile >= wordStart + 64)
+		{
+			writer.write(word);
+			word = 0;
+			wordStart += 64;
+		}
+		word |= 1ull << (tile - wordStart);
+	}
+	for (int tiles = tilesX * tilesZ; wordStart < tiles; wordStart += 64)
+	{
+		writer.write(word);
+		word = 0;
+	}
 }
 
 /**
-*   Draw all the models in positions all across the 0's of the map.
+*   Reads what saveState() wrote for the same level and puts the pellets back. The version is
+*	bumped instead of restored, so a renderer that has seen a later state uploads again.
 *
-*   @param camera	    - Sends in the camera to calculate the view matrix for the minimap.
-*   @param pelletShader - Sends in the pellet shader used in the Game class.
-*   @param projection   - Sends in the projection generated in the Game class
+*   @param reader - Buffer of the game state.
 *
-*	@see calculateMiniMap(), setMat4(), renderInstanced()
-* 
+*	@return bool - false if the buffer ended early.
 */
-
-void Pellets::drawMinimap(std::shared_ptr<Camera>& camera, std::shared_ptr<Shader>& pelletShader, glm::mat4 projection)
+bool Pellets::restoreState(StateReader& reader)
 {
-	model = glm::mat4(1.0f);
-
-	uView = pelletShader->getViewLocation();
-	glUniformMatrix4fv(uView, 1, GL_FALSE, glm::value_ptr(camera->calculateMinimapView()));
-
-	uProj = pelletShader->getProjectionLocation();
-	glUniformMatrix4fv(uProj, 1, GL_FALSE, glm::value_ptr(projection));
-
-	model = glm::scale(model, glm::vec3(2.0f, 2.0f, 2.0f));
+	pelletsPositions.clear(); // keeps the capacity, restoring doesn't allocate.
+	int tiles = tilesX * tilesZ;
+	for (int wordStart = 0; wordStart < tiles; wordStart += 64)
+	{
+		uint64_t word;
+		if (!reader.read(word))
+		{
+			return false;
+		}
+		while (word != 0)
+		{
+			int tile = wordStart + countTrailingZeros(word);
+			word &= word - 1;
+			pelletsPositions.push_back(glm::vec3((tile % tilesX) * 2 + 1, 0.5f, (tile / tilesX) * 2 + 1));
+		}
+	}
+	version++;
+	return true;
+}
 
-	pelletModel->renderInstanced(numPellets);
-}
\ No newline at end of file
+/**
+*   Utility function for checking whether all pellets are eaten by the player.
+*
+*   @return bool - False if there is still pellets on the map.
+*/
+bool Pellets::allPelletsEaten() 
+{
+	if (pelletsPositions.empty()) 
+	{
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,201 @@
+#include "Profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+/**
+*  Profiler collects the timings of PROFILE_SCOPE blocks. Each thread gets its own ring buffer the
+*  first time it records something, after that recording is a plain store and an atomic counter
+*  update, no locks. Exporting copies what is in the buffers and writes a Chrome trace.
+*
+*  @name Profiler.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+std::atomic<bool> Profiler::enabled(false);
+std::string Profiler::outputPath;
+std::mutex Profiler::buffersMutex;
+std::vector<std::unique_ptr<ProfileBuffer>> Profiler::buffers;
+
+static const std::chrono::steady_clock::time_point profilerEpoch = std::chrono::steady_clock::now();
+
+/**
+*   Starts recording scopes.
+*
+*   @param path - Where save() writes the trace.
+*/
+void Profiler::start(const std::string& path)
+{
+	outputPath = path;
+	enabled.store(true, std::memory_order_relaxed);
+}
+
+/**
+*   Stops recording, what was recorded so far is kept.
+*/
+void Profiler::stop()
+{
+	enabled.store(false, std::memory_order_relaxed);
+}
+
+/**
+*   Time on the profiler clock.
+*
+*   @return uint64_t - nanoseconds since the program started, never 0.
+*/
+uint64_t Profiler::now()
+{
+	auto elapsed = std::chrono::steady_clock::now() - profilerEpoch;
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) + 1;
+}
+
+/**
+*   The ring buffer of the calling thread, created the first time a thread asks for it.
+*	Buffers are owned by the profiler so they can still be exported after their thread exits.
+*
+*   @return ProfileBuffer& - buffer only this thread writes to.
+*/
+ProfileBuffer& Profiler::threadBuffer()
+{
+	static thread_local ProfileBuffer* buffer = nullptr;
+
+	if (buffer == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		buffers.push_back(std::make_unique<ProfileBuffer>(static_cast<int>(buffers.size()) + 1));
+		buffer = buffers.back().get();
+	}
+	return *buffer;
+}
+
+/**
+*   Records a finished scope on the calling thread. When the ring is full the oldest event is overwritten.
+*
+*   @param name  - Name of the scope.
+*   @param start - Profiler time the scope started.
+*   @param end   - Profiler time the scope ended.
+*/
+void Profiler::record(const char* name, uint64_t start, uint64_t end)
+{
+	record(threadBuffer(), name, start, end);
+}
+
+/**
+*   Records a finished scope in a given buffer, e.g. a lane made with createLane().
+*	Only one thread may write to a buffer.
+*
+*   @param buffer - Buffer to record in.
+*   @param name   - Name of the scope.
+*   @param start  - Profiler time the scope started.
+*   @param end    - Profiler time the scope ended.
+*/
+void Profiler::record(ProfileBuffer& buffer, const char* name, uint64_t start, uint64_t end)
+{
+	uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+	buffer.events[head & (ProfileBuffer::CAPACITY - 1)] = { name, start, end };
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+/**
+*   Names the calling thread in the trace.
+*
+*   @param name - e.g. "main" or "worker 2".
+*/
+void Profiler::setThreadName(const std::string& name)
+{
+	ProfileBuffer& buffer = threadBuffer();
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	buffer.threadName = name;
+}
+
+/**
+*   Makes a track in the trace that isn't a CPU thread, e.g. for timings read back from the GPU.
+*
+*   @param name - Name of the track.
+*
+*   @return ProfileBuffer* - buffer to record() into, owned by the profiler.
+*/
+ProfileBuffer* Profiler::createLane(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	buffers.push_back(std::make_unique<ProfileBuffer>(static_cast<int>(buffers.size()) + 1));
+	buffers.back()->threadName = name;
+	return buffers.back().get();
+}
+
+/**
+*   Writes the trace to the path given to start(). Does nothing if the profiler was never started.
+*
+*   @return bool - whether a trace was written.
+*/
+bool Profiler::save()
+{
+	if (outputPath.empty())
+	{
+		return false;
+	}
+	return writeChromeTrace(outputPath);
+}
+
+/**
+*   Writes everything still in the ring buffers as Chrome trace-event JSON. Other threads may keep
+*	recording meanwhile, events they overwrite during the copy are left out.
+*
+*   @param path - File to write.
+*
+*   @return bool - false if the file could not be written.
+*/
+bool Profiler::writeChromeTrace(const std::string& path)
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Unable to write profile " << path << '\n';
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	char line[512];
+
+	for (auto& buffer : buffers)
+	{
+		if (!buffer->threadName.empty())
+		{
+			std::snprintf(line, sizeof(line), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+				first ? "" : ",\n", buffer->threadId, buffer->threadName.c_str());
+			file << line;
+			first = false;
+		}
+
+		uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t begin = head > ProfileBuffer::CAPACITY ? head - ProfileBuffer::CAPACITY : 0;
+		std::vector<ProfileEvent> events;
+		events.reserve(static_cast<size_t>(head - begin));
+		for (uint64_t i = begin; i < head; i++)
+		{
+			events.push_back(buffer->events[i & (ProfileBuffer::CAPACITY - 1)]);
+		}
+
+		uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+		uint64_t firstValid = headAfter > ProfileBuffer::CAPACITY ? headAfter - ProfileBuffer::CAPACITY : 0;
+		size_t skip = firstValid > begin ? static_cast<size_t>(firstValid - begin) : 0;
+
+		for (size_t i = skip; i < events.size(); i++)
+		{
+			const ProfileEvent& event = events[i];
+			std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				first ? "" : ",\n", event.name, buffer->threadId, event.start / 1000.0, (event.end - event.start) / 1000.0);
+			file << line;
+			first = false;
+		}
+	}
+
+	file << "\n]}\n";
+	return static_cast<bool>(file);
+}
@@ -10,6 +10,8 @@
 *   @author(s) Elvis Arifagic, Jrgen Eriksen, Salvador Bascunan.
 */
 
+unsigned int Renderer::drawCalls = 0;
+
 /**
 *   Draw call render for simple objects that don't have indices.
 *
@@ -19,6 +21,7 @@ void Renderer::drawArrays(std::shared_ptr<VertexArray>& va)
 {
 	va->bind();
 	glDrawArrays(GL_TRIANGLES, 0, 6);
+	drawCalls++;
 }
 
 /**
@@ -32,6 +35,7 @@ void Renderer::drawElements(std::shared_ptr<VertexArray>& va, std::shared_ptr<In
 	va->bind();
 	ib->bind();
 	glDrawElements(GL_TRIANGLES, ib->getCount(), GL_UNSIGNED_INT, nullptr);
+	drawCalls++;
 }
 
 /**
@@ -45,6 +49,7 @@ void Renderer::drawInstanced(std::shared_ptr<VertexArray>& va, std::shared_ptr<I
 	va->bind();
 	ib->bind();
 	glDrawElementsInstanced(GL_TRIANGLES, ib->getCount(), GL_UNSIGNED_INT, nullptr, numInstanced);
+	drawCalls++;
 }
 
 /**
@@ -35,6 +35,7 @@ Shader::Shader()
 */
 void Shader::createShaderFromFile(const char* vertexLocation, const char* fragmentLocation) 
 {
+	PROFILE_SCOPE("Shader::createShaderFromFile");
 	std::string vertexString = readFile(vertexLocation);
 	std::string fragmentString = readFile(fragmentLocation);
 
@@ -215,6 +216,7 @@ void Shader::compileShader(const char* vertexCode, const char* fragmentCode)
 */
 void Shader::setDirectionalLight(std::shared_ptr<DirectionalLight>& dLight)
 {
+	PROFILE_SCOPE("Shader::setDirectionalLight");
 
 	dLight->useLight(uniformDirectionalLight.uniformAmbientIntensity, uniformDirectionalLight.uniformColour,
 		uniformDirectionalLight.uniformDiffuseIntensity, uniformDirectionalLight.uniformDirection);
@@ -232,6 +234,7 @@ void Shader::setDirectionalLight(std::shared_ptr<DirectionalLight>& dLight)
 */
 void Shader::setPointLights(PointLight* pLight, unsigned int lightCount)
 {
+	PROFILE_SCOPE("Shader::setPointLights");
 	if (lightCount > 15) lightCount = 15;
 
 	glUniform1i(uniformPointLightCount, lightCount);
@@ -256,6 +259,7 @@ void Shader::setPointLights(PointLight* pLight, unsigned int lightCount)
 */
 void Shader::setSpotLights(SpotLight* sLight, unsigned int lightCount)
 {
+	PROFILE_SCOPE("Shader::setSpotLights");
 	if (lightCount > 3) lightCount = 3;
 
 	glUniform1i(uniformSpotLightCount, lightCount);
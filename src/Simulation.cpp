@@ -0,0 +1,613 @@
+#include "Simulation.h"
+
+/**
+*  The Simulation class holds all the game logic of one game. It owns the camera (player), the ghosts
+*  and the pellets, and steps them one fixed tick at a time. It has no knowledge of windows or OpenGL,
+*  the Game class draws its state and pacman_headless runs it without any window at all.
+*
+*  @name Simulation.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Constructor for a simulation. Places the player on the starting tile and spawns the ghosts and pellets.
+*	The score is kept by a handler of the pellets eaten every tick.
+*
+*   @param levelGrid      - The level, every game on it can share the same grid.
+*   @param numberOfGhosts - How many ghosts are hunting the player.
+*   @param seed           - Seed for every random choice in the game, same seed and input gives the same game.
+*
+*	@see findStartingPosition()
+*/
+Simulation::Simulation(std::shared_ptr<const LevelGrid> levelGrid, int numberOfGhosts, uint64_t seed)
+	: numberOfGhosts(numberOfGhosts), tick(0), seed(seed), status(GameStatus::RUNNING), score(0), grid(std::move(levelGrid)),
+	jobSystem(nullptr), timings(nullptr), endless(false)
+{
+	ghosts = std::make_unique<GhostStore>(grid, numberOfGhosts, seed);
+
+	pellets = std::make_unique<Pellets>(*grid);
+
+	startingPos = findStartingPosition();
+
+	camera = std::make_shared<Camera>(grid, startingPos, glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f, 4.0f, 0.03f);
+
+	playerTileX = static_cast<int>(std::floor(startingPos.x / 2));
+	playerTileZ = static_cast<int>(std::floor(startingPos.z / 2));
+
+	events.subscribe<PelletEaten>([this](const std::vector<PelletEaten>& eaten)
+	{
+		score += PELLET_POINTS * static_cast<int>(eaten.size());
+	});
+}
+
+/**
+*   Destructor for simulation, everything is initialized as smart pointers.
+*/
+Simulation::~Simulation()
+{
+
+}
+
+/**
+*   Sets the JobSystem the ghosts are moved with, the planner searches its paths with it too.
+*
+*   @param jobs - Not owned, null runs everything on the calling thread.
+*/
+void Simulation::setJobSystem(JobSystem* jobs)
+{
+	jobSystem = jobs;
+	if (planner != nullptr)
+	{
+		planner->setJobSystem(jobs);
+	}
+}
+
+/**
+*   Lets the ghosts plan their chase with A* on the JobSystem instead of following the flow
+*	field, which searches the whole level every time the player enters a new tile. Planned
+*	paths are asked for in one tick and used from the next one on. Turning it on or off
+*	changes how the rest of the game plays out, it is part of the game like the seed.
+*
+*   @param enabled - true to plan, false to go back to the flow field.
+*
+*	@see PathPlanner, GhostStore::setPlanner()
+*/
+void Simulation::setPathPlanning(bool enabled)
+{
+	if (enabled == (planner != nullptr))
+	{
+		return;
+	}
+
+	if (enabled)
+	{
+		planner = std::make_unique<PathPlanner>(grid, jobSystem);
+		ghosts->setPlanner(planner.get());
+	}
+	else
+	{
+		ghosts->setPlanner(nullptr);
+		planner.reset();
+	}
+}
+
+/**
+*   Moves the ghosts by events instead of every ghost every tick: a tick only runs the ghosts
+*	that get to a tile where they may turn, and catching the player only looks at the ghosts
+*	near it. Like path planning it changes how the game plays out, it is part of the game.
+*	The ghosts are then moved on the calling thread, the JobSystem only checks the pellets.
+*	Events are worked out in float, scheduling turns fixed point off.
+*
+*   @param enabled - true to schedule the ghosts, false to move them all every tick.
+*
+*	@see GhostStore::setScheduled()
+*/
+void Simulation::setEventScheduling(bool enabled)
+{
+	if (enabled)
+	{
+		camera->setFixedPoint(false);
+	}
+	ghosts->setScheduled(enabled);
+}
+
+/**
+*   Moves the ghosts far from the player every few ticks instead of every tick, in bands by
+*	their distance to it. The ghosts near the player are still moved and checked every tick.
+*	It changes how the game plays out like event scheduling does, which is used instead when
+*	both are set. The ghosts are then moved on the calling thread. Bands turn fixed point off
+*	like event scheduling does.
+*
+*   @param bands - Tiles from the player and how many ticks apart a band moves, empty for none.
+*
+*	@see GhostStore::setDetailBands()
+*/
+void Simulation::setDetailBands(const std::vector<DetailBand>& bands)
+{
+	if (!bands.empty())
+	{
+		camera->setFixedPoint(false);
+	}
+	ghosts->setDetailBands(bands);
+}
+
+/**
+*   Moves the player and the ghosts on 16.16 fixed point positions and checks the catches and
+*	the pellets in integers, see FixedPoint.h, so the game plays out the same bits with every
+*	compiler and CPU and a recorded game replays exactly on any machine. It plays out
+*	differently from a game in float, it is part of the game like path planning. Event
+*	scheduling and bands only work in float, fixed point turns them off.
+*
+*   @param enabled - true for fixed point, false for float.
+*
+*	@see Camera::setFixedPoint(), GhostStore::setFixedPoint()
+*/
+void Simulation::setFixedPoint(bool enabled)
+{
+	camera->setFixedPoint(enabled);
+	ghosts->setFixedPoint(enabled);
+}
+
+/**
+*   Finds the tile marked with 2 in the level, that is where the player starts.
+*
+*   @return glm::vec3 - location in world space for camera.
+*/
+glm::vec3 Simulation::findStartingPosition()
+{
+	int start = grid->getStartTile();
+	if (start >= 0)
+	{
+		return glm::vec3(start % grid->getTilesX() * 2 + 1, 1.0f, start / grid->getTilesX() * 2 + 1);
+	}
+	return glm::vec3(1.0f, 1.0f, 1.0f);
+}
+
+/**
+*   Milliseconds since a point in time, the point is moved to now.
+*
+*   @param since - Start of the measured part.
+*
+*	@return double - milliseconds it took.
+*/
+static double lap(std::chrono::steady_clock::time_point& since)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double ms = std::chrono::duration<double, std::milli>(now - since).count();
+	since = now;
+	return ms;
+}
+
+/**
+*   Advances the game by one tick. Moves the player from the input, moves the ghosts and
+*	resolves collisions. Does nothing once the game is lost or won. With a JobSystem and enough
+*	ghosts, the ghosts are moved in parallel jobs while another job checks the pellets. Every
+*	ghost only reads the player and its own state, so the result is the same either way.
+*	An endless game keeps running when the player is caught or has eaten every pellet.
+*
+*	What happened is queued on the event bus and dispatched once at the end of the tick, the
+*	events stay readable through getEvents() until the next update().
+*
+*   @param keys    - Keys that are held down, indexed by key code.
+*   @param changeX - Mouse movement in X since the last tick.
+*   @param changeY - Mouse movement in Y since the last tick.
+*   @param dt      - Length of the tick in seconds.
+*
+*	@return GameStatus - whether the game is still running, lost or won.
+*	@see keyControls(), mouseControl(), move(), checkCameraCollision(), checkPelletsCollision(), EventBus::dispatch()
+*/
+GameStatus Simulation::update(bool* keys, float changeX, float changeY, float dt)
+{
+	PROFILE_SCOPE("Simulation::update");
+	events.clear();
+	if (status != GameStatus::RUNNING)
+	{
+		return status;
+	}
+
+	std::chrono::steady_clock::time_point phaseStart;
+	if (timings != nullptr)
+	{
+		phaseStart = std::chrono::steady_clock::now();
+	}
+
+	camera->keyControls(keys, dt);
+	camera->mouseControl(changeX, changeY);
+	emitTileEntered();
+
+	if (timings != nullptr)
+	{
+		timings->playerMs += lap(phaseStart);
+	}
+
+	int caughtBy = -1;
+	if (planner != nullptr)
+	{
+		ghosts->applyPlans(planner->collect()); // asked for last tick.
+	}
+	ghosts->track(camera->getCameraPosition()); // before any ghost moves, they all read the same field.
+
+	if (ghosts->isScheduled() || ghosts->hasDetailBands())
+	{
+		if (ghosts->isScheduled())
+		{
+			ghosts->advanceScheduled(dt);
+			caughtBy = ghosts->catchesNear(camera->getCameraPosition());
+		}
+		else
+		{
+			ghosts->moveDetailed(dt);
+			caughtBy = ghosts->catchesDetailed(camera->getCameraPosition());
+		}
+		if (timings != nullptr)
+		{
+			timings->ghostsMs += lap(phaseStart);
+		}
+
+		checkPellets(camera->getCameraPosition());
+		if (timings != nullptr)
+		{
+			timings->pelletsMs += lap(phaseStart);
+		}
+	}
+	else if (jobSystem != nullptr && numberOfGhosts >= PARALLEL_GHOSTS)
+	{
+		glm::vec3 playerPosition = camera->getCameraPosition();
+		JobHandle pelletJob = jobSystem->submit([this, playerPosition]
+		{
+			std::chrono::steady_clock::time_point pelletStart = std::chrono::steady_clock::now();
+			checkPellets(playerPosition); // the only job emitting events.
+			if (timings != nullptr)
+			{
+				timings->pelletsMs += lap(pelletStart);
+			}
+		});
+
+		std::atomic<int> firstCaught(numberOfGhosts);
+		jobSystem->parallelFor(numberOfGhosts, [this, dt, &firstCaught](int begin, int end)
+		{
+			int ghost = moveGhosts(begin, end, dt);
+			int current = firstCaught.load(std::memory_order_relaxed);
+			while (ghost >= 0 && ghost < current && !firstCaught.compare_exchange_weak(current, ghost, std::memory_order_relaxed))
+			{
+				// current is reloaded, the lowest index wins so the event is the same on any number of threads.
+			}
+		});
+		jobSystem->wait(pelletJob);
+		if (firstCaught.load() < numberOfGhosts)
+		{
+			caughtBy = firstCaught.load();
+		}
+
+		if (timings != nullptr)
+		{
+			timings->ghostsMs += lap(phaseStart);
+		}
+	}
+	else
+	{
+		caughtBy = moveGhosts(0, numberOfGhosts, dt);
+		if (timings != nullptr)
+		{
+			timings->ghostsMs += lap(phaseStart);
+		}
+
+		checkPellets(camera->getCameraPosition());
+		if (timings != nullptr)
+		{
+			timings->pelletsMs += lap(phaseStart);
+		}
+	}
+
+	if (planner != nullptr)
+	{
+		planner->dispatch(); // searched while the rest of the tick runs and until the next one.
+	}
+
+	if (caughtBy >= 0) // if collision with one of the ghosts
+	{
+		events.emit(GhostCollision{ 0, caughtBy, ghosts->getPosition(caughtBy) });
+		if (!endless)
+		{
+			status = GameStatus::LOST;
+		}
+	}
+
+	bool cleared = !events.get<PelletEaten>().empty() && pellets->allPelletsEaten(); // the last pellet was eaten this tick.
+	if (cleared)
+	{
+		events.emit(LevelCleared{ 0, tick });
+	}
+	if (status == GameStatus::RUNNING && !endless && pellets->allPelletsEaten()) // if all pellets are eaten
+	{
+		status = GameStatus::WON;
+	}
+
+	if (timings != nullptr)
+	{
+		timings->ticks++;
+	}
+	tick++;
+
+	events.dispatch();
+	return status;
+}
+
+/**
+*   Moves a range of ghosts and checks if any of them caught the player.
+*
+*   @param begin - First ghost to move.
+*   @param end   - One past the last ghost to move.
+*   @param dt    - Length of the tick in seconds.
+*
+*	@return int - the first ghost of the range that collided with the player, -1 if none did.
+*/
+int Simulation::moveGhosts(int begin, int end, float dt)
+{
+	glm::vec3 playerPosition = camera->getCameraPosition();
+	ghosts->move(begin, end, dt);
+	if (ghosts->isFixedPoint())
+	{
+		return ghosts->catchesFixed(begin, end, camera->getFixedX(), camera->getFixedZ());
+	}
+	return ghosts->catches(begin, end, playerPosition);
+}
+
+/**
+*   Eats the pellets the player touches, in fixed point when the game is.
+*
+*   @param playerPosition - Where the player is.
+*/
+void Simulation::checkPellets(glm::vec3 playerPosition)
+{
+	if (camera->isFixedPoint())
+	{
+		pellets->checkPelletsCollisionFixed(camera->getFixedX(), FixedPoint::fromFloat(playerPosition.y), camera->getFixedZ(), events);
+		return;
+	}
+	pellets->checkPelletsCollision(playerPosition, events);
+}
+
+/**
+*   Queues a TileEntered when the player has moved into another tile since the last tick.
+*/
+void Simulation::emitTileEntered()
+{
+	glm::vec3 position = camera->getCameraPosition();
+	int tileX = static_cast<int>(std::floor(position.x / 2));
+	int tileZ = static_cast<int>(std::floor(position.z / 2));
+	if (tileX != playerTileX || tileZ != playerTileZ)
+	{
+		playerTileX = tileX;
+		playerTileZ = tileZ;
+		events.emit(TileEntered{ 0, tileX, tileZ });
+	}
+}
+
+/**
+*   Writes the state the renderer needs into a snapshot. The snapshot may hold an older
+*	tick, everything in it is overwritten, the pellets only when they have changed.
+*
+*   @param snapshot - Snapshot to write to.
+*/
+void Simulation::writeSnapshot(SimulationSnapshot& snapshot) const
+{
+	PROFILE_SCOPE("Simulation::writeSnapshot");
+	snapshot.tick = tick;
+	snapshot.status = status;
+	snapshot.score = score;
+
+	snapshot.cameraPosition = camera->getCameraPosition();
+	snapshot.cameraPreviousPosition = camera->getPreviousPosition();
+	snapshot.cameraYaw = camera->getYaw();
+	snapshot.cameraPitch = camera->getPitch();
+
+	snapshot.ghosts.resize(ghosts->size());
+	for (int i = 0; i < ghosts->size(); i++)
+	{
+		snapshot.ghosts[i].position = ghosts->getPosition(i);
+		snapshot.ghosts[i].previousPosition = ghosts->getPreviousPosition(i);
+		snapshot.ghosts[i].direction = ghosts->getDirection(i);
+	}
+
+	if (snapshot.pelletVersion != pellets->getVersion())
+	{
+		snapshot.pellets = pellets->getPelletPositions();
+		snapshot.pelletVersion = pellets->getVersion();
+	}
+}
+
+/**
+*   Shows the state of a snapshot: the player, the ghosts and the pellets are placed
+*	as they were in the snapshot's tick. Only the rendered state is restored, this is
+*	not meant to continue the game from.
+*
+*   @param snapshot - Snapshot written by writeSnapshot() of a simulation of the same level.
+*/
+void Simulation::applySnapshot(const SimulationSnapshot& snapshot)
+{
+	PROFILE_SCOPE("Simulation::applySnapshot");
+	tick = snapshot.tick;
+	status = snapshot.status;
+	score = snapshot.score;
+
+	camera->setPose(snapshot.cameraPosition, snapshot.cameraPreviousPosition, snapshot.cameraYaw, snapshot.cameraPitch);
+
+	for (int i = 0; i < ghosts->size() && i < static_cast<int>(snapshot.ghosts.size()); i++)
+	{
+		const GhostSnapshot& ghost = snapshot.ghosts[i];
+		ghosts->setPose(i, ghost.position, ghost.previousPosition, ghost.direction);
+	}
+
+	if (pellets->getVersion() != snapshot.pelletVersion)
+	{
+		pellets->setPositions(snapshot.pellets, snapshot.pelletVersion);
+	}
+}
+
+/**
+*   Size of a buffer written by saveState() for this game, counted by writing the state
+*	without a buffer.
+*
+*	@return size_t - bytes.
+*/
+size_t Simulation::stateSize() const
+{
+	StateWriter counter;
+	writeState(counter);
+	return counter.size();
+}
+
+/**
+*   The modes that decide which parts of a saved state are used: the ghosts of a fixed point game
+*	are where their 16.16 positions are, those of a scheduled game where their events put them,
+*	and a game with bands moves its ghosts from the ticks they were last moved in.
+*
+*	@return uint32_t - STATE_FIXED, STATE_SCHEDULED and STATE_BANDS or'ed together.
+*/
+uint32_t Simulation::stateModes() const
+{
+	return (camera->isFixedPoint() ? STATE_FIXED : 0) | (ghosts->isScheduled() ? STATE_SCHEDULED : 0)
+		| (ghosts->hasDetailBands() ? STATE_BANDS : 0);
+}
+
+/**
+*   Writes the complete state of the game into a flat buffer: the tick, the player, every ghost
+*	with its AI state and random stream, and the pellets that are left. restoreState() puts the
+*	game back exactly, the ticks after it play out the same as they did after the save.
+*	Settings (job system, timings, endless) and subscribers are not part of the state.
+*
+*   @param buffer - Gets the state, its capacity is reused so saving again doesn't allocate.
+*
+*	@see restoreState()
+*/
+void Simulation::saveState(std::vector<uint8_t>& buffer) const
+{
+	PROFILE_SCOPE("Simulation::saveState");
+	StateWriter writer(buffer);
+	writeState(writer);
+}
+
+/**
+*   Writes the state for saveState(), or counts its bytes for stateSize().
+*
+*   @param writer - Gets the state.
+*/
+void Simulation::writeState(StateWriter& writer) const
+{
+	writer.write(STATE_MAGIC);
+	writer.write(numberOfGhosts);
+	writer.write(grid->getTilesX());
+	writer.write(grid->getTilesZ());
+	writer.write(seed);
+	writer.write(stateModes());
+
+	writer.write(tick);
+	writer.write(status);
+	writer.write(score);
+	writer.write(playerTileX);
+	writer.write(playerTileZ);
+
+	writer.write(camera->getCameraPosition());
+	writer.write(camera->getPreviousPosition());
+	writer.write(camera->getYaw());
+	writer.write(camera->getPitch());
+	writer.write(camera->getFixedX());
+	writer.write(camera->getFixedZ());
+	writer.write(camera->getFixedYaw());
+
+	ghosts->saveState(writer);
+	pellets->saveState(writer);
+}
+
+/**
+*   Puts the game back to the state in a buffer written by saveState() of a simulation with
+*	the same level, seed, number of ghosts and modes: fixed point, event scheduling and bands.
+*	Nothing is changed if the buffer doesn't fit.
+*	No OpenGL state is touched, a PelletRenderer sees the new pellet version and uploads
+*	the pellets on its next update. The events of the last tick are dropped.
+*
+*   @param buffer - The saved state.
+*
+*	@return bool - false if the buffer is from another game or has the wrong size.
+*/
+bool Simulation::restoreState(const std::vector<uint8_t>& buffer)
+{
+	PROFILE_SCOPE("Simulation::restoreState");
+	if (buffer.size() != stateSize())
+	{
+		return false;
+	}
+
+	StateReader reader(buffer);
+	uint32_t magic = 0;
+	int ghostCount = 0;
+	int tilesX = 0;
+	int tilesZ = 0;
+	uint64_t gameSeed = 0;
+	uint32_t modes = 0;
+	reader.read(magic);
+	reader.read(ghostCount);
+	reader.read(tilesX);
+	reader.read(tilesZ);
+	reader.read(gameSeed);
+	reader.read(modes);
+	if (magic != STATE_MAGIC || ghostCount != numberOfGhosts || gameSeed != seed
+		|| tilesX != grid->getTilesX() || tilesZ != grid->getTilesZ() || modes != stateModes())
+	{
+		return false;
+	}
+
+	// the size is checked, every read below succeeds.
+	reader.read(tick);
+	reader.read(status);
+	reader.read(score);
+	reader.read(playerTileX);
+	reader.read(playerTileZ);
+
+	glm::vec3 position;
+	glm::vec3 previousPosition;
+	float yaw;
+	float pitch;
+	reader.read(position);
+	reader.read(previousPosition);
+	reader.read(yaw);
+	reader.read(pitch);
+	camera->setPose(position, previousPosition, yaw, pitch);
+	int32_t fixedX = 0;
+	int32_t fixedZ = 0;
+	int32_t fixedYaw = 0;
+	reader.read(fixedX);
+	reader.read(fixedZ);
+	reader.read(fixedYaw);
+	if (camera->isFixedPoint())
+	{
+		camera->setFixedPose(fixedX, fixedZ, fixedYaw);
+	}
+	camera->interpolate(1.0f);
+
+	ghosts->restoreState(reader);
+	pellets->restoreState(reader);
+
+	if (planner != nullptr) // the paths asked for in the saved tick are asked for again.
+	{
+		planner->cancel();
+		ghosts->track(position);
+		ghosts->requestPendingPlans();
+		planner->dispatch();
+	}
+
+	events.clear();
+	return reader.finished();
+}
+
+/**
+*   Blends the positions of the last two ticks for rendering.
+*
+*   @param alpha - How far into the next tick the frame is, between 0 and 1.
+*/
+void Simulation::interpolate(float alpha)
+{
+	camera->interpolate(alpha);
+	ghosts->interpolate(alpha);
+}
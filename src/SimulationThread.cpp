@@ -0,0 +1,171 @@
+#include "SimulationThread.h"
+
+/**
+*  SimulationThread steps a Simulation on a thread of its own and publishes what the renderer
+*  needs after every tick. The render thread never waits for a tick and the simulation thread
+*  never waits for a frame.
+*
+*  @name SimulationThread.cpp
+*  @author(s) Elvis Arifagic, Jørgen Eriksen, Salvador Bascunan.
+*/
+
+/**
+*   Takes over a simulation, it is not stepped until start() is called.
+*
+*   @param simulation - The simulation to step, only this thread touches it from now on.
+*   @param tickLength - Seconds of game time per tick.
+*/
+SimulationThread::SimulationThread(std::unique_ptr<Simulation> simulation, float tickLength)
+	: simulation(std::move(simulation)), tickLength(tickLength), changeX(0.0f), changeY(0.0f), running(false)
+{
+	for (bool& key : keys)
+	{
+		key = false;
+	}
+}
+
+/**
+*   Stops the thread before the simulation is destroyed.
+*/
+SimulationThread::~SimulationThread()
+{
+	stop();
+}
+
+/**
+*   Publishes the starting state and starts ticking. The first tick is due one tick length from now.
+*/
+void SimulationThread::start()
+{
+	if (running.load())
+	{
+		return;
+	}
+
+	startTime = std::chrono::steady_clock::now();
+
+	SimulationSnapshot& snapshot = snapshots.writeBuffer();
+	simulation->writeSnapshot(snapshot);
+	snapshot.tickTime = 0.0;
+	snapshots.publish();
+
+	running.store(true);
+	thread = std::thread(&SimulationThread::run, this);
+}
+
+/**
+*   Stops ticking and waits for the thread to finish the tick it is in.
+*/
+void SimulationThread::stop()
+{
+	running.store(false);
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+}
+
+/**
+*   Hands the input of a frame to the simulation. Keys replace the previous ones, mouse movement
+*	is added up until a tick consumes it, so nothing is lost when frames are faster than ticks.
+*
+*   @param newKeys    - Keys that are held down, KEY_COUNT of them.
+*   @param newChangeX - Mouse movement in X since the last frame.
+*   @param newChangeY - Mouse movement in Y since the last frame.
+*/
+void SimulationThread::setInput(const bool* newKeys, float newChangeX, float newChangeY)
+{
+	std::lock_guard<std::mutex> lock(inputMutex);
+	for (int i = 0; i < KEY_COUNT; i++)
+	{
+		keys[i] = newKeys[i];
+	}
+	changeX += newChangeX;
+	changeY += newChangeY;
+}
+
+/**
+*   Moves the events of the ticks run since the last call to another bus, in tick order.
+*
+*   @param events - Bus on the calling thread, the events are added after the ones it has.
+*/
+void SimulationThread::takeEvents(EventBus& events)
+{
+	std::lock_guard<std::mutex> lock(eventMutex);
+	events.append(pendingEvents);
+	pendingEvents.clear();
+}
+
+/**
+*   Time on the clock the ticks are scheduled by, the render thread uses it to interpolate.
+*
+*   @return double - seconds since start().
+*/
+double SimulationThread::now() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+/**
+*   Runs a tick every time one is due and sleeps in between. When the thread falls more than
+*	a quarter of a second behind, the missed time is dropped, like the frame time cap of the
+*	single threaded loop. Stops by itself once the game is lost or won.
+*
+*	@see Simulation::update(), Simulation::writeSnapshot(), takeEvents()
+*/
+void SimulationThread::run()
+{
+	PROFILE_THREAD_NAME("simulation");
+
+	bool tickKeys[KEY_COUNT];
+	double nextTick = tickLength; // the time the state after the next tick belongs to.
+
+	while (running.load())
+	{
+		double time = now();
+		if (time < nextTick)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(nextTick - time));
+			continue;
+		}
+
+		if (time - nextTick > 0.25)
+		{
+			nextTick = time;
+		}
+
+		float tickChangeX;
+		float tickChangeY;
+		{
+			std::lock_guard<std::mutex> lock(inputMutex);
+			for (int i = 0; i < KEY_COUNT; i++)
+			{
+				tickKeys[i] = keys[i];
+			}
+			tickChangeX = changeX;
+			tickChangeY = changeY;
+			changeX = 0.0f;
+			changeY = 0.0f;
+		}
+
+		GameStatus status = simulation->update(tickKeys, tickChangeX, tickChangeY, tickLength);
+
+		if (!simulation->getEvents().empty())
+		{
+			std::lock_guard<std::mutex> lock(eventMutex);
+			pendingEvents.append(simulation->getEvents());
+		}
+
+		SimulationSnapshot& snapshot = snapshots.writeBuffer();
+		simulation->writeSnapshot(snapshot);
+		snapshot.tickTime = nextTick;
+		snapshots.publish();
+
+		nextTick += tickLength;
+
+		if (status != GameStatus::RUNNING)
+		{
+			return;
+		}
+	}
+}